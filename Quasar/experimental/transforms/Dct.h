@@ -19,15 +19,19 @@
 #define DCT_H
 
 #include "../global.h"
+#include "OouraDct.h"
 #include <cstddef>
 #include <map>
-#include <utility>
+#include <memory>
 #include <vector>
 
 namespace Quasar
 {
     /**
      * An implementation of the Discrete Cosine Transform.
+     *
+     * Keeps one OouraDct per input length, so inputs whose length is a
+     * power of 2 are transformed in O(N log N).
      */
     class AQUILA_EXPORT Dct
     {
@@ -36,39 +40,17 @@ namespace Quasar
          * Initializes the transform.
          */
         Dct():
-            cosineCache()
+            transforms()
         {
         }
 
-        /**
-         * Destroys the transform object.
-         */
-        ~Dct()
-        {
-            clearCosineCache();
-        }
-
         std::vector<double> dct(const std::vector<double>& data, std::size_t outputLength);
 
     private:
         /**
-         * Key type for the cache, using input and output length.
+         * Transforms, by input length.
          */
-        typedef std::pair<std::size_t, std::size_t> cosineCacheKeyType;
-
-        /**
-         * Cache type.
-         */
-        typedef std::map<cosineCacheKeyType, double**> cosineCacheType;
-
-        /**
-         * Cache object, implemented as a map.
-         */
-        cosineCacheType cosineCache;
-
-        double** getCachedCosines(std::size_t inputLength, std::size_t outputLength);
-
-        void clearCosineCache();
+        std::map<std::size_t, std::unique_ptr<OouraDct<double>>> transforms;
     };
 }
 
@@ -20,6 +20,7 @@
 
 #include "../global.h"
 #include "../source/SignalSource.h"
+#include "Dct.h"
 #include "FftFactory.h"
 #include <cstddef>
 #include <vector>
@@ -45,7 +46,7 @@ namespace Quasar
      *
      * FramesCollection frames(data, FRAME_SIZE);
      * Mfcc mfcc(FRAME_SIZE);
-     * for (Frame& frame : frames) {
+     * for (auto frame : frames) {
      *    auto mfccValues = mfcc.calculate(frame);
      *    // do something with the calculated values
      * }
@@ -60,7 +61,7 @@ namespace Quasar
          * @param inputSize input length (common to all inputs)
          */
         Mfcc(std::size_t inputSize):
-            m_inputSize(inputSize), m_fft(FftFactory::getFft(inputSize))
+            m_inputSize(inputSize), m_fft(FftFactory::getFft(inputSize)), m_dct()
         {
         }
 
@@ -77,6 +78,11 @@ namespace Quasar
          * FFT calculator.
          */
         std::shared_ptr<Fft> m_fft;
+
+        /**
+         * DCT calculator, reused between calculations.
+         */
+        Dct m_dct;
     };
 }
 
@@ -93,6 +93,15 @@ namespace Quasar
         return std::rand() / static_cast<double>(RAND_MAX);
     }
 
+    /**
+     * Returns a pseudorandom real number of a given type from 0 to 1.
+     */
+    template<typename Real>
+    inline Real randomReal()
+    {
+        return std::rand() / static_cast<Real>(RAND_MAX);
+    }
+
     /**
      * Checks if n is an exact power of 2.
      */
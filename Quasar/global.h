@@ -62,6 +62,62 @@ namespace Quasar
      * Our standard complex number type, using double precision.
      */
     typedef std::complex<double> ComplexType;
+
+    /**
+     * Single precision sample type, for signals that fit in 24 bits of
+     * mantissa (e.g. 16-bit PCM or IQ streams). Halves the memory traffic
+     * and doubles the SIMD width compared to SampleType.
+     */
+    typedef float SampleType32;
+
+    /**
+     * Single precision complex number type.
+     */
+    typedef std::complex<float> ComplexType32;
+
+    /**
+     * Type used to accumulate sums of samples of type T.
+     *
+     * Sums are accumulated in the sample type itself, unless
+     * QUASAR_DOUBLE_ACCUMULATION is defined, in which case single
+     * precision samples are summed in double precision. The sample
+     * loops stay in single precision either way.
+     */
+    template<typename T>
+    struct AccumulatorOf
+    {
+        typedef T type;
+    };
+
+#if defined(QUASAR_DOUBLE_ACCUMULATION)
+    template<>
+    struct AccumulatorOf<float>
+    {
+        typedef double type;
+    };
+
+    template<>
+    struct AccumulatorOf<std::complex<float>>
+    {
+        typedef std::complex<double> type;
+    };
+#endif
+
+    /**
+     * Real type underlying a sample type: T itself for real samples,
+     * the type of the parts for std::complex<T>.
+     */
+    template<typename T>
+    struct RealOf
+    {
+        typedef T type;
+    };
+
+    template<typename T>
+    struct RealOf<std::complex<T>>
+    {
+        typedef T type;
+    };
 }
 
 #endif // QUASAR_GLOBAL_H
@@ -0,0 +1,240 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file AlignedAllocator.h
+ *
+ * Cache line aligned allocator and the containers built on it.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_MEMORY_ALIGNEDALLOCATOR_H
+#define QUASAR_MEMORY_ALIGNEDALLOCATOR_H
+
+#include "AllocationCounter.h"
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+	#include <malloc.h>
+#elif defined(__linux__) && !defined(QUASAR_DISABLE_HUGE_PAGES)
+	#include <sys/mman.h>
+	#if defined(MADV_HUGEPAGE)
+		#define QUASAR_HUGE_PAGES
+	#endif
+#endif
+
+namespace Quasar
+{
+	/**
+	 * Size of a transparent huge page on x86-64 and AArch64 Linux.
+	 *
+	 * Allocations at least this large are aligned to it and marked as
+	 * huge page candidates, which cuts TLB misses on long signals and
+	 * big FFT tables. Define QUASAR_DISABLE_HUGE_PAGES to turn it off.
+	 */
+	const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	/**
+	 * Allocates memory aligned to a given boundary.
+	 *
+	 * With QUASAR_COUNT_ALLOCATIONS defined (before including any Quasar
+	 * header), each call is counted in allocationCounter(), as the
+	 * aligned allocation functions are not replaceable like operator new.
+	 * Other builds do not touch the counter.
+	 *
+	 * @param bytes size of the block
+	 * @param alignment power of two, at least sizeof(void*)
+	 * @return pointer to the block, null on failure
+	 */
+	inline void* alignedAlloc(std::size_t bytes, std::size_t alignment)
+	{
+#if defined(QUASAR_COUNT_ALLOCATIONS)
+		allocationCounter().fetch_add(1, std::memory_order_relaxed);
+#endif
+#if defined(QUASAR_HUGE_PAGES)
+		if (bytes >= HUGE_PAGE_SIZE)
+		{
+			alignment = HUGE_PAGE_SIZE;
+		}
+#endif
+#if defined(_WIN32)
+		void* memory = _aligned_malloc(bytes, alignment);
+#else
+		void* memory = nullptr;
+		if (posix_memalign(&memory, alignment, bytes) != 0)
+		{
+			memory = nullptr;
+		}
+#endif
+#if defined(QUASAR_HUGE_PAGES)
+		if (memory && bytes >= HUGE_PAGE_SIZE)
+		{
+			// only a hint, failure leaves the block with regular pages
+			madvise(memory, bytes, MADV_HUGEPAGE);
+		}
+#endif
+		return memory;
+	}
+
+	/**
+	 * Frees memory obtained from alignedAlloc().
+	 *
+	 * @param memory pointer to the block
+	 */
+	inline void alignedFree(void* memory)
+	{
+#if defined(_WIN32)
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+
+	/**
+	 * A standard library allocator returning aligned memory.
+	 *
+	 * The default 64 byte alignment places the first sample at the start
+	 * of a cache line, so SIMD loads never straddle two lines and AVX-512
+	 * vectors are naturally aligned.
+	 *
+	 * Use it through AlignedVector, or through VectorStorage with any
+	 * other allocator, as the Container_t of a signal source:
+	 *
+	 * @verbatim
+	 * Quasar::SignalSource<double, Quasar::AlignedVector> signal(samples);
+	 * Quasar::SignalSource<double, Quasar::VectorStorage<PoolAllocator>::type> pooled; @endverbatim
+	 */
+	template<typename T, std::size_t Alignment = 64>
+	class AlignedAllocator
+	{
+		static_assert((Alignment & (Alignment - 1)) == 0 && Alignment >= sizeof(void*),
+				"alignment must be a power of two, at least the size of a pointer");
+
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind
+		{
+			typedef AlignedAllocator<U, Alignment> other;
+		};
+
+		AlignedAllocator()
+		{
+		}
+
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+		{
+		}
+
+		/**
+		 * Allocates aligned storage for n objects.
+		 *
+		 * @param n number of objects
+		 * @return pointer to the storage
+		 */
+		T* allocate(std::size_t n)
+		{
+			if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			void* memory = alignedAlloc(n * sizeof(T), Alignment);
+			if (!memory)
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(memory);
+		}
+
+		/**
+		 * Releases storage obtained from allocate().
+		 *
+		 * @param p pointer to the storage
+		 */
+		void deallocate(T* p, std::size_t)
+		{
+			alignedFree(p);
+		}
+
+		std::size_t max_size() const
+		{
+			return std::numeric_limits<std::size_t>::max() / sizeof(T);
+		}
+
+		template<typename U, typename... Args>
+		void construct(U* p, Args&&... args)
+		{
+			::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+		}
+
+		template<typename U>
+		void destroy(U* p)
+		{
+			p->~U();
+		}
+	};
+
+	template<typename T, typename U, std::size_t Alignment>
+	bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+	{
+		return true;
+	}
+
+	template<typename T, typename U, std::size_t Alignment>
+	bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+	{
+		return false;
+	}
+
+	/**
+	 * A vector with cache line aligned storage.
+	 */
+	template<typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+	/**
+	 * Turns an allocator template into a storage policy for signal sources.
+	 *
+	 * VectorStorage<Allocator>::type is a std::vector using Allocator and
+	 * can be passed wherever a Container_t is expected.
+	 */
+	template<template<typename> class Allocator>
+	struct VectorStorage
+	{
+		template<typename T>
+		using type = std::vector<T, Allocator<T>>;
+	};
+}
+
+#endif // QUASAR_MEMORY_ALIGNEDALLOCATOR_H
@@ -0,0 +1,272 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file AllocationCounter.h
+ *
+ * Debugging aid counting heap allocations.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_MEMORY_ALLOCATIONCOUNTER_H
+#define QUASAR_MEMORY_ALLOCATIONCOUNTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Quasar
+{
+	/**
+	 * Returns the process wide counter of tracked heap allocations.
+	 *
+	 * The counter is incremented by CountingAllocator, by every
+	 * operator new when installed with QUASAR_COUNT_GLOBAL_ALLOCATIONS
+	 * and, when QUASAR_COUNT_ALLOCATIONS is defined before including any
+	 * Quasar header, by alignedAlloc(), so by every AlignedVector (the
+	 * storage of windows and FFT buffers). Release builds leave
+	 * QUASAR_COUNT_ALLOCATIONS undefined and pay nothing for it.
+	 *
+	 * @return reference to the counter
+	 */
+	inline std::atomic<std::size_t>& allocationCounter()
+	{
+		static std::atomic<std::size_t> counter(0);
+		return counter;
+	}
+
+	/**
+	 * Returns the number of tracked allocations so far.
+	 *
+	 * @return allocations count
+	 */
+	inline std::size_t allocationCount()
+	{
+		return allocationCounter().load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Counts tracked allocations made during its lifetime.
+	 *
+	 * Typical use is asserting that the steady state of a block processing
+	 * loop does not touch the heap:
+	 *
+	 * @verbatim
+	 * process(block);                      // warm up, buffers grow here
+	 * Quasar::AllocationScope scope;
+	 * process(block);
+	 * assert(scope.allocations() == 0);    @endverbatim
+	 */
+	class AllocationScope
+	{
+	public:
+		AllocationScope():
+			m_start(allocationCount())
+		{
+		}
+
+		/**
+		 * Returns the number of allocations since the scope was created.
+		 *
+		 * @return allocations count
+		 */
+		std::size_t allocations() const
+		{
+			return allocationCount() - m_start;
+		}
+
+	private:
+		/**
+		 * Counter value when the scope was created.
+		 */
+		std::size_t m_start;
+	};
+
+	/**
+	 * An allocator counting its allocations, forwarding to another one.
+	 *
+	 * Use CountingVector as the Container_t of a source to track only the
+	 * sample storage, or QUASAR_COUNT_GLOBAL_ALLOCATIONS to track the
+	 * whole program. Using both, or a CountingAllocator over an
+	 * AlignedAllocator with QUASAR_COUNT_ALLOCATIONS defined, counts each
+	 * allocation twice.
+	 */
+	template<typename T, typename Base = std::allocator<T>>
+	class CountingAllocator : public Base
+	{
+	public:
+		typedef T value_type;
+
+		template<typename U>
+		struct rebind
+		{
+			typedef CountingAllocator<U,
+					typename std::allocator_traits<Base>::template rebind_alloc<U>> other;
+		};
+
+		CountingAllocator()
+		{
+		}
+
+		template<typename U, typename OtherBase>
+		CountingAllocator(const CountingAllocator<U, OtherBase>& other):
+			Base(other)
+		{
+		}
+
+		T* allocate(std::size_t n)
+		{
+			allocationCounter().fetch_add(1, std::memory_order_relaxed);
+			return std::allocator_traits<Base>::allocate(*this, n);
+		}
+
+		void deallocate(T* p, std::size_t n)
+		{
+			std::allocator_traits<Base>::deallocate(*this, p, n);
+		}
+	};
+
+	template<typename T, typename U, typename BaseT, typename BaseU>
+	bool operator==(const CountingAllocator<T, BaseT>& lhs, const CountingAllocator<U, BaseU>& rhs)
+	{
+		return static_cast<const BaseT&>(lhs) == static_cast<const BaseU&>(rhs);
+	}
+
+	template<typename T, typename U, typename BaseT, typename BaseU>
+	bool operator!=(const CountingAllocator<T, BaseT>& lhs, const CountingAllocator<U, BaseU>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	/**
+	 * A vector counting the allocations of its storage.
+	 */
+	template<typename T>
+	using CountingVector = std::vector<T, CountingAllocator<T>>;
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+	// the replacements pair malloc with free, which GCC can not see
+	#define QUASAR_ALLOCATION_HOOKS_BEGIN \
+		_Pragma("GCC diagnostic push") \
+		_Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+	#define QUASAR_ALLOCATION_HOOKS_END _Pragma("GCC diagnostic pop")
+#else
+	#define QUASAR_ALLOCATION_HOOKS_BEGIN
+	#define QUASAR_ALLOCATION_HOOKS_END
+#endif
+
+#if defined(QUASAR_COUNT_ALLOCATIONS)
+	// alignedAlloc() counts the allocation itself
+	#define QUASAR_COUNT_ALIGNED_NEW
+#else
+	#define QUASAR_COUNT_ALIGNED_NEW \
+		Quasar::allocationCounter().fetch_add(1, std::memory_order_relaxed);
+#endif
+
+#if defined(__cpp_aligned_new)
+	// over-aligned types go through alignedAlloc(), counted once
+	#define QUASAR_ALIGNED_ALLOCATION_HOOKS \
+		void* operator new(std::size_t size, std::align_val_t alignment) \
+		{ \
+			QUASAR_COUNT_ALIGNED_NEW \
+			const std::size_t boundary = std::max(static_cast<std::size_t>(alignment), sizeof(void*)); \
+			if (void* memory = Quasar::alignedAlloc(size ? size : 1, boundary)) \
+			{ \
+				return memory; \
+			} \
+			throw std::bad_alloc(); \
+		} \
+		void* operator new[](std::size_t size, std::align_val_t alignment) \
+		{ \
+			return ::operator new(size, alignment); \
+		} \
+		void operator delete(void* memory, std::align_val_t) noexcept \
+		{ \
+			Quasar::alignedFree(memory); \
+		} \
+		void operator delete[](void* memory, std::align_val_t) noexcept \
+		{ \
+			Quasar::alignedFree(memory); \
+		} \
+		void operator delete(void* memory, std::size_t, std::align_val_t) noexcept \
+		{ \
+			Quasar::alignedFree(memory); \
+		} \
+		void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept \
+		{ \
+			Quasar::alignedFree(memory); \
+		}
+#else
+	#define QUASAR_ALIGNED_ALLOCATION_HOOKS
+#endif
+
+/**
+ * Replaces the global operator new and delete with versions counting
+ * every heap allocation in allocationCounter(), including the aligned
+ * ones of C++17. Memory from alignedAlloc() is counted only when
+ * QUASAR_COUNT_ALLOCATIONS is defined.
+ *
+ * Expand it once, at namespace scope, in a single translation unit of a
+ * test or benchmark program.
+ */
+#define QUASAR_COUNT_GLOBAL_ALLOCATIONS \
+	QUASAR_ALLOCATION_HOOKS_BEGIN \
+	void* operator new(std::size_t size) \
+	{ \
+		Quasar::allocationCounter().fetch_add(1, std::memory_order_relaxed); \
+		if (void* memory = std::malloc(size ? size : 1)) \
+		{ \
+			return memory; \
+		} \
+		throw std::bad_alloc(); \
+	} \
+	void* operator new[](std::size_t size) \
+	{ \
+		return ::operator new(size); \
+	} \
+	void operator delete(void* memory) noexcept \
+	{ \
+		std::free(memory); \
+	} \
+	void operator delete[](void* memory) noexcept \
+	{ \
+		std::free(memory); \
+	} \
+	void operator delete(void* memory, std::size_t) noexcept \
+	{ \
+		std::free(memory); \
+	} \
+	void operator delete[](void* memory, std::size_t) noexcept \
+	{ \
+		std::free(memory); \
+	} \
+	QUASAR_ALIGNED_ALLOCATION_HOOKS \
+	QUASAR_ALLOCATION_HOOKS_END
+
+// alignedAlloc() reports to the counter above, and the hooks use it
+#include "AlignedAllocator.h"
+
+#endif // QUASAR_MEMORY_ALLOCATIONCOUNTER_H
@@ -0,0 +1,327 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file CowVector.h
+ *
+ * Reference counted, copy-on-write sample storage.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_MEMORY_COWVECTOR_H
+#define QUASAR_MEMORY_COWVECTOR_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Quasar
+{
+	/**
+	 * A vector whose copies share one buffer until one of them is modified.
+	 *
+	 * Copying a CowVector only increments a reference count. The first
+	 * non-const access to a shared buffer (data(), operator[], begin(),
+	 * resize() and friends) copies it, so every copy still behaves as an
+	 * independent vector. Used as the storage of a signal source, copies
+	 * of the source become O(1) and large signals fanned out to several
+	 * read-only consumers exist in memory only once:
+	 *
+	 * @verbatim
+	 * Quasar::SignalSource<double, Quasar::CowVector> signal(samples);
+	 * Quasar::SignalSource<double, Quasar::CowVector> copy = signal;  // no copy
+	 * copy *= 2.0;                                     // copy detaches here @endverbatim
+	 *
+	 * Read through const references to avoid accidental detaching. As
+	 * with any copy-on-write type, pointers obtained from non-const access
+	 * must not be used to write after the vector has been copied, and a
+	 * single object must not be copied and modified concurrently.
+	 * Distinct copies may be used from different threads freely.
+	 */
+	template<typename T, typename Allocator = std::allocator<T>>
+	class CowVector
+	{
+	public:
+		typedef std::vector<T, Allocator> vector_type;
+		typedef T value_type;
+		typedef Allocator allocator_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		/**
+		 * Creates an empty vector, nothing is allocated.
+		 */
+		CowVector():
+			m_buffer()
+		{
+		}
+
+		/**
+		 * Creates a vector of value-initialized elements.
+		 *
+		 * @param count number of elements
+		 */
+		explicit CowVector(size_type count):
+			m_buffer(std::make_shared<vector_type>(count))
+		{
+		}
+
+		/**
+		 * Creates a vector filled with a value.
+		 *
+		 * @param count number of elements
+		 * @param value value of the elements
+		 */
+		CowVector(size_type count, const T& value):
+			m_buffer(std::make_shared<vector_type>(count, value))
+		{
+		}
+
+		/**
+		 * Creates a vector from a range of elements.
+		 *
+		 * @param first beginning of the range
+		 * @param last end of the range
+		 */
+		template<typename InputIterator, typename = typename std::enable_if<
+				!std::is_integral<InputIterator>::value>::type>
+		CowVector(InputIterator first, InputIterator last):
+			m_buffer(std::make_shared<vector_type>(first, last))
+		{
+		}
+
+		/**
+		 * Creates a vector from a list of elements.
+		 *
+		 * @param values elements
+		 */
+		CowVector(std::initializer_list<T> values):
+			m_buffer(std::make_shared<vector_type>(values))
+		{
+		}
+
+		/**
+		 * Takes over the elements of a plain vector.
+		 *
+		 * @param values elements
+		 */
+		explicit CowVector(vector_type values):
+			m_buffer(std::make_shared<vector_type>(std::move(values)))
+		{
+		}
+
+		CowVector(const CowVector& other) = default;
+		CowVector(CowVector&& other) = default;
+		CowVector& operator=(const CowVector& other) = default;
+		CowVector& operator=(CowVector&& other) = default;
+
+		/**
+		 * Returns number of elements.
+		 *
+		 * @return size
+		 */
+		size_type size() const
+		{
+			return m_buffer ? m_buffer->size() : 0;
+		}
+
+		/**
+		 * Checks whether the vector has no elements.
+		 *
+		 * @return true when empty
+		 */
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		/**
+		 * Returns number of elements the buffer can hold without growing.
+		 *
+		 * @return capacity
+		 */
+		size_type capacity() const
+		{
+			return m_buffer ? m_buffer->capacity() : 0;
+		}
+
+		/**
+		 * Read-only access to the elements, never copies the buffer.
+		 *
+		 * @return pointer to the first element
+		 */
+		const T* data() const
+		{
+			return m_buffer ? m_buffer->data() : nullptr;
+		}
+
+		/**
+		 * Writable access to the elements, detaches a shared buffer.
+		 *
+		 * @return pointer to the first element
+		 */
+		T* data()
+		{
+			return m_buffer ? detach().data() : nullptr;
+		}
+
+		const T& operator[](size_type index) const
+		{
+			return (*m_buffer)[index];
+		}
+
+		T& operator[](size_type index)
+		{
+			return detach()[index];
+		}
+
+		const_iterator begin() const
+		{
+			return data();
+		}
+
+		const_iterator end() const
+		{
+			return data() + size();
+		}
+
+		const_iterator cbegin() const
+		{
+			return begin();
+		}
+
+		const_iterator cend() const
+		{
+			return end();
+		}
+
+		iterator begin()
+		{
+			return data();
+		}
+
+		iterator end()
+		{
+			return data() + size();
+		}
+
+		void resize(size_type count)
+		{
+			detach().resize(count);
+		}
+
+		void resize(size_type count, const T& value)
+		{
+			detach().resize(count, value);
+		}
+
+		void reserve(size_type count)
+		{
+			detach().reserve(count);
+		}
+
+		void push_back(const T& value)
+		{
+			detach().push_back(value);
+		}
+
+		void push_back(T&& value)
+		{
+			detach().push_back(std::move(value));
+		}
+
+		template<typename InputIterator>
+		void assign(InputIterator first, InputIterator last)
+		{
+			m_buffer = std::make_shared<vector_type>(first, last);
+		}
+
+		void assign(size_type count, const T& value)
+		{
+			m_buffer = std::make_shared<vector_type>(count, value);
+		}
+
+		/**
+		 * Drops this copy's reference to the buffer.
+		 */
+		void clear()
+		{
+			m_buffer.reset();
+		}
+
+		void swap(CowVector& other)
+		{
+			m_buffer.swap(other.m_buffer);
+		}
+
+		/**
+		 * Checks whether the buffer is shared with other copies.
+		 *
+		 * @return true if a modification would copy the buffer
+		 */
+		bool isShared() const
+		{
+			return m_buffer && m_buffer.use_count() > 1;
+		}
+
+	private:
+		/**
+		 * Makes sure this copy is the only owner of a (possibly new) buffer.
+		 *
+		 * @return the privately owned buffer
+		 */
+		vector_type& detach()
+		{
+			if (!m_buffer)
+			{
+				m_buffer = std::make_shared<vector_type>();
+			}
+			else if (m_buffer.use_count() > 1)
+			{
+				m_buffer = std::make_shared<vector_type>(*m_buffer);
+			}
+			return *m_buffer;
+		}
+
+		/**
+		 * Shared buffer, null for an empty vector which never allocated.
+		 */
+		std::shared_ptr<vector_type> m_buffer;
+	};
+
+	template<typename T, typename Allocator>
+	void swap(CowVector<T, Allocator>& lhs, CowVector<T, Allocator>& rhs)
+	{
+		lhs.swap(rhs);
+	}
+}
+
+#endif // QUASAR_MEMORY_COWVECTOR_H
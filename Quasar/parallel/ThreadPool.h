@@ -0,0 +1,335 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file ThreadPool.h
+ *
+ * A fixed set of worker threads running loops over index ranges.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_PARALLEL_THREADPOOL_H
+#define QUASAR_PARALLEL_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Quasar
+{
+	/**
+	 * Worker threads sharing the iterations of parallel loops.
+	 *
+	 * The thread calling parallelFor() works on the loop too, so a pool
+	 * of N workers runs loops on N + 1 threads; a pool without workers
+	 * runs them sequentially. Iterations are handed out in chunks from a
+	 * shared counter, which balances uneven per-iteration costs.
+	 *
+	 * Loops may be nested or started from several threads at once: a
+	 * waiting thread only waits for workers which already joined its
+	 * loop, never for queued ones, so a busy pool can not deadlock.
+	 *
+	 * @verbatim
+	 * Quasar::ThreadPool pool;
+	 * pool.parallelFor(frames.count(), [&] (std::size_t i) {
+	 *     spectra[i] = analyze(frames.frame(i));
+	 * });                                                      @endverbatim
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * Starts the workers.
+		 *
+		 * @param workers number of worker threads, by default one less
+		 *        than the number of hardware threads
+		 */
+		explicit ThreadPool(std::size_t workers = defaultWorkersCount()):
+			m_stop(false)
+		{
+			m_threads.reserve(workers);
+			for (std::size_t i = 0; i < workers; ++i)
+			{
+				m_threads.emplace_back(&ThreadPool::work, this);
+			}
+		}
+
+		/**
+		 * Finishes queued tasks and joins the workers.
+		 */
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wakeUp.notify_all();
+			for (std::thread& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * Returns a process wide pool with the default number of workers,
+		 * started on first use.
+		 *
+		 * @return the shared pool
+		 */
+		static ThreadPool& shared()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+
+		/**
+		 * Returns number of worker threads.
+		 *
+		 * @return workers count
+		 */
+		std::size_t getWorkersCount() const
+		{
+			return m_threads.size();
+		}
+
+		/**
+		 * Calls body(i) for every i in [0, count), in parallel.
+		 *
+		 * Returns when all iterations are done. If an iteration throws,
+		 * the remaining chunks are skipped and the first exception is
+		 * rethrown here.
+		 *
+		 * @param count number of iterations
+		 * @param body callable taking std::size_t
+		 * @param grain minimum number of consecutive iterations given
+		 *        to one thread at a time
+		 */
+		template<typename Body>
+		void parallelFor(std::size_t count, Body&& body, std::size_t grain = 1)
+		{
+			grain = std::max<std::size_t>(grain, 1);
+			if (m_threads.empty() || count <= grain)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					body(i);
+				}
+				return;
+			}
+
+			// several chunks per thread, for balancing
+			const std::size_t threads = m_threads.size() + 1;
+			const std::size_t chunk = std::max(grain, count / (4 * threads));
+			const std::size_t chunks = (count + chunk - 1) / chunk;
+
+			std::shared_ptr<Loop> loop = std::make_shared<Loop>(count, chunk);
+			std::function<void(std::size_t, std::size_t)> range =
+				[&body] (std::size_t begin, std::size_t end)
+				{
+					for (std::size_t i = begin; i < end; ++i)
+					{
+						body(i);
+					}
+				};
+			loop->range = &range;
+
+			const std::size_t helpers = std::min(m_threads.size(), chunks - 1);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (std::size_t i = 0; i < helpers; ++i)
+				{
+					m_tasks.emplace_back([loop] { loop->help(); });
+				}
+			}
+			if (helpers == 1)
+			{
+				m_wakeUp.notify_one();
+			}
+			else
+			{
+				m_wakeUp.notify_all();
+			}
+
+			loop->run();
+			loop->finish();
+			if (loop->error)
+			{
+				std::rethrow_exception(loop->error);
+			}
+		}
+
+	private:
+		/**
+		 * State of one parallelFor() call, shared with the queued helpers
+		 * which may outlive it.
+		 */
+		struct Loop
+		{
+			Loop(std::size_t count_, std::size_t chunk_):
+				count(count_), chunk(chunk_), next(0), range(nullptr),
+				closed(false), active(0)
+			{
+			}
+
+			/**
+			 * Runs chunks until none is left.
+			 */
+			void run()
+			{
+				for (;;)
+				{
+					const std::size_t begin = next.fetch_add(chunk);
+					if (begin >= count)
+					{
+						return;
+					}
+					try
+					{
+						(*range)(begin, std::min(count, begin + chunk));
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if (!error)
+						{
+							error = std::current_exception();
+						}
+						next.store(count);
+						return;
+					}
+				}
+			}
+
+			/**
+			 * Runs chunks on a worker, unless the loop is already over.
+			 */
+			void help()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (closed)
+					{
+						return;
+					}
+					++active;
+				}
+				run();
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--active == 0)
+				{
+					done.notify_all();
+				}
+			}
+
+			/**
+			 * Stops further helpers from joining and waits for the
+			 * ones which did.
+			 */
+			void finish()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				closed = true;
+				done.wait(lock, [this] { return active == 0; });
+			}
+
+			const std::size_t count;
+			const std::size_t chunk;
+			std::atomic<std::size_t> next;
+			std::function<void(std::size_t, std::size_t)>* range;
+			std::mutex mutex;
+			std::condition_variable done;
+			bool closed;
+			std::size_t active;
+			std::exception_ptr error;
+		};
+
+		/**
+		 * Returns number of workers used by default.
+		 *
+		 * @return hardware threads count minus one, at least one
+		 */
+		static std::size_t defaultWorkersCount()
+		{
+			const std::size_t hardware = std::thread::hardware_concurrency();
+			return (hardware > 1) ? hardware - 1 : 1;
+		}
+
+		/**
+		 * Main loop of the worker threads.
+		 */
+		void work()
+		{
+			for (;;)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wakeUp.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+					if (m_tasks.empty())
+					{
+						return;
+					}
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+		/**
+		 * Worker threads.
+		 */
+		std::vector<std::thread> m_threads;
+
+		/**
+		 * Queued tasks.
+		 */
+		std::deque<std::function<void()>> m_tasks;
+
+		/**
+		 * Guards the queue and the stop flag.
+		 */
+		std::mutex m_mutex;
+
+		/**
+		 * Signalled when a task is queued or the pool stops.
+		 */
+		std::condition_variable m_wakeUp;
+
+		/**
+		 * Set when the pool is being destroyed.
+		 */
+		bool m_stop;
+	};
+}
+
+#endif // QUASAR_PARALLEL_THREADPOOL_H
@@ -0,0 +1,161 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file CpuFeatures.h
+ *
+ * Runtime detection of the SIMD instruction sets supported by the CPU.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SIMD_CPUFEATURES_H
+#define QUASAR_SIMD_CPUFEATURES_H
+
+#include <atomic>
+
+/*
+ * QUASAR_SIMD_X86 is defined when x86 SIMD kernels can be compiled.
+ * QUASAR_SIMD_TARGET marks a function as using a given instruction set,
+ * so the kernels can be built without raising the baseline architecture
+ * of the whole program. Define QUASAR_DISABLE_SIMD to use scalar code only.
+ */
+#if !defined(QUASAR_DISABLE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__i386__))
+	#define QUASAR_SIMD_X86
+	#define QUASAR_SIMD_TARGET(isa) __attribute__((target(isa)))
+	#include <immintrin.h>
+#elif !defined(QUASAR_DISABLE_SIMD) && defined(_MSC_VER) && defined(_M_X64)
+	#define QUASAR_SIMD_X86
+	#define QUASAR_SIMD_TARGET(isa)
+	#include <immintrin.h>
+	#include <intrin.h>
+#endif
+
+namespace Quasar
+{
+namespace Simd
+{
+	/**
+	 * Instruction sets the kernels are written for, in increasing order.
+	 */
+	enum SimdLevel
+	{
+		Scalar = 0,
+		SSE2 = 1,
+		AVX2 = 2,
+		AVX512 = 3
+	};
+
+	/**
+	 * Queries the CPU (and the OS, for register state saving) for the
+	 * best supported instruction set.
+	 *
+	 * @return best supported SIMD level
+	 */
+	inline SimdLevel detectSimdLevel()
+	{
+#if defined(QUASAR_SIMD_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!sse2)
+		{
+			return Scalar;
+		}
+		if (!osxsave || !avx || maxLeaf < 7)
+		{
+			return SSE2;
+		}
+		const unsigned long long xcr0 = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+		if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+		{
+			return AVX512;
+		}
+		if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6)
+		{
+			return AVX2;
+		}
+		return SSE2;
+#elif defined(QUASAR_SIMD_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			return AVX512;
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return AVX2;
+		}
+		if (__builtin_cpu_supports("sse2"))
+		{
+			return SSE2;
+		}
+		return Scalar;
+#else
+		return Scalar;
+#endif
+	}
+
+	/**
+	 * Holds the SIMD level used by the kernels.
+	 *
+	 * Detected once, on first use.
+	 *
+	 * @return reference to the active level
+	 */
+	inline std::atomic<int>& activeSimdLevel()
+	{
+		static std::atomic<int> level(detectSimdLevel());
+		return level;
+	}
+
+	/**
+	 * Returns the SIMD level used by the kernels.
+	 *
+	 * @return active SIMD level
+	 */
+	inline SimdLevel simdLevel()
+	{
+		return static_cast<SimdLevel>(activeSimdLevel().load(std::memory_order_relaxed));
+	}
+
+	/**
+	 * Limits the instruction set used by the kernels.
+	 *
+	 * Mostly useful for comparing kernels with each other. A level higher
+	 * than the detected one is clamped to the detected one.
+	 *
+	 * @param level requested SIMD level
+	 */
+	inline void setSimdLevel(SimdLevel level)
+	{
+		const SimdLevel detected = detectSimdLevel();
+		activeSimdLevel().store(level < detected ? level : detected);
+	}
+}
+}
+
+#endif // QUASAR_SIMD_CPUFEATURES_H
@@ -0,0 +1,696 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file FftKernels.h
+ *
+ * Butterfly passes of the Stockham FFT.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SIMD_FFTKERNELS_H
+#define QUASAR_SIMD_FFTKERNELS_H
+
+#include "CpuFeatures.h"
+#include "SimdKernels.h"
+#include <cstddef>
+
+namespace Quasar
+{
+/**
+ * Passes of a Stockham (self-sorting) FFT over interleaved complex data.
+ *
+ * A transform of length N is a sequence of passes, each reading one
+ * buffer and writing another. A pass of sub-length n works on N / n
+ * interleaved subsequences, s = N / n complex numbers apart, so the
+ * innermost loop runs over s contiguous complex numbers sharing the
+ * same twiddle factors. Once s reaches the register width, whole
+ * registers are processed with a broadcast twiddle. The first pass
+ * (s = 1) is vectorized over butterflies instead, with its own twiddle
+ * table and transposed stores; the scalar loop is left for passes with
+ * s smaller than a register. No bit reversal is needed.
+ *
+ * w is the table of the N roots of unity, w[j] = exp(sign * 2 pi i j / N),
+ * as interleaved real and imaginary parts.
+ */
+namespace Simd
+{
+	/**
+	 * Scalar radix-4 pass, y = pass(x).
+	 *
+	 * @param n sub-length of the pass, multiple of 4
+	 * @param s number of interleaved subsequences
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 * @param w roots of unity table
+	 * @param sign sign of the exponent, 1 or -1
+	 */
+	template<typename Real>
+	inline void radix4PassLoop(std::size_t n, std::size_t s, const Real* x, Real* y,
+			const Real* w, Real sign)
+	{
+		const std::size_t n4 = n / 4;
+		for (std::size_t p = 0; p < n4; ++p)
+		{
+			const Real* w1 = w + 2 * p * s;
+			const Real* w2 = w + 4 * p * s;
+			const Real* w3 = w + 6 * p * s;
+			const Real* xa = x + 2 * s * p;
+			const Real* xb = xa + 2 * s * n4;
+			const Real* xc = xb + 2 * s * n4;
+			const Real* xd = xc + 2 * s * n4;
+			Real* ya = y + 8 * s * p;
+			Real* yb = ya + 2 * s;
+			Real* yc = yb + 2 * s;
+			Real* yd = yc + 2 * s;
+			for (std::size_t q = 0; q < 2 * s; q += 2)
+			{
+				const Real apcRe = xa[q] + xc[q], apcIm = xa[q + 1] + xc[q + 1];
+				const Real amcRe = xa[q] - xc[q], amcIm = xa[q + 1] - xc[q + 1];
+				const Real bpdRe = xb[q] + xd[q], bpdIm = xb[q + 1] + xd[q + 1];
+				// sign * i * (b - d)
+				const Real jbmdRe = -sign * (xb[q + 1] - xd[q + 1]);
+				const Real jbmdIm = sign * (xb[q] - xd[q]);
+				ya[q] = apcRe + bpdRe;
+				ya[q + 1] = apcIm + bpdIm;
+				const Real t1Re = amcRe + jbmdRe, t1Im = amcIm + jbmdIm;
+				yb[q] = t1Re * w1[0] - t1Im * w1[1];
+				yb[q + 1] = t1Re * w1[1] + t1Im * w1[0];
+				const Real t2Re = apcRe - bpdRe, t2Im = apcIm - bpdIm;
+				yc[q] = t2Re * w2[0] - t2Im * w2[1];
+				yc[q + 1] = t2Re * w2[1] + t2Im * w2[0];
+				const Real t3Re = amcRe - jbmdRe, t3Im = amcIm - jbmdIm;
+				yd[q] = t3Re * w3[0] - t3Im * w3[1];
+				yd[q + 1] = t3Re * w3[1] + t3Im * w3[0];
+			}
+		}
+	}
+
+	/**
+	 * Scalar final radix-2 pass (n = 2), for lengths which are odd
+	 * powers of 2.
+	 *
+	 * @param s number of interleaved subsequences, N / 2
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 */
+	template<typename Real>
+	inline void radix2PassLoop(std::size_t s, const Real* x, Real* y)
+	{
+		for (std::size_t q = 0; q < 2 * s; ++q)
+		{
+			const Real a = x[q], b = x[q + 2 * s];
+			y[q] = a + b;
+			y[q + 2 * s] = a - b;
+		}
+	}
+
+	/**
+	 * Direct DFT of R points, for radices without a dedicated butterfly.
+	 */
+	template<std::size_t R>
+	struct Butterfly
+	{
+		/**
+		 * Replaces re, im by their DFT.
+		 *
+		 * @param re real parts of the R points
+		 * @param im imaginary parts of the R points
+		 * @param rootRe real parts of the R-th roots of unity
+		 * @param rootIm imaginary parts of the R-th roots of unity
+		 */
+		template<typename Real>
+		static void apply(Real* re, Real* im, const Real* rootRe, const Real* rootIm)
+		{
+			Real outRe[R], outIm[R];
+			for (std::size_t j = 0; j < R; ++j)
+			{
+				Real sumRe = re[0], sumIm = im[0];
+				for (std::size_t k = 1, t = j; k < R; ++k, t += j)
+				{
+					t = (t >= R) ? t - R : t;
+					sumRe += re[k] * rootRe[t] - im[k] * rootIm[t];
+					sumIm += re[k] * rootIm[t] + im[k] * rootRe[t];
+				}
+				outRe[j] = sumRe;
+				outIm[j] = sumIm;
+			}
+			for (std::size_t j = 0; j < R; ++j)
+			{
+				re[j] = outRe[j];
+				im[j] = outIm[j];
+			}
+		}
+	};
+
+	/**
+	 * DFT of 3 points, with the symmetry of the roots.
+	 */
+	template<>
+	struct Butterfly<3>
+	{
+		template<typename Real>
+		static void apply(Real* re, Real* im, const Real* rootRe, const Real* rootIm)
+		{
+			const Real aRe = re[1] + re[2], aIm = im[1] + im[2];
+			// i * s * (x1 - x2)
+			const Real bRe = -rootIm[1] * (im[1] - im[2]), bIm = rootIm[1] * (re[1] - re[2]);
+			const Real cRe = re[0] + rootRe[1] * aRe, cIm = im[0] + rootRe[1] * aIm;
+			re[0] += aRe;
+			im[0] += aIm;
+			re[1] = cRe + bRe;
+			im[1] = cIm + bIm;
+			re[2] = cRe - bRe;
+			im[2] = cIm - bIm;
+		}
+	};
+
+	/**
+	 * DFT of 5 points, with the symmetry of the roots.
+	 */
+	template<>
+	struct Butterfly<5>
+	{
+		template<typename Real>
+		static void apply(Real* re, Real* im, const Real* rootRe, const Real* rootIm)
+		{
+			const Real c1 = rootRe[1], s1 = rootIm[1], c2 = rootRe[2], s2 = rootIm[2];
+			const Real a1Re = re[1] + re[4], a1Im = im[1] + im[4];
+			const Real b1Re = re[1] - re[4], b1Im = im[1] - im[4];
+			const Real a2Re = re[2] + re[3], a2Im = im[2] + im[3];
+			const Real b2Re = re[2] - re[3], b2Im = im[2] - im[3];
+			const Real c1Re = re[0] + c1 * a1Re + c2 * a2Re, c1Im = im[0] + c1 * a1Im + c2 * a2Im;
+			const Real c2Re = re[0] + c2 * a1Re + c1 * a2Re, c2Im = im[0] + c2 * a1Im + c1 * a2Im;
+			// i * (s1 b1 + s2 b2) and i * (s2 b1 - s1 b2)
+			const Real d1Re = -(s1 * b1Im + s2 * b2Im), d1Im = s1 * b1Re + s2 * b2Re;
+			const Real d2Re = -(s2 * b1Im - s1 * b2Im), d2Im = s2 * b1Re - s1 * b2Re;
+			re[0] += a1Re + a2Re;
+			im[0] += a1Im + a2Im;
+			re[1] = c1Re + d1Re;
+			im[1] = c1Im + d1Im;
+			re[4] = c1Re - d1Re;
+			im[4] = c1Im - d1Im;
+			re[2] = c2Re + d2Re;
+			im[2] = c2Im + d2Im;
+			re[3] = c2Re - d2Re;
+			im[3] = c2Im - d2Im;
+		}
+	};
+
+	/**
+	 * Scalar pass of radix R, a DFT of R points followed by the twiddle
+	 * factors, for the odd radices of mixed radix transforms.
+	 *
+	 * @param n sub-length of the pass, multiple of R
+	 * @param s number of interleaved subsequences
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 * @param w roots of unity table
+	 */
+	template<std::size_t R, typename Real>
+	inline void radixPassLoop(std::size_t n, std::size_t s, const Real* x, Real* y, const Real* w)
+	{
+		const std::size_t m = n / R;
+		// the R-th roots of unity are every (N / R)-th entry of w
+		Real rootRe[R], rootIm[R], twRe[R], twIm[R], re[R], im[R];
+		for (std::size_t t = 0; t < R; ++t)
+		{
+			rootRe[t] = w[2 * s * m * t];
+			rootIm[t] = w[2 * s * m * t + 1];
+		}
+		for (std::size_t p = 0; p < m; ++p)
+		{
+			for (std::size_t j = 1; j < R; ++j)
+			{
+				twRe[j] = w[2 * j * p * s];
+				twIm[j] = w[2 * j * p * s + 1];
+			}
+			const Real* in = x + 2 * s * p;
+			Real* out = y + 2 * s * R * p;
+			for (std::size_t q = 0; q < 2 * s; q += 2)
+			{
+				for (std::size_t k = 0; k < R; ++k)
+				{
+					re[k] = in[q + 2 * s * m * k];
+					im[k] = in[q + 2 * s * m * k + 1];
+				}
+				Butterfly<R>::apply(re, im, rootRe, rootIm);
+				out[q] = re[0];
+				out[q + 1] = im[0];
+				for (std::size_t j = 1; j < R; ++j)
+				{
+					out[q + 2 * s * j] = re[j] * twRe[j] - im[j] * twIm[j];
+					out[q + 2 * s * j + 1] = re[j] * twIm[j] + im[j] * twRe[j];
+				}
+			}
+		}
+	}
+
+	/**
+	 * Scalar pass of radix 2, 3, 5 or 7, see radixPassLoop<R>().
+	 *
+	 * @param r radix of the pass
+	 * @param n sub-length of the pass, multiple of r
+	 * @param s number of interleaved subsequences
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 * @param w roots of unity table
+	 */
+	template<typename Real>
+	inline void radixPassLoop(std::size_t r, std::size_t n, std::size_t s, const Real* x, Real* y,
+			const Real* w)
+	{
+		switch (r)
+		{
+			case 2: radixPassLoop<2>(n, s, x, y, w); break;
+			case 3: radixPassLoop<3>(n, s, x, y, w); break;
+			case 5: radixPassLoop<5>(n, s, x, y, w); break;
+			default: radixPassLoop<7>(n, s, x, y, w); break;
+		}
+	}
+
+#ifdef QUASAR_SIMD_X86
+
+	namespace Avx2
+	{
+		/**
+		 * Register operations of the FFT passes, per precision.
+		 */
+		template<typename Real>
+		struct FftOps;
+
+		template<>
+		struct FftOps<double>
+		{
+			typedef __m256d V;
+			static const std::size_t lanes = 2;
+
+			QUASAR_SIMD_TARGET("avx2")
+			static V load(const double* p) { return _mm256_loadu_pd(p); }
+			QUASAR_SIMD_TARGET("avx2")
+			static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V add(V a, V b) { return _mm256_add_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V swap(V a) { return _mm256_permute_pd(a, 0x5); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V pattern(double re, double im) { return _mm256_setr_pd(re, im, re, im); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V broadcast(double a) { return _mm256_set1_pd(a); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V cmul(V a, V b) { return complexMultiply(a, b); }
+
+			/**
+			 * Stores y0..y3 of two consecutive butterflies, in order.
+			 */
+			QUASAR_SIMD_TARGET("avx2")
+			static void storeTransposed(double* y, V y0, V y1, V y2, V y3)
+			{
+				_mm256_storeu_pd(y, _mm256_permute2f128_pd(y0, y1, 0x20));
+				_mm256_storeu_pd(y + 4, _mm256_permute2f128_pd(y2, y3, 0x20));
+				_mm256_storeu_pd(y + 8, _mm256_permute2f128_pd(y0, y1, 0x31));
+				_mm256_storeu_pd(y + 12, _mm256_permute2f128_pd(y2, y3, 0x31));
+			}
+		};
+
+		template<>
+		struct FftOps<float>
+		{
+			typedef __m256 V;
+			static const std::size_t lanes = 4;
+
+			QUASAR_SIMD_TARGET("avx2")
+			static V load(const float* p) { return _mm256_loadu_ps(p); }
+			QUASAR_SIMD_TARGET("avx2")
+			static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V add(V a, V b) { return _mm256_add_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V swap(V a) { return _mm256_permute_ps(a, 0xB1); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V pattern(float re, float im) { return _mm256_setr_ps(re, im, re, im, re, im, re, im); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V broadcast(float a) { return _mm256_set1_ps(a); }
+			QUASAR_SIMD_TARGET("avx2")
+			static V cmul(V a, V b) { return complexMultiply(a, b); }
+
+			/**
+			 * Stores y0..y3 of four consecutive butterflies, in order
+			 * (a 4x4 transpose of complex numbers).
+			 */
+			QUASAR_SIMD_TARGET("avx2")
+			static void storeTransposed(float* y, V y0, V y1, V y2, V y3)
+			{
+				const __m256d t0 = _mm256_unpacklo_pd(_mm256_castps_pd(y0), _mm256_castps_pd(y1));
+				const __m256d t1 = _mm256_unpackhi_pd(_mm256_castps_pd(y0), _mm256_castps_pd(y1));
+				const __m256d t2 = _mm256_unpacklo_pd(_mm256_castps_pd(y2), _mm256_castps_pd(y3));
+				const __m256d t3 = _mm256_unpackhi_pd(_mm256_castps_pd(y2), _mm256_castps_pd(y3));
+				_mm256_storeu_pd(reinterpret_cast<double*>(y), _mm256_permute2f128_pd(t0, t2, 0x20));
+				_mm256_storeu_pd(reinterpret_cast<double*>(y + 8), _mm256_permute2f128_pd(t1, t3, 0x20));
+				_mm256_storeu_pd(reinterpret_cast<double*>(y + 16), _mm256_permute2f128_pd(t0, t2, 0x31));
+				_mm256_storeu_pd(reinterpret_cast<double*>(y + 24), _mm256_permute2f128_pd(t1, t3, 0x31));
+			}
+		};
+
+		/**
+		 * Radix-4 pass, s must be a multiple of FftOps<Real>::lanes.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx2")
+		inline void radix4Pass(std::size_t n, std::size_t s, const Real* x, Real* y,
+				const Real* w, Real sign)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t n4 = n / 4;
+			const V jsign = Ops::pattern(-sign, sign);
+			for (std::size_t p = 0; p < n4; ++p)
+			{
+				const V w1 = Ops::pattern(w[2 * p * s], w[2 * p * s + 1]);
+				const V w2 = Ops::pattern(w[4 * p * s], w[4 * p * s + 1]);
+				const V w3 = Ops::pattern(w[6 * p * s], w[6 * p * s + 1]);
+				const Real* xa = x + 2 * s * p;
+				const Real* xb = xa + 2 * s * n4;
+				const Real* xc = xb + 2 * s * n4;
+				const Real* xd = xc + 2 * s * n4;
+				Real* ya = y + 8 * s * p;
+				Real* yb = ya + 2 * s;
+				Real* yc = yb + 2 * s;
+				Real* yd = yc + 2 * s;
+				for (std::size_t q = 0; q < 2 * s; q += 2 * Ops::lanes)
+				{
+					const V a = Ops::load(xa + q), b = Ops::load(xb + q);
+					const V c = Ops::load(xc + q), d = Ops::load(xd + q);
+					const V apc = Ops::add(a, c), amc = Ops::sub(a, c);
+					const V bpd = Ops::add(b, d);
+					const V jbmd = Ops::mul(Ops::swap(Ops::sub(b, d)), jsign);
+					Ops::store(ya + q, Ops::add(apc, bpd));
+					Ops::store(yb + q, Ops::cmul(Ops::add(amc, jbmd), w1));
+					Ops::store(yc + q, Ops::cmul(Ops::sub(apc, bpd), w2));
+					Ops::store(yd + q, Ops::cmul(Ops::sub(amc, jbmd), w3));
+				}
+			}
+		}
+
+		/**
+		 * Final radix-2 pass, s must be a multiple of FftOps<Real>::lanes.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx2")
+		inline void radix2Pass(std::size_t s, const Real* x, Real* y)
+		{
+			typedef FftOps<Real> Ops;
+			for (std::size_t q = 0; q < 2 * s; q += 2 * Ops::lanes)
+			{
+				const typename Ops::V a = Ops::load(x + q), b = Ops::load(x + q + 2 * s);
+				Ops::store(y + q, Ops::add(a, b));
+				Ops::store(y + q + 2 * s, Ops::sub(a, b));
+			}
+		}
+
+		/**
+		 * First radix-4 pass (s = 1), vectorized over butterflies.
+		 *
+		 * N / 4 must be a multiple of FftOps<Real>::lanes.
+		 *
+		 * @param n transform length
+		 * @param x input, N complex numbers
+		 * @param y output, N complex numbers
+		 * @param t twiddles of the pass: w^p, then w^2p, then w^3p, each
+		 *        for p = 0 .. N / 4 - 1
+		 * @param sign sign of the exponent, 1 or -1
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx2")
+		inline void radix4FirstPass(std::size_t n, const Real* x, Real* y,
+				const Real* t, Real sign)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t n4 = n / 4;
+			const V jsign = Ops::pattern(-sign, sign);
+			const Real* t1 = t;
+			const Real* t2 = t1 + 2 * n4;
+			const Real* t3 = t2 + 2 * n4;
+			for (std::size_t p = 0; p < 2 * n4; p += 2 * Ops::lanes)
+			{
+				const V a = Ops::load(x + p), b = Ops::load(x + 2 * n4 + p);
+				const V c = Ops::load(x + 4 * n4 + p), d = Ops::load(x + 6 * n4 + p);
+				const V apc = Ops::add(a, c), amc = Ops::sub(a, c);
+				const V bpd = Ops::add(b, d);
+				const V jbmd = Ops::mul(Ops::swap(Ops::sub(b, d)), jsign);
+				Ops::storeTransposed(y + 4 * p,
+						Ops::add(apc, bpd),
+						Ops::cmul(Ops::add(amc, jbmd), Ops::load(t1 + p)),
+						Ops::cmul(Ops::sub(apc, bpd), Ops::load(t2 + p)),
+						Ops::cmul(Ops::sub(amc, jbmd), Ops::load(t3 + p)));
+			}
+		}
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	namespace Avx512
+	{
+		/**
+		 * Register operations of the FFT passes, per precision.
+		 */
+		template<typename Real>
+		struct FftOps;
+
+		template<>
+		struct FftOps<double>
+		{
+			typedef __m512d V;
+			static const std::size_t lanes = 4;
+
+			QUASAR_SIMD_TARGET("avx512f")
+			static V load(const double* p) { return _mm512_loadu_pd(p); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V add(V a, V b) { return _mm512_add_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V swap(V a) { return _mm512_permute_pd(a, 0x55); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V pattern(double re, double im)
+			{
+				return _mm512_setr_pd(re, im, re, im, re, im, re, im);
+			}
+			QUASAR_SIMD_TARGET("avx512f")
+			static V broadcast(double a) { return _mm512_set1_pd(a); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V cmul(V a, V b) { return complexMultiply(a, b); }
+		};
+
+		template<>
+		struct FftOps<float>
+		{
+			typedef __m512 V;
+			static const std::size_t lanes = 8;
+
+			QUASAR_SIMD_TARGET("avx512f")
+			static V load(const float* p) { return _mm512_loadu_ps(p); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V add(V a, V b) { return _mm512_add_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V swap(V a) { return _mm512_permute_ps(a, 0xB1); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V pattern(float re, float im)
+			{
+				return _mm512_setr_ps(re, im, re, im, re, im, re, im,
+						re, im, re, im, re, im, re, im);
+			}
+			QUASAR_SIMD_TARGET("avx512f")
+			static V broadcast(float a) { return _mm512_set1_ps(a); }
+			QUASAR_SIMD_TARGET("avx512f")
+			static V cmul(V a, V b) { return complexMultiply(a, b); }
+		};
+
+		/**
+		 * Radix-4 pass, s must be a multiple of FftOps<Real>::lanes.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void radix4Pass(std::size_t n, std::size_t s, const Real* x, Real* y,
+				const Real* w, Real sign)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t n4 = n / 4;
+			const V jsign = Ops::pattern(-sign, sign);
+			for (std::size_t p = 0; p < n4; ++p)
+			{
+				const V w1 = Ops::pattern(w[2 * p * s], w[2 * p * s + 1]);
+				const V w2 = Ops::pattern(w[4 * p * s], w[4 * p * s + 1]);
+				const V w3 = Ops::pattern(w[6 * p * s], w[6 * p * s + 1]);
+				const Real* xa = x + 2 * s * p;
+				const Real* xb = xa + 2 * s * n4;
+				const Real* xc = xb + 2 * s * n4;
+				const Real* xd = xc + 2 * s * n4;
+				Real* ya = y + 8 * s * p;
+				Real* yb = ya + 2 * s;
+				Real* yc = yb + 2 * s;
+				Real* yd = yc + 2 * s;
+				for (std::size_t q = 0; q < 2 * s; q += 2 * Ops::lanes)
+				{
+					const V a = Ops::load(xa + q), b = Ops::load(xb + q);
+					const V c = Ops::load(xc + q), d = Ops::load(xd + q);
+					const V apc = Ops::add(a, c), amc = Ops::sub(a, c);
+					const V bpd = Ops::add(b, d);
+					const V jbmd = Ops::mul(Ops::swap(Ops::sub(b, d)), jsign);
+					Ops::store(ya + q, Ops::add(apc, bpd));
+					Ops::store(yb + q, Ops::cmul(Ops::add(amc, jbmd), w1));
+					Ops::store(yc + q, Ops::cmul(Ops::sub(apc, bpd), w2));
+					Ops::store(yd + q, Ops::cmul(Ops::sub(amc, jbmd), w3));
+				}
+			}
+		}
+
+		/**
+		 * Final radix-2 pass, s must be a multiple of FftOps<Real>::lanes.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void radix2Pass(std::size_t s, const Real* x, Real* y)
+		{
+			typedef FftOps<Real> Ops;
+			for (std::size_t q = 0; q < 2 * s; q += 2 * Ops::lanes)
+			{
+				const typename Ops::V a = Ops::load(x + q), b = Ops::load(x + q + 2 * s);
+				Ops::store(y + q, Ops::add(a, b));
+				Ops::store(y + q + 2 * s, Ops::sub(a, b));
+			}
+		}
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop
+#endif
+
+#endif // QUASAR_SIMD_X86
+
+	/**
+	 * Radix-4 pass with the widest registers s allows on this CPU.
+	 *
+	 * @param n sub-length of the pass, multiple of 4
+	 * @param s number of interleaved subsequences
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 * @param w roots of unity table
+	 * @param sign sign of the exponent, 1 or -1
+	 */
+	template<typename Real>
+	inline void radix4Pass(std::size_t n, std::size_t s, const Real* x, Real* y,
+			const Real* w, Real sign)
+	{
+#ifdef QUASAR_SIMD_X86
+		const SimdLevel level = simdLevel();
+		if (level >= AVX512 && s % Avx512::FftOps<Real>::lanes == 0)
+		{
+			Avx512::radix4Pass(n, s, x, y, w, sign);
+			return;
+		}
+		if (level >= AVX2 && s % Avx2::FftOps<Real>::lanes == 0)
+		{
+			Avx2::radix4Pass(n, s, x, y, w, sign);
+			return;
+		}
+#endif
+		radix4PassLoop(n, s, x, y, w, sign);
+	}
+
+	/**
+	 * First radix-4 pass (s = 1), vectorized over butterflies when the
+	 * CPU and the length allow it.
+	 *
+	 * @param n transform length, multiple of 4
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 * @param w roots of unity table
+	 * @param t twiddles of the pass, see Avx2::radix4FirstPass()
+	 * @param sign sign of the exponent, 1 or -1
+	 */
+	template<typename Real>
+	inline void radix4FirstPass(std::size_t n, const Real* x, Real* y,
+			const Real* w, const Real* t, Real sign)
+	{
+#ifdef QUASAR_SIMD_X86
+		if (simdLevel() >= AVX2 && (n / 4) % Avx2::FftOps<Real>::lanes == 0)
+		{
+			Avx2::radix4FirstPass(n, x, y, t, sign);
+			return;
+		}
+#endif
+		(void) t;
+		radix4PassLoop(n, std::size_t(1), x, y, w, sign);
+	}
+
+	/**
+	 * Final radix-2 pass with the widest registers s allows on this CPU.
+	 *
+	 * @param s number of interleaved subsequences, N / 2
+	 * @param x input, N complex numbers
+	 * @param y output, N complex numbers
+	 */
+	template<typename Real>
+	inline void radix2Pass(std::size_t s, const Real* x, Real* y)
+	{
+#ifdef QUASAR_SIMD_X86
+		const SimdLevel level = simdLevel();
+		if (level >= AVX512 && s % Avx512::FftOps<Real>::lanes == 0)
+		{
+			Avx512::radix2Pass(s, x, y);
+			return;
+		}
+		if (level >= AVX2 && s % Avx2::FftOps<Real>::lanes == 0)
+		{
+			Avx2::radix2Pass(s, x, y);
+			return;
+		}
+#endif
+		radix2PassLoop(s, x, y);
+	}
+}
+}
+
+#endif // QUASAR_SIMD_FFTKERNELS_H
@@ -0,0 +1,478 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file GoertzelKernels.h
+ *
+ * Per-sample recurrences of Goertzel and sliding DFT banks.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SIMD_GOERTZELKERNELS_H
+#define QUASAR_SIMD_GOERTZELKERNELS_H
+
+#include "CpuFeatures.h"
+#include "FftKernels.h"
+#include <cstddef>
+
+namespace Quasar
+{
+/**
+ * Recurrences tracking single DFT bins sample by sample.
+ *
+ * The state of a bank is kept as structure of arrays, one element per
+ * bin, so a register holds the same quantity of neighbouring bins and
+ * each new sample is broadcast to all of them. Registers of state stay
+ * loaded for a whole block of samples, and two of them are updated at
+ * a time to hide the latency of the recurrences. The vectorized kernels
+ * need the bins count to be a multiple of the register width, which
+ * banks ensure by padding their arrays to a multiple of binsAlignment.
+ */
+namespace Simd
+{
+	/**
+	 * Bins count of a bank is padded to a multiple of this, which covers
+	 * the widest register of any precision.
+	 */
+	const std::size_t binsAlignment = 16;
+
+	/**
+	 * Scalar Goertzel recurrence in Reinsch's form, for bins [from, bins).
+	 *
+	 * With s the state of Goertzel's recurrence, s[n] = x[n] +
+	 * 2 cos(omega) s[n - 1] - s[n - 2], each bin keeps s[n] and d[n] =
+	 * s[n] - sigma s[n - 1], sigma being the sign of cos(omega):
+	 *
+	 * d[n] = x[n] + sigma d[n - 1] + k s[n - 1], s[n] = d[n] + sigma s[n - 1]
+	 *
+	 * where k = 2 cos(omega) - 2 sigma, i.e. -4 sin^2(omega / 2) or
+	 * 4 cos^2(omega / 2). Unlike 2 cos(omega), k is not rounded to 2 for
+	 * bins near 0 and N / 2, so the error grows linearly with the number of
+	 * samples rather than quadratically.
+	 *
+	 * @param x samples
+	 * @param count number of samples
+	 * @param from first bin to update
+	 * @param bins number of bins
+	 * @param c k of each bin, then sigma of each bin, each a row of bins
+	 *          elements
+	 * @param s states s of the bins, updated
+	 * @param d states d of the bins, updated
+	 */
+	template<typename Real>
+	inline void goertzelLoop(const Real* x, std::size_t count, std::size_t from,
+			std::size_t bins, const Real* c, Real* s, Real* d)
+	{
+		// eight bins at a time keep eight recurrences in flight
+		const std::size_t tile = 8;
+		std::size_t b = from;
+		for (; b + tile <= bins; b += tile)
+		{
+			Real k[tile], g[tile], a[tile], z[tile];
+			for (std::size_t j = 0; j < tile; ++j)
+			{
+				k[j] = c[b + j];
+				g[j] = c[bins + b + j];
+				a[j] = s[b + j];
+				z[j] = d[b + j];
+			}
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const Real xi = x[i];
+				for (std::size_t j = 0; j < tile; ++j)
+				{
+					z[j] = (xi + g[j] * z[j]) + k[j] * a[j];
+					a[j] = z[j] + g[j] * a[j];
+				}
+			}
+			for (std::size_t j = 0; j < tile; ++j)
+			{
+				s[b + j] = a[j];
+				d[b + j] = z[j];
+			}
+		}
+		for (; b < bins; ++b)
+		{
+			const Real k = c[b], g = c[bins + b];
+			Real a = s[b], z = d[b];
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				z = (x[i] + g * z) + k * a;
+				a = z + g * a;
+			}
+			s[b] = a;
+			d[b] = z;
+		}
+	}
+
+	/**
+	 * Scalar sliding DFT update, X = a (X - oldest) + b newest, for bins
+	 * [from, bins). The terms of the samples are added last, off the
+	 * dependency chain of X.
+	 *
+	 * @param oldest samples leaving the window
+	 * @param newest samples entering the window
+	 * @param count number of samples
+	 * @param from first bin to update
+	 * @param bins number of bins
+	 * @param w real and imaginary parts of a, then of b, each a row of
+	 *          bins elements
+	 * @param re real parts of the bins, updated
+	 * @param im imaginary parts of the bins, updated
+	 */
+	template<typename Real>
+	inline void slidingDftLoop(const Real* oldest, const Real* newest, std::size_t count,
+			std::size_t from, std::size_t bins, const Real* w, Real* re, Real* im)
+	{
+		const std::size_t tile = 8;
+		std::size_t b = from;
+		for (; b + tile <= bins; b += tile)
+		{
+			Real ar[tile], ai[tile], br[tile], bi[tile], xr[tile], xi[tile];
+			for (std::size_t j = 0; j < tile; ++j)
+			{
+				ar[j] = w[b + j];
+				ai[j] = w[bins + b + j];
+				br[j] = w[2 * bins + b + j];
+				bi[j] = w[3 * bins + b + j];
+				xr[j] = re[b + j];
+				xi[j] = im[b + j];
+			}
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const Real xo = oldest[i], xn = newest[i];
+				for (std::size_t j = 0; j < tile; ++j)
+				{
+					const Real nr = (ar[j] * xr[j] - ai[j] * xi[j]) + (br[j] * xn - ar[j] * xo);
+					xi[j] = (ar[j] * xi[j] + ai[j] * xr[j]) + (bi[j] * xn - ai[j] * xo);
+					xr[j] = nr;
+				}
+			}
+			for (std::size_t j = 0; j < tile; ++j)
+			{
+				re[b + j] = xr[j];
+				im[b + j] = xi[j];
+			}
+		}
+		for (; b < bins; ++b)
+		{
+			const Real ar = w[b], ai = w[bins + b];
+			const Real br = w[2 * bins + b], bi = w[3 * bins + b];
+			Real xr = re[b], xi = im[b];
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const Real nr = (ar * xr - ai * xi) + (br * newest[i] - ar * oldest[i]);
+				xi = (ar * xi + ai * xr) + (bi * newest[i] - ai * oldest[i]);
+				xr = nr;
+			}
+			re[b] = xr;
+			im[b] = xi;
+		}
+	}
+
+#ifdef QUASAR_SIMD_X86
+
+	namespace Avx2
+	{
+		/**
+		 * Goertzel recurrence in Reinsch's form, bins must be a multiple
+		 * of the register width.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx2")
+		inline void goertzel(const Real* x, std::size_t count, std::size_t bins,
+				const Real* c, Real* s, Real* d)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t width = 2 * Ops::lanes;
+			std::size_t b = 0;
+			for (; b + 2 * width <= bins; b += 2 * width)
+			{
+				const V k0 = Ops::load(c + b), k1 = Ops::load(c + b + width);
+				const V g0 = Ops::load(c + bins + b), g1 = Ops::load(c + bins + b + width);
+				V a0 = Ops::load(s + b), a1 = Ops::load(s + b + width);
+				V z0 = Ops::load(d + b), z1 = Ops::load(d + b + width);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xi = Ops::broadcast(x[i]);
+					z0 = Ops::add(Ops::add(xi, Ops::mul(g0, z0)), Ops::mul(k0, a0));
+					z1 = Ops::add(Ops::add(xi, Ops::mul(g1, z1)), Ops::mul(k1, a1));
+					a0 = Ops::add(z0, Ops::mul(g0, a0));
+					a1 = Ops::add(z1, Ops::mul(g1, a1));
+				}
+				Ops::store(s + b, a0);
+				Ops::store(s + b + width, a1);
+				Ops::store(d + b, z0);
+				Ops::store(d + b + width, z1);
+			}
+			for (; b < bins; b += width)
+			{
+				const V k0 = Ops::load(c + b), g0 = Ops::load(c + bins + b);
+				V a0 = Ops::load(s + b), z0 = Ops::load(d + b);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					z0 = Ops::add(Ops::add(Ops::broadcast(x[i]), Ops::mul(g0, z0)), Ops::mul(k0, a0));
+					a0 = Ops::add(z0, Ops::mul(g0, a0));
+				}
+				Ops::store(s + b, a0);
+				Ops::store(d + b, z0);
+			}
+		}
+
+		/**
+		 * Sliding DFT update, bins must be a multiple of the register
+		 * width.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx2")
+		inline void slidingDft(const Real* oldest, const Real* newest, std::size_t count,
+				std::size_t bins, const Real* w, Real* re, Real* im)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t width = 2 * Ops::lanes;
+			std::size_t b = 0;
+			for (; b + 2 * width <= bins; b += 2 * width)
+			{
+				const std::size_t e = b + width;
+				const V ar0 = Ops::load(w + b), ai0 = Ops::load(w + bins + b);
+				const V br0 = Ops::load(w + 2 * bins + b), bi0 = Ops::load(w + 3 * bins + b);
+				const V ar1 = Ops::load(w + e), ai1 = Ops::load(w + bins + e);
+				const V br1 = Ops::load(w + 2 * bins + e), bi1 = Ops::load(w + 3 * bins + e);
+				V xr0 = Ops::load(re + b), xi0 = Ops::load(im + b);
+				V xr1 = Ops::load(re + e), xi1 = Ops::load(im + e);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xo = Ops::broadcast(oldest[i]), xn = Ops::broadcast(newest[i]);
+					const V nr0 = Ops::add(Ops::sub(Ops::mul(ar0, xr0), Ops::mul(ai0, xi0)),
+							Ops::sub(Ops::mul(br0, xn), Ops::mul(ar0, xo)));
+					const V nr1 = Ops::add(Ops::sub(Ops::mul(ar1, xr1), Ops::mul(ai1, xi1)),
+							Ops::sub(Ops::mul(br1, xn), Ops::mul(ar1, xo)));
+					xi0 = Ops::add(Ops::add(Ops::mul(ar0, xi0), Ops::mul(ai0, xr0)),
+							Ops::sub(Ops::mul(bi0, xn), Ops::mul(ai0, xo)));
+					xi1 = Ops::add(Ops::add(Ops::mul(ar1, xi1), Ops::mul(ai1, xr1)),
+							Ops::sub(Ops::mul(bi1, xn), Ops::mul(ai1, xo)));
+					xr0 = nr0;
+					xr1 = nr1;
+				}
+				Ops::store(re + b, xr0);
+				Ops::store(im + b, xi0);
+				Ops::store(re + e, xr1);
+				Ops::store(im + e, xi1);
+			}
+			for (; b < bins; b += width)
+			{
+				const V ar = Ops::load(w + b), ai = Ops::load(w + bins + b);
+				const V br = Ops::load(w + 2 * bins + b), bi = Ops::load(w + 3 * bins + b);
+				V xr = Ops::load(re + b), xi = Ops::load(im + b);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xo = Ops::broadcast(oldest[i]), xn = Ops::broadcast(newest[i]);
+					const V nr = Ops::add(Ops::sub(Ops::mul(ar, xr), Ops::mul(ai, xi)),
+							Ops::sub(Ops::mul(br, xn), Ops::mul(ar, xo)));
+					xi = Ops::add(Ops::add(Ops::mul(ar, xi), Ops::mul(ai, xr)),
+							Ops::sub(Ops::mul(bi, xn), Ops::mul(ai, xo)));
+					xr = nr;
+				}
+				Ops::store(re + b, xr);
+				Ops::store(im + b, xi);
+			}
+		}
+	}
+
+	namespace Avx512
+	{
+		/**
+		 * Goertzel recurrence in Reinsch's form, bins must be a multiple
+		 * of the register width.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void goertzel(const Real* x, std::size_t count, std::size_t bins,
+				const Real* c, Real* s, Real* d)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t width = 2 * Ops::lanes;
+			std::size_t b = 0;
+			for (; b + 2 * width <= bins; b += 2 * width)
+			{
+				const V k0 = Ops::load(c + b), k1 = Ops::load(c + b + width);
+				const V g0 = Ops::load(c + bins + b), g1 = Ops::load(c + bins + b + width);
+				V a0 = Ops::load(s + b), a1 = Ops::load(s + b + width);
+				V z0 = Ops::load(d + b), z1 = Ops::load(d + b + width);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xi = Ops::broadcast(x[i]);
+					z0 = Ops::add(Ops::add(xi, Ops::mul(g0, z0)), Ops::mul(k0, a0));
+					z1 = Ops::add(Ops::add(xi, Ops::mul(g1, z1)), Ops::mul(k1, a1));
+					a0 = Ops::add(z0, Ops::mul(g0, a0));
+					a1 = Ops::add(z1, Ops::mul(g1, a1));
+				}
+				Ops::store(s + b, a0);
+				Ops::store(s + b + width, a1);
+				Ops::store(d + b, z0);
+				Ops::store(d + b + width, z1);
+			}
+			for (; b < bins; b += width)
+			{
+				const V k0 = Ops::load(c + b), g0 = Ops::load(c + bins + b);
+				V a0 = Ops::load(s + b), z0 = Ops::load(d + b);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					z0 = Ops::add(Ops::add(Ops::broadcast(x[i]), Ops::mul(g0, z0)), Ops::mul(k0, a0));
+					a0 = Ops::add(z0, Ops::mul(g0, a0));
+				}
+				Ops::store(s + b, a0);
+				Ops::store(d + b, z0);
+			}
+		}
+
+		/**
+		 * Sliding DFT update, bins must be a multiple of the register
+		 * width.
+		 */
+		template<typename Real>
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void slidingDft(const Real* oldest, const Real* newest, std::size_t count,
+				std::size_t bins, const Real* w, Real* re, Real* im)
+		{
+			typedef FftOps<Real> Ops;
+			typedef typename Ops::V V;
+			const std::size_t width = 2 * Ops::lanes;
+			std::size_t b = 0;
+			for (; b + 2 * width <= bins; b += 2 * width)
+			{
+				const std::size_t e = b + width;
+				const V ar0 = Ops::load(w + b), ai0 = Ops::load(w + bins + b);
+				const V br0 = Ops::load(w + 2 * bins + b), bi0 = Ops::load(w + 3 * bins + b);
+				const V ar1 = Ops::load(w + e), ai1 = Ops::load(w + bins + e);
+				const V br1 = Ops::load(w + 2 * bins + e), bi1 = Ops::load(w + 3 * bins + e);
+				V xr0 = Ops::load(re + b), xi0 = Ops::load(im + b);
+				V xr1 = Ops::load(re + e), xi1 = Ops::load(im + e);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xo = Ops::broadcast(oldest[i]), xn = Ops::broadcast(newest[i]);
+					const V nr0 = Ops::add(Ops::sub(Ops::mul(ar0, xr0), Ops::mul(ai0, xi0)),
+							Ops::sub(Ops::mul(br0, xn), Ops::mul(ar0, xo)));
+					const V nr1 = Ops::add(Ops::sub(Ops::mul(ar1, xr1), Ops::mul(ai1, xi1)),
+							Ops::sub(Ops::mul(br1, xn), Ops::mul(ar1, xo)));
+					xi0 = Ops::add(Ops::add(Ops::mul(ar0, xi0), Ops::mul(ai0, xr0)),
+							Ops::sub(Ops::mul(bi0, xn), Ops::mul(ai0, xo)));
+					xi1 = Ops::add(Ops::add(Ops::mul(ar1, xi1), Ops::mul(ai1, xr1)),
+							Ops::sub(Ops::mul(bi1, xn), Ops::mul(ai1, xo)));
+					xr0 = nr0;
+					xr1 = nr1;
+				}
+				Ops::store(re + b, xr0);
+				Ops::store(im + b, xi0);
+				Ops::store(re + e, xr1);
+				Ops::store(im + e, xi1);
+			}
+			for (; b < bins; b += width)
+			{
+				const V ar = Ops::load(w + b), ai = Ops::load(w + bins + b);
+				const V br = Ops::load(w + 2 * bins + b), bi = Ops::load(w + 3 * bins + b);
+				V xr = Ops::load(re + b), xi = Ops::load(im + b);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const V xo = Ops::broadcast(oldest[i]), xn = Ops::broadcast(newest[i]);
+					const V nr = Ops::add(Ops::sub(Ops::mul(ar, xr), Ops::mul(ai, xi)),
+							Ops::sub(Ops::mul(br, xn), Ops::mul(ar, xo)));
+					xi = Ops::add(Ops::add(Ops::mul(ar, xi), Ops::mul(ai, xr)),
+							Ops::sub(Ops::mul(bi, xn), Ops::mul(ai, xo)));
+					xr = nr;
+				}
+				Ops::store(re + b, xr);
+				Ops::store(im + b, xi);
+			}
+		}
+	}
+
+#endif // QUASAR_SIMD_X86
+
+	/**
+	 * Runs the Goertzel recurrence of a bank over a block of samples,
+	 * with the widest registers the bins count allows on this CPU.
+	 *
+	 * @param x samples
+	 * @param count number of samples
+	 * @param bins number of bins
+	 * @param c coefficients, see goertzelLoop()
+	 * @param s states s of the bins, updated
+	 * @param d states d of the bins, updated
+	 */
+	template<typename Real>
+	inline void goertzel(const Real* x, std::size_t count, std::size_t bins,
+			const Real* c, Real* s, Real* d)
+	{
+#ifdef QUASAR_SIMD_X86
+		const SimdLevel level = simdLevel();
+		if (level >= AVX512 && bins % (2 * Avx512::FftOps<Real>::lanes) == 0)
+		{
+			Avx512::goertzel(x, count, bins, c, s, d);
+			return;
+		}
+		if (level >= AVX2 && bins % (2 * Avx2::FftOps<Real>::lanes) == 0)
+		{
+			Avx2::goertzel(x, count, bins, c, s, d);
+			return;
+		}
+#endif
+		goertzelLoop(x, count, std::size_t(0), bins, c, s, d);
+	}
+
+	/**
+	 * Slides the window of a sliding DFT bank over a block of samples,
+	 * with the widest registers the bins count allows on this CPU.
+	 *
+	 * @param oldest samples leaving the window
+	 * @param newest samples entering the window
+	 * @param count number of samples
+	 * @param bins number of bins
+	 * @param w coefficients, see slidingDftLoop()
+	 * @param re real parts of the bins, updated
+	 * @param im imaginary parts of the bins, updated
+	 */
+	template<typename Real>
+	inline void slidingDft(const Real* oldest, const Real* newest, std::size_t count,
+			std::size_t bins, const Real* w, Real* re, Real* im)
+	{
+#ifdef QUASAR_SIMD_X86
+		const SimdLevel level = simdLevel();
+		if (level >= AVX512 && bins % (2 * Avx512::FftOps<Real>::lanes) == 0)
+		{
+			Avx512::slidingDft(oldest, newest, count, bins, w, re, im);
+			return;
+		}
+		if (level >= AVX2 && bins % (2 * Avx2::FftOps<Real>::lanes) == 0)
+		{
+			Avx2::slidingDft(oldest, newest, count, bins, w, re, im);
+			return;
+		}
+#endif
+		slidingDftLoop(oldest, newest, count, std::size_t(0), bins, w, re, im);
+	}
+}
+}
+
+#endif // QUASAR_SIMD_GOERTZELKERNELS_H
@@ -0,0 +1,893 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SimdKernels.h
+ *
+ * Vectorized element-wise kernels with runtime instruction set dispatch.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SIMD_SIMDKERNELS_H
+#define QUASAR_SIMD_SIMDKERNELS_H
+
+#include "CpuFeatures.h"
+#include <complex>
+#include <cstddef>
+
+namespace Quasar
+{
+/**
+ * Element-wise kernels used by the signal arithmetic.
+ *
+ * The public functions of this namespace work in place on C-style arrays
+ * and pick the widest instruction set available on the running CPU
+ * (see simdLevel()). float, double and std::complex of both have
+ * hand-vectorized SSE2, AVX2 and AVX-512 versions; any other type falls
+ * back to a plain loop. Complex multiplication never goes through
+ * std::complex::operator*, which handles NaN/infinity corner cases in
+ * slow library code.
+ *
+ * Complex arrays are processed as arrays of interleaved real and
+ * imaginary parts, the layout std::complex guarantees.
+ */
+namespace Simd
+{
+	/**
+	 * Scalar complex multiplication on interleaved data, a[i] = b[i] * a[i].
+	 *
+	 * @param a complex numbers, updated in place
+	 * @param b complex numbers to multiply by
+	 * @param from index of the first complex number to process
+	 * @param count index past the last complex number to process
+	 */
+	template<typename Real>
+	inline void complexMultiplyLoop(Real* a, const Real* b, std::size_t from, std::size_t count)
+	{
+		for (std::size_t i = from; i < count; ++i)
+		{
+			const Real re = a[2 * i], im = a[2 * i + 1];
+			a[2 * i] = b[2 * i] * re - b[2 * i + 1] * im;
+			a[2 * i + 1] = b[2 * i] * im + b[2 * i + 1] * re;
+		}
+	}
+
+	/**
+	 * Scalar complex multiplication by a constant on interleaved data.
+	 *
+	 * @param a complex numbers, updated in place
+	 * @param from index of the first complex number to process
+	 * @param count index past the last complex number to process
+	 * @param re real part of the multiplier
+	 * @param im imaginary part of the multiplier
+	 */
+	template<typename Real>
+	inline void complexScaleLoop(Real* a, std::size_t from, std::size_t count, Real re, Real im)
+	{
+		for (std::size_t i = from; i < count; ++i)
+		{
+			const Real x = a[2 * i], y = a[2 * i + 1];
+			a[2 * i] = re * x - im * y;
+			a[2 * i + 1] = re * y + im * x;
+		}
+	}
+
+	/**
+	 * Scalar a[i] = p[i % 2] + a[i]. A real constant is a pattern with
+	 * p0 == p1, a complex one is its real and imaginary part.
+	 */
+	template<typename Real>
+	inline void addPatternLoop(Real* a, std::size_t from, std::size_t n, Real p0, Real p1)
+	{
+		for (std::size_t i = from; i < n; ++i)
+		{
+			a[i] = ((i & 1) ? p1 : p0) + a[i];
+		}
+	}
+
+	/**
+	 * Scalar a[i] = p[i % 2] * a[i].
+	 */
+	template<typename Real>
+	inline void multiplyPatternLoop(Real* a, std::size_t from, std::size_t n, Real p0, Real p1)
+	{
+		for (std::size_t i = from; i < n; ++i)
+		{
+			a[i] = ((i & 1) ? p1 : p0) * a[i];
+		}
+	}
+
+#ifdef QUASAR_SIMD_X86
+
+	/**
+	 * SSE2 kernels, two doubles or four floats per register.
+	 */
+	namespace Sse2
+	{
+		QUASAR_SIMD_TARGET("sse2")
+		inline void add(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2)
+			{
+				_mm_storeu_pd(a + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void add(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm_storeu_ps(a + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void multiply(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2)
+			{
+				_mm_storeu_pd(a + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void multiply(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm_storeu_ps(a + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void addPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m128d p = _mm_setr_pd(p0, p1);
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2)
+			{
+				_mm_storeu_pd(a + i, _mm_add_pd(p, _mm_loadu_pd(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void addPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m128 p = _mm_setr_ps(p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm_storeu_ps(a + i, _mm_add_ps(p, _mm_loadu_ps(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void multiplyPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m128d p = _mm_setr_pd(p0, p1);
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2)
+			{
+				_mm_storeu_pd(a + i, _mm_mul_pd(p, _mm_loadu_pd(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void multiplyPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m128 p = _mm_setr_ps(p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm_storeu_ps(a + i, _mm_mul_ps(p, _mm_loadu_ps(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		/**
+		 * (a + bi)(c + di) for one complex double per register.
+		 */
+		QUASAR_SIMD_TARGET("sse2")
+		inline __m128d complexMultiply(__m128d x, __m128d y)
+		{
+			const __m128d sign = _mm_setr_pd(-0.0, 0.0);
+			const __m128d yre = _mm_unpacklo_pd(y, y);
+			const __m128d yim = _mm_unpackhi_pd(y, y);
+			const __m128d xs = _mm_shuffle_pd(x, x, 1);
+			return _mm_add_pd(_mm_mul_pd(x, yre), _mm_xor_pd(_mm_mul_pd(xs, yim), sign));
+		}
+
+		/**
+		 * (a + bi)(c + di) for two complex floats per register.
+		 */
+		QUASAR_SIMD_TARGET("sse2")
+		inline __m128 complexMultiply(__m128 x, __m128 y)
+		{
+			const __m128 sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+			const __m128 yre = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0));
+			const __m128 yim = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1));
+			const __m128 xs = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm_add_ps(_mm_mul_ps(x, yre), _mm_xor_ps(_mm_mul_ps(xs, yim), sign));
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void complexMultiply(double* a, const double* b, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				_mm_storeu_pd(a + 2 * i, complexMultiply(_mm_loadu_pd(a + 2 * i), _mm_loadu_pd(b + 2 * i)));
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void complexMultiply(float* a, const float* b, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				_mm_storeu_ps(a + 2 * i, complexMultiply(_mm_loadu_ps(a + 2 * i), _mm_loadu_ps(b + 2 * i)));
+			}
+			complexMultiplyLoop(a, b, i, count);
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void complexScale(double* a, std::size_t count, double re, double im)
+		{
+			const __m128d y = _mm_setr_pd(re, im);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				_mm_storeu_pd(a + 2 * i, complexMultiply(_mm_loadu_pd(a + 2 * i), y));
+			}
+		}
+
+		QUASAR_SIMD_TARGET("sse2")
+		inline void complexScale(float* a, std::size_t count, float re, float im)
+		{
+			const __m128 y = _mm_setr_ps(re, im, re, im);
+			std::size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				_mm_storeu_ps(a + 2 * i, complexMultiply(_mm_loadu_ps(a + 2 * i), y));
+			}
+			complexScaleLoop(a, i, count, re, im);
+		}
+	}
+
+	/**
+	 * AVX2 kernels, four doubles or eight floats per register.
+	 */
+	namespace Avx2
+	{
+		QUASAR_SIMD_TARGET("avx2")
+		inline void add(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm256_storeu_pd(a + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void add(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm256_storeu_ps(a + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void multiply(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void multiply(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm256_storeu_ps(a + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void addPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m256d p = _mm256_setr_pd(p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm256_storeu_pd(a + i, _mm256_add_pd(p, _mm256_loadu_pd(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void addPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m256 p = _mm256_setr_ps(p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm256_storeu_ps(a + i, _mm256_add_ps(p, _mm256_loadu_ps(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void multiplyPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m256d p = _mm256_setr_pd(p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm256_storeu_pd(a + i, _mm256_mul_pd(p, _mm256_loadu_pd(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void multiplyPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m256 p = _mm256_setr_ps(p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm256_storeu_ps(a + i, _mm256_mul_ps(p, _mm256_loadu_ps(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		/**
+		 * (a + bi)(c + di) for two complex doubles per register.
+		 */
+		QUASAR_SIMD_TARGET("avx2")
+		inline __m256d complexMultiply(__m256d x, __m256d y)
+		{
+			const __m256d yre = _mm256_movedup_pd(y);
+			const __m256d yim = _mm256_permute_pd(y, 0xF);
+			const __m256d xs = _mm256_permute_pd(x, 0x5);
+			return _mm256_addsub_pd(_mm256_mul_pd(x, yre), _mm256_mul_pd(xs, yim));
+		}
+
+		/**
+		 * (a + bi)(c + di) for four complex floats per register.
+		 */
+		QUASAR_SIMD_TARGET("avx2")
+		inline __m256 complexMultiply(__m256 x, __m256 y)
+		{
+			const __m256 yre = _mm256_moveldup_ps(y);
+			const __m256 yim = _mm256_movehdup_ps(y);
+			const __m256 xs = _mm256_permute_ps(x, 0xB1);
+			return _mm256_addsub_ps(_mm256_mul_ps(x, yre), _mm256_mul_ps(xs, yim));
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void complexMultiply(double* a, const double* b, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				_mm256_storeu_pd(a + 2 * i, complexMultiply(_mm256_loadu_pd(a + 2 * i), _mm256_loadu_pd(b + 2 * i)));
+			}
+			complexMultiplyLoop(a, b, i, count);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void complexMultiply(float* a, const float* b, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm256_storeu_ps(a + 2 * i, complexMultiply(_mm256_loadu_ps(a + 2 * i), _mm256_loadu_ps(b + 2 * i)));
+			}
+			complexMultiplyLoop(a, b, i, count);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void complexScale(double* a, std::size_t count, double re, double im)
+		{
+			const __m256d y = _mm256_setr_pd(re, im, re, im);
+			std::size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				_mm256_storeu_pd(a + 2 * i, complexMultiply(_mm256_loadu_pd(a + 2 * i), y));
+			}
+			complexScaleLoop(a, i, count, re, im);
+		}
+
+		QUASAR_SIMD_TARGET("avx2")
+		inline void complexScale(float* a, std::size_t count, float re, float im)
+		{
+			const __m256 y = _mm256_setr_ps(re, im, re, im, re, im, re, im);
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm256_storeu_ps(a + 2 * i, complexMultiply(_mm256_loadu_ps(a + 2 * i), y));
+			}
+			complexScaleLoop(a, i, count, re, im);
+		}
+	}
+
+	/*
+	 * GCC 12 warns about the deliberately undefined registers used inside
+	 * its own AVX-512 intrinsics (GCC bug 105593).
+	 */
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	/**
+	 * AVX-512 kernels, eight doubles or sixteen floats per register.
+	 */
+	namespace Avx512
+	{
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void add(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm512_storeu_pd(a + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void add(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				_mm512_storeu_ps(a + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] + b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void multiply(double* a, const double* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm512_storeu_pd(a + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void multiply(float* a, const float* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				_mm512_storeu_ps(a + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+			}
+			for (; i < n; ++i)
+			{
+				a[i] = a[i] * b[i];
+			}
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void addPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m512d p = _mm512_setr_pd(p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm512_storeu_pd(a + i, _mm512_add_pd(p, _mm512_loadu_pd(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void addPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m512 p = _mm512_setr_ps(p0, p1, p0, p1, p0, p1, p0, p1,
+					p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				_mm512_storeu_ps(a + i, _mm512_add_ps(p, _mm512_loadu_ps(a + i)));
+			}
+			addPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void multiplyPattern(double* a, std::size_t n, double p0, double p1)
+		{
+			const __m512d p = _mm512_setr_pd(p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm512_storeu_pd(a + i, _mm512_mul_pd(p, _mm512_loadu_pd(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void multiplyPattern(float* a, std::size_t n, float p0, float p1)
+		{
+			const __m512 p = _mm512_setr_ps(p0, p1, p0, p1, p0, p1, p0, p1,
+					p0, p1, p0, p1, p0, p1, p0, p1);
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				_mm512_storeu_ps(a + i, _mm512_mul_ps(p, _mm512_loadu_ps(a + i)));
+			}
+			multiplyPatternLoop(a, i, n, p0, p1);
+		}
+
+		/**
+		 * (a + bi)(c + di) for four complex doubles per register.
+		 */
+		QUASAR_SIMD_TARGET("avx512f")
+		inline __m512d complexMultiply(__m512d x, __m512d y)
+		{
+			const __m512d yre = _mm512_movedup_pd(y);
+			const __m512d yim = _mm512_permute_pd(y, 0xFF);
+			const __m512d xs = _mm512_permute_pd(x, 0x55);
+			return _mm512_fmaddsub_pd(x, yre, _mm512_mul_pd(xs, yim));
+		}
+
+		/**
+		 * (a + bi)(c + di) for eight complex floats per register.
+		 */
+		QUASAR_SIMD_TARGET("avx512f")
+		inline __m512 complexMultiply(__m512 x, __m512 y)
+		{
+			const __m512 yre = _mm512_moveldup_ps(y);
+			const __m512 yim = _mm512_movehdup_ps(y);
+			const __m512 xs = _mm512_permute_ps(x, 0xB1);
+			return _mm512_fmaddsub_ps(x, yre, _mm512_mul_ps(xs, yim));
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void complexMultiply(double* a, const double* b, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm512_storeu_pd(a + 2 * i, complexMultiply(_mm512_loadu_pd(a + 2 * i), _mm512_loadu_pd(b + 2 * i)));
+			}
+			complexMultiplyLoop(a, b, i, count);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void complexMultiply(float* a, const float* b, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				_mm512_storeu_ps(a + 2 * i, complexMultiply(_mm512_loadu_ps(a + 2 * i), _mm512_loadu_ps(b + 2 * i)));
+			}
+			complexMultiplyLoop(a, b, i, count);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void complexScale(double* a, std::size_t count, double re, double im)
+		{
+			const __m512d y = _mm512_setr_pd(re, im, re, im, re, im, re, im);
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm512_storeu_pd(a + 2 * i, complexMultiply(_mm512_loadu_pd(a + 2 * i), y));
+			}
+			complexScaleLoop(a, i, count, re, im);
+		}
+
+		QUASAR_SIMD_TARGET("avx512f")
+		inline void complexScale(float* a, std::size_t count, float re, float im)
+		{
+			const __m512 y = _mm512_setr_ps(re, im, re, im, re, im, re, im,
+					re, im, re, im, re, im, re, im);
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				_mm512_storeu_ps(a + 2 * i, complexMultiply(_mm512_loadu_ps(a + 2 * i), y));
+			}
+			complexScaleLoop(a, i, count, re, im);
+		}
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop
+#endif
+
+#endif // QUASAR_SIMD_X86
+
+	/**
+	 * Picks the kernel of the active instruction set.
+	 */
+#ifdef QUASAR_SIMD_X86
+	#define QUASAR_SIMD_DISPATCH(kernel, fallback, ...) \
+		switch (simdLevel()) \
+		{ \
+		case AVX512: Avx512::kernel(__VA_ARGS__); break; \
+		case AVX2: Avx2::kernel(__VA_ARGS__); break; \
+		case SSE2: Sse2::kernel(__VA_ARGS__); break; \
+		default: fallback; break; \
+		}
+#else
+	#define QUASAR_SIMD_DISPATCH(kernel, fallback, ...) fallback;
+#endif
+
+	/**
+	 * Real kernels, shared by real and complex element types.
+	 */
+	template<typename Real>
+	inline void addReal(Real* a, const Real* b, std::size_t n)
+	{
+		QUASAR_SIMD_DISPATCH(add,
+			for (std::size_t i = 0; i < n; ++i) { a[i] = a[i] + b[i]; },
+			a, b, n)
+	}
+
+	template<typename Real>
+	inline void multiplyReal(Real* a, const Real* b, std::size_t n)
+	{
+		QUASAR_SIMD_DISPATCH(multiply,
+			for (std::size_t i = 0; i < n; ++i) { a[i] = a[i] * b[i]; },
+			a, b, n)
+	}
+
+	template<typename Real>
+	inline void addPattern(Real* a, std::size_t n, Real p0, Real p1)
+	{
+		QUASAR_SIMD_DISPATCH(addPattern, addPatternLoop(a, 0, n, p0, p1), a, n, p0, p1)
+	}
+
+	template<typename Real>
+	inline void multiplyPattern(Real* a, std::size_t n, Real p0, Real p1)
+	{
+		QUASAR_SIMD_DISPATCH(multiplyPattern, multiplyPatternLoop(a, 0, n, p0, p1), a, n, p0, p1)
+	}
+
+	template<typename Real>
+	inline void complexMultiply(Real* a, const Real* b, std::size_t count)
+	{
+		QUASAR_SIMD_DISPATCH(complexMultiply, complexMultiplyLoop(a, b, 0, count), a, b, count)
+	}
+
+	template<typename Real>
+	inline void complexScale(Real* a, std::size_t count, Real re, Real im)
+	{
+		QUASAR_SIMD_DISPATCH(complexScale, complexScaleLoop(a, 0, count, re, im), a, count, re, im)
+	}
+
+	#undef QUASAR_SIMD_DISPATCH
+
+	/**
+	 * a[i] = a[i] + b[i], generic version.
+	 *
+	 * @param a samples, updated in place
+	 * @param b samples to add
+	 * @param n number of samples
+	 */
+	template<typename DataType>
+	inline void add(DataType* a, const DataType* b, std::size_t n)
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			a[i] = a[i] + b[i];
+		}
+	}
+
+	inline void add(double* a, const double* b, std::size_t n)
+	{
+		addReal(a, b, n);
+	}
+
+	inline void add(float* a, const float* b, std::size_t n)
+	{
+		addReal(a, b, n);
+	}
+
+	inline void add(std::complex<double>* a, const std::complex<double>* b, std::size_t n)
+	{
+		addReal(reinterpret_cast<double*>(a), reinterpret_cast<const double*>(b), 2 * n);
+	}
+
+	inline void add(std::complex<float>* a, const std::complex<float>* b, std::size_t n)
+	{
+		addReal(reinterpret_cast<float*>(a), reinterpret_cast<const float*>(b), 2 * n);
+	}
+
+	/**
+	 * a[i] = a[i] * b[i], generic version.
+	 *
+	 * @param a samples, updated in place
+	 * @param b samples to multiply by
+	 * @param n number of samples
+	 */
+	template<typename DataType>
+	inline void multiply(DataType* a, const DataType* b, std::size_t n)
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			a[i] = a[i] * b[i];
+		}
+	}
+
+	inline void multiply(double* a, const double* b, std::size_t n)
+	{
+		multiplyReal(a, b, n);
+	}
+
+	inline void multiply(float* a, const float* b, std::size_t n)
+	{
+		multiplyReal(a, b, n);
+	}
+
+	inline void multiply(std::complex<double>* a, const std::complex<double>* b, std::size_t n)
+	{
+		complexMultiply(reinterpret_cast<double*>(a), reinterpret_cast<const double*>(b), n);
+	}
+
+	inline void multiply(std::complex<float>* a, const std::complex<float>* b, std::size_t n)
+	{
+		complexMultiply(reinterpret_cast<float*>(a), reinterpret_cast<const float*>(b), n);
+	}
+
+	/**
+	 * a[i] = x + a[i], generic version.
+	 *
+	 * @param a samples, updated in place
+	 * @param n number of samples
+	 * @param x value to add
+	 */
+	template<typename DataType, typename Numeric>
+	inline void add(DataType* a, std::size_t n, Numeric x)
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			a[i] = x + a[i];
+		}
+	}
+
+	inline void add(double* a, std::size_t n, double x)
+	{
+		addPattern(a, n, x, x);
+	}
+
+	inline void add(float* a, std::size_t n, float x)
+	{
+		addPattern(a, n, x, x);
+	}
+
+	inline void add(std::complex<double>* a, std::size_t n, std::complex<double> x)
+	{
+		addPattern(reinterpret_cast<double*>(a), 2 * n, x.real(), x.imag());
+	}
+
+	inline void add(std::complex<float>* a, std::size_t n, std::complex<float> x)
+	{
+		addPattern(reinterpret_cast<float*>(a), 2 * n, x.real(), x.imag());
+	}
+
+	/**
+	 * a[i] = x * a[i], generic version.
+	 *
+	 * @param a samples, updated in place
+	 * @param n number of samples
+	 * @param x multiplier
+	 */
+	template<typename DataType, typename Numeric>
+	inline void multiply(DataType* a, std::size_t n, Numeric x)
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			a[i] = x * a[i];
+		}
+	}
+
+	inline void multiply(double* a, std::size_t n, double x)
+	{
+		multiplyPattern(a, n, x, x);
+	}
+
+	inline void multiply(float* a, std::size_t n, float x)
+	{
+		multiplyPattern(a, n, x, x);
+	}
+
+	inline void multiply(std::complex<double>* a, std::size_t n, double x)
+	{
+		multiplyPattern(reinterpret_cast<double*>(a), 2 * n, x, x);
+	}
+
+	inline void multiply(std::complex<float>* a, std::size_t n, float x)
+	{
+		multiplyPattern(reinterpret_cast<float*>(a), 2 * n, x, x);
+	}
+
+	inline void multiply(std::complex<double>* a, std::size_t n, std::complex<double> x)
+	{
+		complexScale(reinterpret_cast<double*>(a), n, x.real(), x.imag());
+	}
+
+	inline void multiply(std::complex<float>* a, std::size_t n, std::complex<float> x)
+	{
+		complexScale(reinterpret_cast<float*>(a), n, x.real(), x.imag());
+	}
+}
+}
+
+#endif // QUASAR_SIMD_SIMDKERNELS_H
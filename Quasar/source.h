@@ -32,10 +32,18 @@
 #define QUASAR_SOURCE_H
 
 #include "source/SignalSource.h"
+#include "source/SignalExpression.h"
+#include "source/SignalSpan.h"
+#include "source/SignalStats.h"
+#include "source/SignalView.h"
 #include "source/Frame.h"
+#include "source/FrameRange.h"
+#include "source/FrameMatrix.h"
 #include "source/FramesCollection.h"
+#include "source/StreamingFramer.h"
 #include "source/PlainTextFile.h"
 #include "source/RawPcmFile.h"
+#include "source/PagedPcmFile.h"
 #include "source/generator/Generator.h"
 #include "source/generator/SineGenerator.h"
 #include "source/generator/SquareGenerator.h"
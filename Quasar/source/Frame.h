@@ -70,8 +70,8 @@ public:
 	 * @param indexBegin position of first sample of this frame in the source
 	 * @param indexEnd position of last sample of this frame in the source
 	 */
-	Frame(const SignalSourceType& source, unsigned int indexBegin,
-			unsigned int indexEnd):
+	Frame(const SignalSourceType& source, std::size_t indexBegin,
+			std::size_t indexEnd):
 	SignalSourceType(source.getSampleFrequency()),
 	m_source(&source), m_begin(indexBegin),
 	m_end((indexEnd > source.getSamplesCount()) ? source.getSamplesCount() : indexEnd)
@@ -158,6 +158,16 @@ public:
 		return m_source->toArray() + static_cast<std::ptrdiff_t>(m_begin);
 	}
 
+	/**
+	 * A frame is contiguous whenever its original source is.
+	 *
+	 * @return true if the source can be accessed through span()
+	 */
+	virtual bool isContiguous() const
+	{
+		return m_source->isContiguous();
+	}
+
 private:
 	/**
 	 * A non-owning pointer to constant original source (eg. a WAVE file).
@@ -166,8 +176,11 @@ private:
 
 	/**
 	 * First and last sample of this frame in the data array/vector.
+	 *
+	 * Stored as std::size_t like all sample indices, so frames of sources
+	 * longer than 4G samples do not wrap around.
 	 */
-	unsigned int m_begin, m_end;
+	std::size_t m_begin, m_end;
 
 	/**
 	 * Swaps the frame with another one - exception safe.
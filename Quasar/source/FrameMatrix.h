@@ -0,0 +1,338 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file FrameMatrix.h
+ *
+ * Frames of a signal copied into one contiguous matrix.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_FRAMEMATRIX_H
+#define QUASAR_SOURCE_FRAMEMATRIX_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/SimdKernels.h"
+#include "FrameRange.h"
+#include "SignalSource.h"
+#include "SignalSpan.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace Quasar {
+
+/**
+ * A frames-by-samples matrix of (optionally windowed) frames.
+ *
+ * gather() reads every frame of a layout once, multiplies it by a window
+ * and stores it as one row of the matrix. Rows are stored one after
+ * another in a single aligned buffer; each row starts on a 64 byte
+ * boundary, so stride() may be larger than columns() and the padding
+ * is zero. The result is ready for batched transforms or for matrix
+ * products (mel filter banks, DCT) without touching the source again:
+ *
+ * @verbatim
+ * Quasar::HammingWindow<> window(512);
+ * Quasar::FrameMatrix<> frames;
+ * frames.gather(Quasar::FrameRange<>(signal, 512, 256), window);
+ * for (std::size_t r = 0; r < frames.rows(); ++r) {
+ *     process(frames.row(r));
+ * }                                                        @endverbatim
+ *
+ * Frames of a FramesCollection are gathered through its range().
+ * Gathering again into a matrix of the same or smaller size reuses its
+ * buffer.
+ */
+template<typename DataType = SampleType>
+class FrameMatrix
+{
+public:
+	/**
+	 * Creates an empty matrix.
+	 */
+	FrameMatrix():
+	m_rows(0), m_columns(0), m_stride(0), m_data()
+	{
+	}
+
+	/**
+	 * Creates a zero-filled matrix.
+	 *
+	 * @param rows number of frames
+	 * @param columns number of samples in each frame
+	 */
+	FrameMatrix(std::size_t rows, std::size_t columns):
+	m_rows(0), m_columns(0), m_stride(0), m_data()
+	{
+		resize(rows, columns);
+	}
+
+	/**
+	 * Copies windowed frames of a source into the matrix.
+	 *
+	 * The window is applied sample by sample, it must be as long as the
+	 * frames.
+	 *
+	 * @param frames frames layout, over a source of the matrix type
+	 * @param window window to multiply each frame by
+	 * @throw std::invalid_argument for a window of a different length
+	 */
+	template<template<typename ...> class Container_t,
+			template<typename ...> class WindowContainer_t>
+	void gather(const FrameRange<DataType, Container_t>& frames,
+			const SignalSource<DataType, WindowContainer_t>& window)
+	{
+		if (window.getSamplesCount() != frames.getSamplesPerFrame())
+		{
+			throw std::invalid_argument("Window length does not match frame length.");
+		}
+		if (window.isContiguous())
+		{
+			gatherFrames(frames, window.toArray());
+			return;
+		}
+		AlignedVector<DataType> samples(window.begin(), window.end());
+		gatherFrames(frames, samples.data());
+	}
+
+	/**
+	 * Copies windowed frames of a source into the matrix.
+	 *
+	 * @param source the divided source
+	 * @param samplesPerFrame how many samples each frame holds
+	 * @param hop distance between beginnings of adjacent frames
+	 * @param window window to multiply each frame by
+	 * @throw std::invalid_argument for a window of a different length
+	 */
+	template<template<typename ...> class Container_t,
+			template<typename ...> class WindowContainer_t>
+	void gather(const SignalSource<DataType, Container_t>& source,
+			std::size_t samplesPerFrame, std::size_t hop,
+			const SignalSource<DataType, WindowContainer_t>& window)
+	{
+		gather(FrameRange<DataType, Container_t>(source, samplesPerFrame, hop), window);
+	}
+
+	/**
+	 * Copies frames of a source into the matrix, without a window.
+	 *
+	 * @param frames frames layout, over a source of the matrix type
+	 */
+	template<template<typename ...> class Container_t>
+	void gather(const FrameRange<DataType, Container_t>& frames)
+	{
+		gatherFrames(frames, nullptr);
+	}
+
+	/**
+	 * Changes the dimensions, zeroing all elements.
+	 *
+	 * @param rows number of frames
+	 * @param columns number of samples in each frame
+	 */
+	void resize(std::size_t rows, std::size_t columns)
+	{
+		reshape(rows, columns);
+		std::fill(m_data.begin(), m_data.end(), DataType());
+	}
+
+	/**
+	 * Returns number of rows, one for each frame.
+	 *
+	 * @return rows count
+	 */
+	std::size_t rows() const
+	{
+		return m_rows;
+	}
+
+	/**
+	 * Returns number of columns, the frame length.
+	 *
+	 * @return columns count
+	 */
+	std::size_t columns() const
+	{
+		return m_columns;
+	}
+
+	/**
+	 * Returns distance between beginnings of adjacent rows.
+	 *
+	 * @return row stride in elements
+	 */
+	std::size_t stride() const
+	{
+		return m_stride;
+	}
+
+	/**
+	 * Returns pointer to the first element of the first row.
+	 *
+	 * @return pointer to the buffer
+	 */
+	DataType* data()
+	{
+		return m_data.data();
+	}
+
+	/**
+	 * Returns pointer to the first element of the first row.
+	 *
+	 * @return pointer to the buffer
+	 */
+	const DataType* data() const
+	{
+		return m_data.data();
+	}
+
+	/**
+	 * Returns a row of the matrix.
+	 *
+	 * @param index row index, less than rows()
+	 * @return span over the row, without padding
+	 */
+	SignalSpan<DataType> row(std::size_t index)
+	{
+		return SignalSpan<DataType>(m_data.data() + index * m_stride, m_columns);
+	}
+
+	/**
+	 * Returns a row of the matrix.
+	 *
+	 * @param index row index, less than rows()
+	 * @return span over the row, without padding
+	 */
+	SignalSpan<const DataType> row(std::size_t index) const
+	{
+		return SignalSpan<const DataType>(m_data.data() + index * m_stride, m_columns);
+	}
+
+	/**
+	 * Returns an element of the matrix.
+	 *
+	 * @param r row index
+	 * @param c column index
+	 * @return reference to the element
+	 */
+	DataType& operator()(std::size_t r, std::size_t c)
+	{
+		return m_data[r * m_stride + c];
+	}
+
+	/**
+	 * Returns an element of the matrix.
+	 *
+	 * @param r row index
+	 * @param c column index
+	 * @return the element
+	 */
+	const DataType& operator()(std::size_t r, std::size_t c) const
+	{
+		return m_data[r * m_stride + c];
+	}
+
+private:
+	/**
+	 * Changes the dimensions, leaving the elements unspecified.
+	 *
+	 * @param rows number of frames
+	 * @param columns number of samples in each frame
+	 */
+	void reshape(std::size_t rows, std::size_t columns)
+	{
+		const std::size_t perLine = 64 / sizeof(DataType);
+		m_rows = rows;
+		m_columns = columns;
+		m_stride = (perLine > 1) ? (columns + perLine - 1) / perLine * perLine : columns;
+		m_data.resize(m_rows * m_stride);
+	}
+
+	/**
+	 * Fills the rows, reading each frame once.
+	 *
+	 * Contiguous sources are copied straight from their memory, others
+	 * are read through a single virtual call per sample instead of two
+	 * through Frame.
+	 *
+	 * @param frames frames layout
+	 * @param window window samples or null
+	 */
+	template<template<typename ...> class Container_t>
+	void gatherFrames(const FrameRange<DataType, Container_t>& frames, const DataType* window)
+	{
+		const std::size_t n = frames.getSamplesPerFrame();
+		reshape(frames.count(), n);
+		if (m_rows == 0)
+		{
+			return;
+		}
+		const SignalSource<DataType, Container_t>& source = *frames.source();
+		const DataType* samples = source.isContiguous() ? source.toArray() : nullptr;
+		for (std::size_t r = 0; r < m_rows; ++r)
+		{
+			DataType* out = m_data.data() + r * m_stride;
+			const std::size_t begin = frames.frameBegin(r);
+			if (samples)
+			{
+				std::copy(samples + begin, samples + begin + n, out);
+			}
+			else
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					out[i] = source.sample(begin + i);
+				}
+			}
+			if (window)
+			{
+				Simd::multiply(out, window, n);
+			}
+			std::fill(out + n, out + m_stride, DataType());
+		}
+	}
+
+	/**
+	 * Number of rows.
+	 */
+	std::size_t m_rows;
+
+	/**
+	 * Number of used columns.
+	 */
+	std::size_t m_columns;
+
+	/**
+	 * Row length in the buffer, including padding.
+	 */
+	std::size_t m_stride;
+
+	/**
+	 * Row-major elements.
+	 */
+	AlignedVector<DataType> m_data;
+};
+
+}
+
+#endif // QUASAR_SOURCE_FRAMEMATRIX_H
@@ -0,0 +1,448 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file FrameRange.h
+ *
+ * A lazily computed, evenly strided sequence of frames.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_FRAMERANGE_H
+#define QUASAR_SOURCE_FRAMERANGE_H
+
+#include "../global.h"
+#include "Frame.h"
+#include "SignalSource.h"
+#include "SignalSpan.h"
+#include <cstddef>
+#include <iterator>
+
+namespace Quasar {
+
+/**
+ * Frames of a source, cut every "hop" samples, computed on demand.
+ *
+ * A frame range stores only the source pointer, the frame length and
+ * the hop, whatever the number of frames. Frame number i covers samples
+ * [i * hop, i * hop + samplesPerFrame) of the source; the last frame is
+ * the last one fitting entirely in the source.
+ *
+ * Frames are created by value when accessed, with operator[] or through
+ * the random access iterators, so ranges work with standard (also
+ * parallel) algorithms and can be split between threads by index.
+ * Contiguous sources can also be read frame by frame through span(),
+ * without creating Frame objects at all.
+ *
+ * @verbatim
+ * Quasar::FrameRange<> frames(signal, 1024, 512);
+ * for (std::size_t i = 0; i < frames.count(); ++i) {
+ *     process(frames.span(i));
+ * }                                                    @endverbatim
+ */
+SignalSourceTemplate
+class FrameRange
+{
+public:
+	/**
+	 * Type of the frames.
+	 */
+	typedef SignalSourceTemplatedType(Frame) FrameType;
+
+	/**
+	 * Creates an empty range.
+	 */
+	FrameRange():
+	m_source(nullptr), m_samplesPerFrame(0), m_hop(0), m_count(0)
+	{
+	}
+
+	/**
+	 * Creates frames of a source.
+	 *
+	 * A zero frame length or hop gives an empty range.
+	 *
+	 * @param source source to divide, must outlive the range
+	 * @param samplesPerFrame how many samples each frame holds
+	 * @param hop distance between beginnings of adjacent frames
+	 */
+	FrameRange(const SignalSourceType& source, std::size_t samplesPerFrame,
+			std::size_t hop):
+	m_source(&source), m_samplesPerFrame(samplesPerFrame), m_hop(hop),
+	m_count(framesCount(source.getSamplesCount(), samplesPerFrame, hop))
+	{
+	}
+
+	/**
+	 * Returns number of frames fitting in a signal.
+	 *
+	 * @param sourceSize number of samples in the signal
+	 * @param samplesPerFrame frame length
+	 * @param hop distance between beginnings of adjacent frames
+	 * @return frames count
+	 */
+	static std::size_t framesCount(std::size_t sourceSize,
+			std::size_t samplesPerFrame, std::size_t hop)
+	{
+		if (samplesPerFrame == 0 || hop == 0 || sourceSize < samplesPerFrame)
+		{
+			return 0;
+		}
+		return (sourceSize - samplesPerFrame) / hop + 1;
+	}
+
+	/**
+	 * Returns number of frames in the range.
+	 *
+	 * @return frames count
+	 */
+	std::size_t count() const
+	{
+		return m_count;
+	}
+
+	/**
+	 * Returns number of frames in the range.
+	 *
+	 * @return frames count
+	 */
+	std::size_t size() const
+	{
+		return m_count;
+	}
+
+	/**
+	 * Checks whether the range has no frames.
+	 *
+	 * @return true for empty ranges
+	 */
+	bool empty() const
+	{
+		return m_count == 0;
+	}
+
+	/**
+	 * Returns number of samples in each frame.
+	 *
+	 * @return frame size in samples
+	 */
+	std::size_t getSamplesPerFrame() const
+	{
+		return m_samplesPerFrame;
+	}
+
+	/**
+	 * Returns distance between beginnings of adjacent frames.
+	 *
+	 * @return hop size in samples
+	 */
+	std::size_t getHop() const
+	{
+		return m_hop;
+	}
+
+	/**
+	 * Returns the divided source.
+	 *
+	 * @return pointer to the source, null for a default constructed range
+	 */
+	const SignalSourceType* source() const
+	{
+		return m_source;
+	}
+
+	/**
+	 * Returns position of the first sample of a frame in the source.
+	 *
+	 * @param index index of the frame
+	 * @return sample index in the source
+	 */
+	std::size_t frameBegin(std::size_t index) const
+	{
+		return index * m_hop;
+	}
+
+	/**
+	 * Returns nth frame of the range.
+	 *
+	 * @param index index of the frame, less than count()
+	 * @return Frame instance
+	 */
+	FrameType frame(std::size_t index) const
+	{
+		const std::size_t begin = frameBegin(index);
+		return FrameType(*m_source, begin, begin + m_samplesPerFrame);
+	}
+
+	/**
+	 * Returns nth frame of the range.
+	 *
+	 * @param index index of the frame, less than count()
+	 * @return Frame instance
+	 */
+	FrameType operator[](std::size_t index) const
+	{
+		return frame(index);
+	}
+
+	/**
+	 * Returns samples of nth frame.
+	 *
+	 * Only for contiguous sources, see SignalSource::isContiguous().
+	 *
+	 * @param index index of the frame, less than count()
+	 * @return span over the frame samples
+	 */
+	SignalSpan<const DataType> span(std::size_t index) const
+	{
+		return m_source->span().subspan(frameBegin(index), m_samplesPerFrame);
+	}
+
+	/**
+	 * Holds a frame created by an iterator, so its members can be
+	 * reached with it->member.
+	 *
+	 * Every it-> creates its own frame, so sample iterators taken from
+	 * it->begin() and it->end() belong to different frames and never
+	 * compare equal; copy the frame (auto frame = *it) to use both.
+	 */
+	class FramePointer
+	{
+	public:
+		explicit FramePointer(const FrameType& frame):
+		m_frame(frame)
+		{
+		}
+
+		const FrameType* operator->() const
+		{
+			return &m_frame;
+		}
+
+	private:
+		/**
+		 * The frame, alive as long as the expression using it.
+		 */
+		FrameType m_frame;
+	};
+
+	/**
+	 * Random access iterator over frames of the range.
+	 *
+	 * Dereferencing creates the frame, so frames are returned by value;
+	 * iterate with for (auto frame : frames), not with a reference.
+	 */
+	class iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef FrameType value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef FramePointer pointer;
+		typedef FrameType reference;
+
+		/**
+		 * Creates an iterator over a given range.
+		 *
+		 * @param range range to iterate
+		 * @param index index of the frame
+		 */
+		explicit iterator(const FrameRange* range = nullptr, std::size_t index = 0):
+		m_range(range), m_index(index)
+		{
+		}
+
+		FrameType operator*() const
+		{
+			return m_range->frame(m_index);
+		}
+
+		FramePointer operator->() const
+		{
+			return FramePointer(m_range->frame(m_index));
+		}
+
+		FrameType operator[](difference_type n) const
+		{
+			return m_range->frame(m_index + n);
+		}
+
+		iterator& operator++()
+		{
+			++m_index;
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator tmp(*this);
+			++m_index;
+			return tmp;
+		}
+
+		iterator& operator--()
+		{
+			--m_index;
+			return *this;
+		}
+
+		iterator operator--(int)
+		{
+			iterator tmp(*this);
+			--m_index;
+			return tmp;
+		}
+
+		iterator& operator+=(difference_type n)
+		{
+			m_index = static_cast<std::size_t>(static_cast<difference_type>(m_index) + n);
+			return *this;
+		}
+
+		iterator& operator-=(difference_type n)
+		{
+			return *this += -n;
+		}
+
+		iterator operator+(difference_type n) const
+		{
+			iterator tmp(*this);
+			return tmp += n;
+		}
+
+		friend iterator operator+(difference_type n, const iterator& it)
+		{
+			return it + n;
+		}
+
+		iterator operator-(difference_type n) const
+		{
+			iterator tmp(*this);
+			return tmp -= n;
+		}
+
+		difference_type operator-(const iterator& other) const
+		{
+			return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+		}
+
+		bool operator==(const iterator& other) const
+		{
+			return m_range == other.m_range && m_index == other.m_index;
+		}
+
+		bool operator!=(const iterator& other) const
+		{
+			return !(*this == other);
+		}
+
+		bool operator<(const iterator& other) const
+		{
+			return m_index < other.m_index;
+		}
+
+		bool operator>(const iterator& other) const
+		{
+			return other < *this;
+		}
+
+		bool operator<=(const iterator& other) const
+		{
+			return !(other < *this);
+		}
+
+		bool operator>=(const iterator& other) const
+		{
+			return !(*this < other);
+		}
+
+		/**
+		 * Returns index of the frame the iterator points to.
+		 *
+		 * @return frame index
+		 */
+		std::size_t getPosition() const
+		{
+			return m_index;
+		}
+
+	private:
+		/**
+		 * The iterated range.
+		 */
+		const FrameRange* m_range;
+
+		/**
+		 * Index of the current frame.
+		 */
+		std::size_t m_index;
+	};
+
+	/**
+	 * Frames can not be modified through the iterators.
+	 */
+	typedef iterator const_iterator;
+
+	/**
+	 * Returns an iterator pointing to the first frame.
+	 *
+	 * @return iterator
+	 */
+	iterator begin() const
+	{
+		return iterator(this, 0);
+	}
+
+	/**
+	 * Returns an iterator pointing one-past-last frame.
+	 *
+	 * @return iterator
+	 */
+	iterator end() const
+	{
+		return iterator(this, m_count);
+	}
+
+private:
+	/**
+	 * A non-owning pointer to the divided source.
+	 */
+	const SignalSourceType* m_source;
+
+	/**
+	 * Number of samples in each frame.
+	 */
+	std::size_t m_samplesPerFrame;
+
+	/**
+	 * Distance between beginnings of adjacent frames.
+	 */
+	std::size_t m_hop;
+
+	/**
+	 * Number of frames.
+	 */
+	std::size_t m_count;
+};
+
+}
+
+#endif // QUASAR_SOURCE_FRAMERANGE_H
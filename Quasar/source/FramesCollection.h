@@ -30,21 +30,26 @@
 #define QUASAR_SOURCE_FRAMESCOLLECTION_H
 
 #include "../global.h"
+#include "../parallel/ThreadPool.h"
 #include "Frame.h"
+#include "FrameRange.h"
 #include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "SignalSource.h"
 
 namespace Quasar {
 
 /**
- * A lightweight wrapper for a vector of Frames.
+ * A lightweight wrapper for a range of Frames.
  *
- * This class is neccessary to perform signal division into frames,
- * which are then stored in container (currently std::vector). The frame
- * objects are stored by value as they are very light and cheap to copy.
+ * This class is neccessary to perform signal division into frames.
+ * The frames are not stored: the collection keeps a FrameRange, which
+ * computes frame boundaries on demand, so its size does not depend on
+ * the length of the signal and dividing a signal allocates nothing.
  *
  * The reason this wrapper was created is to create some abstraction for
  * groups of frames, which can by saved or processed together. For example,
@@ -54,8 +59,14 @@ namespace Quasar {
  * and then processed.
  *
  * Individual frame objects can by accessed by iterating over the collection
- * using begin() and end() methods. These calls simply return iterators
- * pointing to the underlying container.
+ * using begin() and end() methods. These calls return random access
+ * iterators creating the frames by value, so a loop takes each frame by
+ * value as well:
+ *
+ * @verbatim
+ * for (auto frame : frames) {
+ *     process(frame);
+ * }                                                    @endverbatim
  */
 
 SignalSourceTemplate
@@ -64,13 +75,12 @@ class FramesCollection
 	/**
 	 * Internal storage type.
 	 */
-	typedef std::vector<SignalSourceTemplatedType(Frame)> Container;
+	typedef SignalSourceTemplatedType(FrameRange) Container;
 
 public:
 	/**
 	 * An iterator for the collection.
 	 */
-
 	typedef typename Container::iterator iterator;
 
 	/**
@@ -78,11 +88,16 @@ public:
 	 */
 	typedef typename Container::const_iterator const_iterator;
 
+	/**
+	 * Type of the frames.
+	 */
+	typedef typename Container::FrameType FrameType;
+
 	/**
 	 * Creates an empty frames collection.
 	 */
 	FramesCollection():
-	m_frames(), m_samplesPerFrame(0)
+	m_frames()
 	{
 	}
 
@@ -96,19 +111,11 @@ public:
 	FramesCollection(const SignalSourceType& source,
 			std::size_t samplesPerFrame,
 			std::size_t samplesPerOverlap = 0):
-	m_frames(), m_samplesPerFrame(0)
+	m_frames()
 	{
 		divideFrames(source, samplesPerFrame, samplesPerOverlap);
 	}
 
-	/**
-	 * Destroys the collection, clearing the container.
-	 */
-	~FramesCollection()
-	{
-		clear();
-	}
-
 	/**
 	 * Creates a collection when duration of each frame is known.
 	 *
@@ -134,7 +141,8 @@ public:
 	 *
 	 * Frames are only "pointing" to the original source. There is no copying
 	 * of sample data. Each frame can be considered as a standalone fragment
-	 * of the source data.
+	 * of the source data. An overlap not smaller than the frame gives an
+	 * empty collection.
 	 *
 	 * @param source a reference to source object
 	 * @param samplesPerFrame how many samples will each frame hold
@@ -148,36 +156,17 @@ public:
 		{
 			return;
 		}
-		m_samplesPerFrame = samplesPerFrame;
-		const std::size_t sourceSize = source.getSamplesCount();
-		const std::size_t nonOverlapped = samplesPerFrame - samplesPerOverlap;
-		const std::size_t framesCount = sourceSize / nonOverlapped;
-
-		m_frames.reserve(framesCount);
-		std::size_t indexBegin = 0, indexEnd = 0;
-		for (std::size_t i = 0; i < framesCount; ++i)
-		{
-			// calculate each frame boundaries
-			// when frame end exceeds source size, break out
-			indexBegin = i * nonOverlapped;
-			indexEnd = indexBegin + samplesPerFrame;
-			if (indexEnd <= sourceSize)
-			{
-				m_frames.push_back(SignalSourceTemplatedType(Frame)(source, indexBegin, indexEnd));
-			}
-			else
-			{
-				break;
-			}
-		}
+		const std::size_t hop = (samplesPerOverlap < samplesPerFrame) ?
+				samplesPerFrame - samplesPerOverlap : 0;
+		m_frames = Container(source, samplesPerFrame, hop);
 	}
 
 	/**
-	 * Deletes all contained frames and clears the collection.
+	 * Clears the collection.
 	 */
 	void clear()
 	{
-		m_frames.clear();
+		m_frames = Container();
 	}
 
 	/**
@@ -187,7 +176,7 @@ public:
 	 */
 	std::size_t count() const
 	{
-		return m_frames.size();
+		return m_frames.count();
 	}
 
 	/**
@@ -197,7 +186,17 @@ public:
 	 */
 	std::size_t getSamplesPerFrame() const
 	{
-		return m_samplesPerFrame;
+		return m_frames.getSamplesPerFrame();
+	}
+
+	/**
+	 * Returns the underlying frame range.
+	 *
+	 * @return range of frames
+	 */
+	const Container& range() const
+	{
+		return m_frames;
 	}
 
 	/**
@@ -208,7 +207,7 @@ public:
 	 */
 	SignalSourceTemplatedType(Frame) frame(std::size_t index) const
 	{
-		return m_frames[index];
+		return m_frames.frame(index);
 	}
 
 	/**
@@ -254,6 +253,9 @@ public:
 	/**
 	 * Applies the calculation f to all frames in the collection.
 	 *
+	 * Kept for compatibility, the callable overloads below avoid the
+	 * type-erased call per frame.
+	 *
 	 * @param f a function whose single argument is a SignalSource
 	 * @return vector of return values of f - one for each frame
 	 */
@@ -261,21 +263,109 @@ public:
 	std::vector<ResultType> apply(
 			std::function<ResultType (const SignalSourceType&)> f) const
 	{
-		std::vector<ResultType> results;
-		std::transform(begin(), end(), std::back_inserter(results), f);
+		std::vector<ResultType> results(count());
+		applyTo(f, results);
+		return results;
+	}
+
+	/**
+	 * Applies the calculation f to all frames in the collection.
+	 *
+	 * The callable is called directly, so it can be inlined. Results
+	 * must be default constructible, as the vector is sized up front.
+	 *
+	 * @param f a callable taking const FrameType& (or const SignalSource&)
+	 * @return vector of return values of f - one for each frame
+	 */
+	template <typename Function>
+	auto apply(Function f) const
+		-> std::vector<typename std::decay<decltype(f(std::declval<const FrameType&>()))>::type>
+	{
+		typedef typename std::decay<decltype(f(std::declval<const FrameType&>()))>::type ResultType;
+		std::vector<ResultType> results(count());
+		applyTo(f, results);
+		return results;
+	}
+
+	/**
+	 * Applies the calculation f to all frames, storing the results in
+	 * a preallocated array.
+	 *
+	 * @param f a callable taking const FrameType& (or const SignalSource&)
+	 * @param results array of at least count() elements, results[i]
+	 *        receives the value computed for frame i
+	 */
+	template <typename Function, typename ResultType>
+	void apply(Function f, ResultType* results) const
+	{
+		applyTo(f, results);
+	}
+
+	/**
+	 * Applies the calculation f to all frames, spreading the frames
+	 * across the threads of a pool.
+	 *
+	 * The result for frame i is always at index i, whatever thread
+	 * computed it. f is called concurrently and must be safe to call
+	 * from several threads, the source must allow concurrent reads.
+	 * Results are written to separate elements of a vector, so bool
+	 * results (packed by std::vector<bool>) are not supported.
+	 *
+	 * @param f a callable taking const FrameType& (or const SignalSource&)
+	 * @param pool threads to use
+	 * @return vector of return values of f - one for each frame
+	 */
+	template <typename Function>
+	auto applyParallel(Function f, ThreadPool& pool = ThreadPool::shared()) const
+		-> std::vector<typename std::decay<decltype(f(std::declval<const FrameType&>()))>::type>
+	{
+		typedef typename std::decay<decltype(f(std::declval<const FrameType&>()))>::type ResultType;
+		std::vector<ResultType> results(count());
+		applyParallel(f, results.data(), pool);
 		return results;
 	}
 
+	/**
+	 * Applies the calculation f to all frames on the threads of a pool,
+	 * storing the results in a preallocated array.
+	 *
+	 * @param f a callable taking const FrameType& (or const SignalSource&)
+	 * @param results array of at least count() elements, results[i]
+	 *        receives the value computed for frame i
+	 * @param pool threads to use
+	 */
+	template <typename Function, typename ResultType>
+	void applyParallel(Function f, ResultType* results,
+			ThreadPool& pool = ThreadPool::shared()) const
+	{
+		const Container& frames = m_frames;
+		pool.parallelFor(count(), [&f, results, &frames] (std::size_t i)
+		{
+			results[i] = f(frames.frame(i));
+		});
+	}
+
 private:
 	/**
-	 * Frames container.
+	 * Stores f(frame i) at results[i] for every frame.
+	 *
+	 * @param f a callable taking const FrameType&
+	 * @param results array or vector of at least count() elements
 	 */
-	Container m_frames;
+	template <typename Function, typename Output>
+	void applyTo(Function& f, Output& results) const
+	{
+		const std::size_t n = count();
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			results[i] = f(m_frames.frame(i));
+		}
+	}
 
 	/**
-	 * Number of samples in each frame.
+	 * Frames range.
 	 */
-	std::size_t m_samplesPerFrame;
+	Container m_frames;
 };}
 
 #endif // QUASAR_SOURCE_FRAMESCOLLECTION_H
@@ -0,0 +1,310 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file PagedPcmFile.h
+ *
+ * Raw PCM file read on demand, one page at a time.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_PAGEDPCMFILE_H
+#define QUASAR_SOURCE_PAGEDPCMFILE_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "SignalSource.h"
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Quasar
+{
+	/**
+	 * A raw PCM file (as written by RawPcmFile::save) which is not
+	 * loaded into memory.
+	 *
+	 * The file is read in pages of a fixed number of samples, on first
+	 * access to each page. The most recently used pages are kept in a
+	 * small cache, the least recently used one is replaced when a new page
+	 * is needed. Memory use is pageSamples * maxPages samples whatever
+	 * the file size, so captures of many gigabytes can be divided with
+	 * FramesCollection or FrameRange like any other source:
+	 *
+	 * @verbatim
+	 * Quasar::PagedPcmFile<float> capture("capture.raw", 100e6);
+	 * Quasar::FramesCollection<float> frames(capture, 4096, 2048);
+	 * for (auto frame : frames) { ... }                        @endverbatim
+	 *
+	 * The source is not contiguous, toArray() returns null. Sequential
+	 * access, as done by frames, mostly hits the last used page. Use
+	 * read() to copy whole blocks with one cache lookup per page. All
+	 * reads are serialized by a mutex, so the source may be shared by
+	 * threads, e.g. with FramesCollection::applyParallel().
+	 */
+	SignalSourceClass(PagedPcmFile)
+	{
+	public:
+		/**
+		 * Opens the file.
+		 *
+		 * @param filename full path to data file
+		 * @param sampleFrequency sample frequency of the data in file
+		 * @param pageSamples number of samples read at once
+		 * @param maxPages number of pages kept in memory
+		 * @throw std::runtime_error if the file can not be opened
+		 */
+		PagedPcmFile(const std::string& filename, FrequencyType sampleFrequency,
+				std::size_t pageSamples = 65536, std::size_t maxPages = 16):
+			SignalSourceType::SignalSource(sampleFrequency),
+			m_file(filename.c_str(), std::ios::in | std::ios::binary),
+			m_samplesCount(0),
+			m_pageSamples(std::max<std::size_t>(pageSamples, 1)),
+			m_pages(std::max<std::size_t>(maxPages, 1)),
+			m_lastPage(0),
+			m_clock(0)
+		{
+			if (!m_file)
+			{
+				throw std::runtime_error("Can not open " + filename);
+			}
+			m_file.seekg(0, std::ios::end);
+			const std::streamoff fileSize = m_file.tellg();
+			m_samplesCount = static_cast<std::size_t>(fileSize / sizeof(DataType));
+		}
+
+		/**
+		 * Returns number of samples in the file.
+		 *
+		 * @return samples count
+		 */
+		virtual std::size_t getSamplesCount() const
+		{
+			return m_samplesCount;
+		}
+
+		/**
+		 * Returns sample located at the "position" in the file.
+		 *
+		 * @param position sample index in the file
+		 * @return sample value
+		 */
+		virtual DataType sample(std::size_t position) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			const Page& page = load(position / m_pageSamples);
+			return page.samples[position % m_pageSamples];
+		}
+
+		/**
+		 * Copies a block of samples.
+		 *
+		 * @param position index of the first sample to copy
+		 * @param count number of samples
+		 * @param output destination of count samples
+		 * @return number of samples copied, less than count at end of file
+		 */
+		std::size_t read(std::size_t position, std::size_t count, DataType* output) const
+		{
+			if (position >= m_samplesCount)
+			{
+				return 0;
+			}
+			count = std::min(count, m_samplesCount - position);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::size_t copied = 0;
+			while (copied < count)
+			{
+				const Page& page = load(position / m_pageSamples);
+				const std::size_t offset = position % m_pageSamples;
+				const std::size_t n = std::min(count - copied, m_pageSamples - offset);
+				std::copy(page.samples.data() + offset, page.samples.data() + offset + n,
+						output + copied);
+				copied += n;
+				position += n;
+			}
+			return copied;
+		}
+
+		/**
+		 * The file is not held in memory.
+		 *
+		 * @return null
+		 */
+		virtual DataType* toArray()
+		{
+			return nullptr;
+		}
+
+		/**
+		 * The file is not held in memory.
+		 *
+		 * @return null
+		 */
+		virtual const DataType* toArray() const
+		{
+			return nullptr;
+		}
+
+		/**
+		 * Samples are only accessible through sample() and read().
+		 *
+		 * @return false
+		 */
+		virtual bool isContiguous() const
+		{
+			return false;
+		}
+
+		/**
+		 * Returns number of samples in each page.
+		 *
+		 * @return page size in samples
+		 */
+		std::size_t getPageSamples() const
+		{
+			return m_pageSamples;
+		}
+
+	private:
+		/**
+		 * A cached part of the file.
+		 */
+		struct Page
+		{
+			Page():
+				index(static_cast<std::size_t>(-1)), lastUse(0), samples()
+			{
+			}
+
+			/**
+			 * Page number in the file, -1 for an unused slot.
+			 */
+			std::size_t index;
+
+			/**
+			 * Value of the use clock at the last access.
+			 */
+			std::size_t lastUse;
+
+			/**
+			 * Page samples.
+			 */
+			AlignedVector<DataType> samples;
+		};
+
+		/**
+		 * Returns a page, reading it in place of the least recently used
+		 * one if it is not cached. Called with the mutex locked.
+		 *
+		 * @param index page number
+		 * @return the cached page
+		 */
+		const Page& load(std::size_t index) const
+		{
+			Page* page = &m_pages[m_lastPage];
+			if (page->index != index)
+			{
+				std::size_t slot = 0;
+				for (std::size_t i = 0; i < m_pages.size(); ++i)
+				{
+					if (m_pages[i].index == index)
+					{
+						slot = i;
+						break;
+					}
+					if (m_pages[i].lastUse < m_pages[slot].lastUse)
+					{
+						slot = i;
+					}
+				}
+				page = &m_pages[slot];
+				m_lastPage = slot;
+				if (page->index != index)
+				{
+					fill(*page, index);
+				}
+			}
+			page->lastUse = ++m_clock;
+			return *page;
+		}
+
+		/**
+		 * Reads a page from the file.
+		 *
+		 * @param page slot to fill, its buffer is reused
+		 * @param index page number
+		 */
+		void fill(Page& page, std::size_t index) const
+		{
+			const std::size_t first = index * m_pageSamples;
+			const std::size_t count = std::min(m_pageSamples, m_samplesCount - first);
+			page.samples.resize(m_pageSamples);
+			m_file.clear();
+			m_file.seekg(static_cast<std::streamoff>(first) * static_cast<std::streamoff>(sizeof(DataType)));
+			m_file.read(reinterpret_cast<char*>(page.samples.data()),
+					static_cast<std::streamsize>(count * sizeof(DataType)));
+			page.index = index;
+		}
+
+		/**
+		 * The open file.
+		 */
+		mutable std::ifstream m_file;
+
+		/**
+		 * Number of whole samples in the file.
+		 */
+		std::size_t m_samplesCount;
+
+		/**
+		 * Number of samples in each page.
+		 */
+		std::size_t m_pageSamples;
+
+		/**
+		 * Page cache.
+		 */
+		mutable std::vector<Page> m_pages;
+
+		/**
+		 * Slot of the most recently used page.
+		 */
+		mutable std::size_t m_lastPage;
+
+		/**
+		 * Counter ordering page accesses.
+		 */
+		mutable std::size_t m_clock;
+
+		/**
+		 * Serializes access to the file and the cache.
+		 */
+		mutable std::mutex m_mutex;
+	};
+}
+
+#endif // QUASAR_SOURCE_PAGEDPCMFILE_H
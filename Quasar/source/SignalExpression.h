@@ -0,0 +1,349 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SignalExpression.h
+ *
+ * Lazily evaluated element-wise arithmetic on signal sources.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_SIGNALEXPRESSION_H
+#define QUASAR_SOURCE_SIGNALEXPRESSION_H
+
+#include "../global.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace Quasar {
+
+template<typename DataType, template<typename ...> class Container_t>
+class SignalSource;
+
+/**
+ * Base class of all signal expressions.
+ *
+ * An expression starts with lazy(), which wraps a signal source. Adding
+ * or multiplying an expression does not compute anything. Instead the
+ * operators return an expression object describing the computation, and
+ * the whole expression is evaluated in a single loop when it is assigned
+ * to a SignalSource (or used to construct one). For example
+ *
+ * @verbatim
+ * SignalSource<> modulated = lazy(carrier) * input + noise;    @endverbatim
+ *
+ * allocates the result once and reads every input sample exactly once.
+ * Assigning an expression into an existing source of the same length
+ * does not allocate at all.
+ *
+ * Expressions keep pointers to their operands, so they must not outlive
+ * the signal sources they were built from. Operators on plain sources
+ * (carrier * input) return a SignalSource, which is safe to hold in an
+ * auto variable.
+ *
+ * Every expression type provides:
+ *  - value_type and result_type typedefs,
+ *  - getSamplesCount() and getSampleFrequency(),
+ *  - isContiguous() - true when all operands are contiguous,
+ *  - value(i) - sample i read directly from memory, valid only when
+ *    isContiguous() is true,
+ *  - sample(i) - sample i read through SignalSource::sample().
+ */
+template<typename Derived>
+class SignalExpression
+{
+public:
+	/**
+	 * Returns the actual expression object.
+	 *
+	 * @return reference to the derived expression
+	 */
+	const Derived& derived() const
+	{
+		return static_cast<const Derived&>(*this);
+	}
+};
+
+/**
+ * Checks whether a type is a signal expression.
+ */
+template<typename T>
+struct IsSignalExpression : std::is_base_of<SignalExpression<T>, T>
+{
+};
+
+/**
+ * Element-wise addition used by expressions.
+ */
+struct SignalAddition
+{
+	template<typename T, typename U>
+	static auto apply(const T& x, const U& y) -> decltype(x + y)
+	{
+		return x + y;
+	}
+};
+
+/**
+ * Element-wise multiplication used by expressions.
+ */
+struct SignalMultiplication
+{
+	template<typename T, typename U>
+	static auto apply(const T& x, const U& y) -> decltype(x * y)
+	{
+		return x * y;
+	}
+};
+
+/**
+ * An expression wrapping a single signal source.
+ */
+template<typename DataType, template<typename ...> class Container_t>
+class SignalLeafExpression :
+	public SignalExpression<SignalLeafExpression<DataType, Container_t> >
+{
+public:
+	typedef DataType value_type;
+	typedef SignalSource<DataType, Container_t> result_type;
+
+	/**
+	 * Wraps the source. Contiguous sources are read through their
+	 * sample memory.
+	 *
+	 * @param source signal source, must outlive the expression
+	 */
+	explicit SignalLeafExpression(const SignalSource<DataType, Container_t>& source):
+	m_source(&source), m_contiguous(source.isContiguous()),
+	m_data(m_contiguous ? source.toArray() : nullptr)
+	{
+	}
+
+	std::size_t getSamplesCount() const
+	{
+		return m_source->getSamplesCount();
+	}
+
+	FrequencyType getSampleFrequency() const
+	{
+		return m_source->getSampleFrequency();
+	}
+
+	bool isContiguous() const
+	{
+		return m_contiguous;
+	}
+
+	DataType value(std::size_t i) const
+	{
+		return m_data[i];
+	}
+
+	DataType sample(std::size_t i) const
+	{
+		return m_source->sample(i);
+	}
+
+private:
+	/**
+	 * The wrapped source.
+	 */
+	const SignalSource<DataType, Container_t>* m_source;
+
+	/**
+	 * Cached result of isContiguous().
+	 */
+	bool m_contiguous;
+
+	/**
+	 * Sample memory of a contiguous source.
+	 */
+	const DataType* m_data;
+};
+
+/**
+ * Starts an expression from a signal source.
+ *
+ * @param source signal source, must outlive the expression
+ * @return leaf expression reading the source
+ */
+template<typename DataType, template<typename ...> class Container_t>
+SignalLeafExpression<DataType, Container_t> lazy(const SignalSource<DataType, Container_t>& source)
+{
+	return SignalLeafExpression<DataType, Container_t>(source);
+}
+
+/**
+ * Temporaries would be destroyed before the expression is evaluated.
+ */
+template<typename DataType, template<typename ...> class Container_t>
+void lazy(const SignalSource<DataType, Container_t>&& source) = delete;
+
+/**
+ * An element-wise operation on two expressions.
+ *
+ * The result has the length of the left-hand side operand, which must
+ * not be longer than the right-hand side one.
+ */
+template<typename Lhs, typename Rhs, typename Operation>
+class SignalBinaryExpression :
+	public SignalExpression<SignalBinaryExpression<Lhs, Rhs, Operation> >
+{
+public:
+	typedef typename Lhs::value_type value_type;
+	typedef typename Lhs::result_type result_type;
+
+	SignalBinaryExpression(const Lhs& lhs, const Rhs& rhs):
+	m_lhs(lhs), m_rhs(rhs)
+	{
+	}
+
+	std::size_t getSamplesCount() const
+	{
+		return m_lhs.getSamplesCount();
+	}
+
+	FrequencyType getSampleFrequency() const
+	{
+		return m_lhs.getSampleFrequency();
+	}
+
+	bool isContiguous() const
+	{
+		return m_lhs.isContiguous() && m_rhs.isContiguous();
+	}
+
+	value_type value(std::size_t i) const
+	{
+		return Operation::apply(m_lhs.value(i), m_rhs.value(i));
+	}
+
+	value_type sample(std::size_t i) const
+	{
+		return Operation::apply(m_lhs.sample(i), m_rhs.sample(i));
+	}
+
+private:
+	/**
+	 * Operands are held by value - leaves are only pointers and nested
+	 * expressions are usually temporaries.
+	 */
+	Lhs m_lhs;
+	Rhs m_rhs;
+};
+
+/**
+ * An element-wise operation of a scalar and an expression.
+ *
+ * The scalar is always the first argument of the operation, as it is
+ * in SignalSource compound operators.
+ */
+template<typename Expr, typename Operation>
+class SignalScalarExpression :
+	public SignalExpression<SignalScalarExpression<Expr, Operation> >
+{
+public:
+	typedef typename Expr::value_type value_type;
+	typedef typename Expr::result_type result_type;
+
+	SignalScalarExpression(const Expr& expression, const value_type& scalar):
+	m_expression(expression), m_scalar(scalar)
+	{
+	}
+
+	std::size_t getSamplesCount() const
+	{
+		return m_expression.getSamplesCount();
+	}
+
+	FrequencyType getSampleFrequency() const
+	{
+		return m_expression.getSampleFrequency();
+	}
+
+	bool isContiguous() const
+	{
+		return m_expression.isContiguous();
+	}
+
+	value_type value(std::size_t i) const
+	{
+		return Operation::apply(m_scalar, m_expression.value(i));
+	}
+
+	value_type sample(std::size_t i) const
+	{
+		return Operation::apply(m_scalar, m_expression.sample(i));
+	}
+
+private:
+	Expr m_expression;
+	value_type m_scalar;
+};
+
+/**
+ * Evaluates an expression into a C-style array.
+ *
+ * The contiguity check is done once, so the loop over contiguous
+ * operands contains no virtual calls. Writing into memory that is also
+ * an operand is safe, as each output sample depends only on input
+ * samples at the same index.
+ *
+ * @param expression expression to evaluate
+ * @param output destination, at least length samples long
+ * @param length number of samples to compute, at most getSamplesCount()
+ */
+template<typename Expr, typename DataType>
+void evaluateExpression(const SignalExpression<Expr>& expression, DataType* output,
+		std::size_t length)
+{
+	const Expr& expr = expression.derived();
+	if (expr.isContiguous())
+	{
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			output[i] = expr.value(i);
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			output[i] = expr.sample(i);
+		}
+	}
+}
+
+/**
+ * Evaluates a whole expression into a C-style array.
+ *
+ * @param expression expression to evaluate
+ * @param output destination, at least getSamplesCount() long
+ */
+template<typename Expr, typename DataType>
+void evaluateExpression(const SignalExpression<Expr>& expression, DataType* output)
+{
+	evaluateExpression(expression, output, expression.derived().getSamplesCount());
+}
+
+}
+
+#endif // QUASAR_SOURCE_SIGNALEXPRESSION_H
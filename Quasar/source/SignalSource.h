@@ -30,14 +30,21 @@
 #define QUASAR_SOURCE_SIGNALSOURCE_H
 
 #include "../global.h"
+#include "SignalExpression.h"
+#include "SignalSpan.h"
+#include "../memory/AlignedAllocator.h"
+#include "../memory/CowVector.h"
+#include "../simd/SimdKernels.h"
 #include <cstddef>
 #include <iterator>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <numeric>
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 
 namespace Quasar {
 
@@ -45,6 +52,8 @@ namespace Quasar {
 #define SignalSourceClass(name) template<typename DataType = SampleType, template<typename ...> class Container_t = std::vector> class name : public SignalSource<DataType, Container_t>
 #define SignalSourceTemplate template<typename DataType = SampleType, template<typename ...> class Container_t = std::vector>
 #define SignalSourceTemplateMod(...) template <typename DataType = SampleType, __VA_ARGS__, template<typename ...> class Container_t = std::vector>
+#define WindowClass(name) template<typename DataType = SampleType, template<typename ...> class Container_t = AlignedVector> class name : public SignalSource<DataType, Container_t>
+#define WindowTemplateMod(...) template <typename DataType = SampleType, __VA_ARGS__, template<typename ...> class Container_t = AlignedVector>
 #define SignalSourceTemplatedType(name) name<DataType, Container_t>
 #define SignalSourceType SignalSource<DataType, Container_t>
 
@@ -62,6 +71,13 @@ namespace Quasar {
  * which allow per-sample data access. The iterators work well with
  * C++ standard library algorithms, so feel free to use them instead of
  * manually looping and calling SignalSource::sample().
+ *
+ * Sources keeping their samples in contiguous memory report it through
+ * SignalSource::isContiguous(). For them SignalSource::span() gives direct
+ * access to the samples, and the free functions below reduce the data with
+ * plain pointer loops instead of calling the virtual sample() per element.
+ * A derived class overriding sample() with anything other than a read of
+ * toArray() must override isContiguous() to return false.
  */
 SignalSourceTemplate
 class SignalSource
@@ -117,12 +133,63 @@ public:
 	 * @param data vector of samples
 	 * @param sampleFrequency sample frequency in Hz
 	 */
-	SignalSource(std::vector<SampleType>&& data,
+	SignalSource(Container_t<DataType>&& data,
 			FrequencyType sampleFrequency = 0):
 	m_data(std::move(data)), m_sampleFrequency(sampleFrequency)
 	{
 	}
 
+	/**
+	 * Copy constructor.
+	 *
+	 * Copying a derived source which does not keep its own samples, such
+	 * as a Frame or a SignalView, copies the samples it refers to.
+	 *
+	 * @param other source to copy samples from
+	 */
+	SignalSource(const SignalSource& other):
+	m_data(copySamples(other)), m_sampleFrequency(other.getSampleFrequency())
+	{
+	}
+
+	/**
+	 * Copies a source using another kind of storage, e.g. a window
+	 * (kept in an AlignedVector) into a std::vector based source.
+	 *
+	 * @param other source to copy samples from
+	 */
+	template<template<typename ...> class OtherContainer_t>
+	SignalSource(const SignalSource<DataType, OtherContainer_t>& other):
+	m_data(copyForeignSamples(other)), m_sampleFrequency(other.getSampleFrequency())
+	{
+	}
+
+	/**
+	 * Move constructor, takes over the samples of a temporary source.
+	 *
+	 * @param other source to move samples from
+	 */
+	SignalSource(SignalSource&& other):
+	m_data(other.storesSamples() ? std::move(other.m_data) : copySamples(other)),
+	m_sampleFrequency(other.getSampleFrequency())
+	{
+	}
+
+	/**
+	 * Create the source by evaluating an expression of other sources.
+	 *
+	 * The samples are allocated once and computed in a single pass.
+	 *
+	 * @param expression element-wise expression, see SignalExpression
+	 */
+	template<typename Expr>
+	SignalSource(const SignalExpression<Expr>& expression):
+	m_data(expression.derived().getSamplesCount()),
+	m_sampleFrequency(expression.derived().getSampleFrequency())
+	{
+		evaluateExpression(expression, m_data.data());
+	}
+
 	/**
 	 * The destructor does nothing, but must be defined as virtual.
 	 */
@@ -221,6 +288,55 @@ public:
 		return m_data.data();
 	}
 
+	/**
+	 * Returns the samples for in-place arithmetic.
+	 *
+	 * Sources exposing their samples only read-only, like a Frame
+	 * (whose non-const toArray() is not overridden), or not holding
+	 * them in memory, like a PagedPcmFile, can not be modified in
+	 * place; they are told apart by the two toArray() overloads
+	 * disagreeing or by isContiguous().
+	 *
+	 * @return memory of getSamplesCount() writable samples
+	 * @throw std::logic_error if the samples can not be written in place
+	 */
+	DataType* writableSamples()
+	{
+		DataType* data = toArray();
+		if (getSamplesCount() > 0 && (!isContiguous() ||
+				data != static_cast<const SignalSource&>(*this).toArray()))
+		{
+			throw std::logic_error("Samples of this source can not be modified in place.");
+		}
+		return data;
+	}
+
+	/**
+	 * Checks whether the samples are stored contiguously in memory.
+	 *
+	 * When true, toArray() points to getSamplesCount() samples equal to
+	 * those returned by sample().
+	 *
+	 * @return true if the source can be accessed through span()
+	 */
+	virtual bool isContiguous() const
+	{
+		return true;
+	}
+
+	/**
+	 * Returns a read-only span over the samples.
+	 *
+	 * Valid only for contiguous sources and only until next operation
+	 * which modifies the source.
+	 *
+	 * @return span over the sample data
+	 */
+	SignalSpan<const DataType> span() const
+	{
+		return SignalSpan<const DataType>(toArray(), getSamplesCount());
+	}
+
 	/**
 	 * Returns number of samples in the source.
 	 *
@@ -257,120 +373,231 @@ public:
 	}
 
 	/**
-	 * Iterator class enabling sequential data access.
+	 * Iterator class enabling per-sample data access.
 	 *
-	 * It is a forward iterator with a range from the first sample in the
-	 * source to "one past last" sample.
+	 * It is a random access iterator with a range from the first sample in
+	 * the source to "one past last" sample, so std::distance, binary
+	 * searches, nth_element on copies and the like take their constant
+	 * time paths. Iterators over contiguous sources read the sample memory
+	 * directly; for raw pointers, which let std::copy and friends lower to
+	 * memmove, use span() or toArray().
+	 *
+	 * Samples are returned by value, as sources computing their samples
+	 * on the fly have no memory to refer to.
 	 */
-	class iterator :
-public std::iterator<std::forward_iterator_tag, int>
+	class iterator
 	{
 	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef DataType value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const DataType* pointer;
+		typedef DataType reference;
+
 		/**
 		 * Creates an iterator associated with a given source.
 		 *
 		 * @param source pointer to a source on which the iterator will work
 		 * @param i index of the sample in the source
 		 */
-		explicit iterator(const SignalSource<DataType, Container_t>* source =nullptr, unsigned int i = 0):
-                m_source(source), idx(i)
-            {
-            }
+		explicit iterator(const SignalSource<DataType, Container_t>* source = nullptr, std::size_t i = 0):
+			m_source(source),
+			m_data((source && source->isContiguous()) ? source->toArray() : nullptr),
+			idx(i)
+		{
+		}
 
-            /**
-             * Assigns another iterator in a memberwise fashion.
-             *
-             * @param other right-hand value iterator
-             * @return reference to self
-             */
-            iterator& operator=(const iterator& other)
-            {
-                m_source = other.m_source;
-                idx = other.idx;
-                return (*this);
-            }
+		/**
+		 * Compares two iterators for equality.
+		 *
+		 * Iterators are equal only when they belong to the same source
+		 * and point to the same sample in the source.
+		 *
+		 * @param other right-hand value iterator
+		 * @return true, if the iterators are equal
+		 */
+		bool operator==(const iterator& other) const
+		{
+			return m_source == other.m_source && idx == other.idx;
+		}
 
-            /**
-             * Compares two iterators for equality.
-             *
-             * Iterators are equal only when they belong to the same source
-             * and point to the same sample in the source.
-             *
-             * @param other right-hand value iterator
-             * @return true, if the iterators are equal
-             */
-            bool operator==(const iterator& other) const
-            {
-                return m_source == other.m_source && idx == other.idx;
-            }
+		/**
+		 * Compares two iterators for inequality.
+		 *
+		 * Negates the equality operator.
+		 *
+		 * @param other right-hand value iterator
+		 * @return true only when the iterators are not equal
+		 */
+		bool operator!=(const iterator& other) const
+		{
+			return !operator==(other);
+		}
 
-            /**
-             * Compares two iterators for inequality.
-             *
-             * Negates the equality operator.
-             *
-             * @param other right-hand value iterator
-             * @return true only when the iterators are not equal
-             */
-            bool operator!=(const iterator& other) const
-            {
-                return !operator==(other);
-            }
+		/**
+		 * Orders iterators of the same source by position.
+		 *
+		 * @param other right-hand value iterator
+		 * @return true if this iterator points to an earlier sample
+		 */
+		bool operator<(const iterator& other) const
+		{
+			return idx < other.idx;
+		}
 
-            /**
-             * Moves the iterator one sample to the right (prefix version).
-             *
-             * @return reference to self
-             */
-            iterator& operator++()
-            {
-                ++idx;
-                return (*this);
-            }
+		bool operator>(const iterator& other) const
+		{
+			return other < *this;
+		}
 
-            /**
-             * Moves the iterator one sample to the right (postfix version).
-             *
-             * @return a copy of self before incrementing
-             */
-            iterator operator++(int)
-            {
-                iterator tmp(*this);
-                ++(*this);
-                return tmp;
-            }
+		bool operator<=(const iterator& other) const
+		{
+			return !(other < *this);
+		}
 
-            /**
-             * Dereferences the iterator.
-             *
-             * @return signal sample value.
-             */
-            DataType operator*() const
-            {
-                return m_source->sample(idx);
-            }
+		bool operator>=(const iterator& other) const
+		{
+			return !(*this < other);
+		}
 
-            /**
-             * Returns the distance from the beginning of the source.
-             *
-             * @return number of samples between beginning and current position
-             */
-            std::size_t getPosition() const
-            {
-                return idx;
-            }
+		/**
+		 * Moves the iterator one sample to the right (prefix version).
+		 *
+		 * @return reference to self
+		 */
+		iterator& operator++()
+		{
+			++idx;
+			return (*this);
+		}
+
+		/**
+		 * Moves the iterator one sample to the right (postfix version).
+		 *
+		 * @return a copy of self before incrementing
+		 */
+		iterator operator++(int)
+		{
+			iterator tmp(*this);
+			++(*this);
+			return tmp;
+		}
+
+		/**
+		 * Moves the iterator one sample to the left (prefix version).
+		 *
+		 * @return reference to self
+		 */
+		iterator& operator--()
+		{
+			--idx;
+			return (*this);
+		}
+
+		/**
+		 * Moves the iterator one sample to the left (postfix version).
+		 *
+		 * @return a copy of self before decrementing
+		 */
+		iterator operator--(int)
+		{
+			iterator tmp(*this);
+			--(*this);
+			return tmp;
+		}
+
+		/**
+		 * Moves the iterator by n samples.
+		 *
+		 * @param n number of samples, negative moves to the left
+		 * @return reference to self
+		 */
+		iterator& operator+=(difference_type n)
+		{
+			idx = static_cast<std::size_t>(static_cast<difference_type>(idx) + n);
+			return (*this);
+		}
+
+		iterator& operator-=(difference_type n)
+		{
+			return (*this) += -n;
+		}
+
+		iterator operator+(difference_type n) const
+		{
+			iterator tmp(*this);
+			return tmp += n;
+		}
+
+		friend iterator operator+(difference_type n, const iterator& it)
+		{
+			return it + n;
+		}
+
+		iterator operator-(difference_type n) const
+		{
+			iterator tmp(*this);
+			return tmp -= n;
+		}
+
+		/**
+		 * Returns the number of samples between two iterators.
+		 *
+		 * @param other iterator of the same source
+		 * @return distance from other to this iterator
+		 */
+		difference_type operator-(const iterator& other) const
+		{
+			return static_cast<difference_type>(idx) - static_cast<difference_type>(other.idx);
+		}
+
+		/**
+		 * Dereferences the iterator.
+		 *
+		 * @return signal sample value.
+		 */
+		DataType operator*() const
+		{
+			return m_data ? m_data[idx] : m_source->sample(idx);
+		}
+
+		/**
+		 * Returns the sample n positions away.
+		 *
+		 * @param n offset from the current position
+		 * @return signal sample value
+		 */
+		DataType operator[](difference_type n) const
+		{
+			return *(*this + n);
+		}
+
+		/**
+		 * Returns the distance from the beginning of the source.
+		 *
+		 * @return number of samples between beginning and current position
+		 */
+		std::size_t getPosition() const
+		{
+			return idx;
+		}
+
+	private:
+		/**
+		 * Signal source - as a pointer - the iterators must be copyable.
+		 */
+		const SignalSource<DataType, Container_t>* m_source;
 
-        private:
-            /**
-             * Signal source - as a pointer - the iterators must be copyable.
-             */
-            const SignalSource<DataType, Container_t>* m_source;
+		/**
+		 * Sample memory of a contiguous source, null otherwise.
+		 */
+		const DataType* m_data;
 
-            /**
-             * Iterator's position in the source.
-             */
-            std::size_t idx;
-        };
+		/**
+		 * Iterator's position in the source.
+		 */
+		std::size_t idx;
+	};
 
 		/**
 		 * Add a constant value to each sample.
@@ -380,12 +607,7 @@ public std::iterator<std::forward_iterator_tag, int>
 		 */
         SignalSource<DataType, Container_t>& operator+=(DataType x)
 		{
-        	std::transform(
-	            std::begin(m_data),
-	            std::end(m_data),
-	            std::begin(m_data),
-	            [x] (DataType y) { return x + y; }
-	        );
+        	Simd::add(writableSamples(), getSamplesCount(), x);
 	        return *this;
 		}
 
@@ -397,12 +619,34 @@ public std::iterator<std::forward_iterator_tag, int>
          */
         SignalSource<DataType, Container_t>& operator+=(const SignalSource<DataType, Container_t>& rhs)
 		{
-            std::transform(
-                std::begin(m_data),
-                std::end(m_data),
-                std::begin(rhs.m_data),
-                std::begin(m_data),
-                [] (DataType x, DataType y) { return x + y; }
+            return addSource(rhs);
+		}
+
+        /**
+         * Per-sample addition of a source using another kind of storage.
+         *
+         * @param rhs source on the right-hand side of the operator
+         * @return sum of two sources
+         */
+        template<template<typename ...> class OtherContainer_t>
+        SignalSource<DataType, Container_t>& operator+=(const SignalSource<DataType, OtherContainer_t>& rhs)
+		{
+            return addSource(rhs);
+		}
+
+        /**
+         * Per-sample addition of an expression, evaluated in place.
+         *
+         * @param rhs expression on the right-hand side of the operator
+         * @return sum of the source and the expression
+         */
+        template<typename Expr>
+        SignalSource<DataType, Container_t>& operator+=(const SignalExpression<Expr>& rhs)
+		{
+            typedef SignalLeafExpression<DataType, Container_t> Leaf;
+            evaluateExpression(
+                SignalBinaryExpression<Leaf, Expr, SignalAddition>(Leaf(*this), rhs.derived()),
+                writableSamples()
             );
             return *this;
 		}
@@ -410,19 +654,22 @@ public std::iterator<std::forward_iterator_tag, int>
         /**
          * Multiply each sample by a constant value.
          *
+         * Real and complex floating point samples are processed by the
+         * vectorized kernels from SimdKernels.h. The multiplier is converted
+         * to the sample type first (to its real part type for a real
+         * multiplier of complex samples), so integer literals take the
+         * vectorized path as well.
+         *
          * @param x multiplier
          * @return updated source
          */
-
         template <typename Numeric>
-        SignalSource<DataType, Container_t>& operator*=(Numeric x)
+        typename std::enable_if<std::is_convertible<Numeric, DataType>::value,
+            SignalSource<DataType, Container_t>&>::type operator*=(Numeric x)
 		{
-            std::transform(
-                std::begin(m_data),
-                std::end(m_data),
-                std::begin(m_data),
-                [x] (DataType y) { return x * y; }
-            );
+            typedef typename std::conditional<std::is_arithmetic<Numeric>::value,
+                typename RealOf<DataType>::type, DataType>::type Scalar;
+            Simd::multiply(writableSamples(), getSamplesCount(), static_cast<Scalar>(x));
             return *this;
 		}
 
@@ -434,12 +681,35 @@ public std::iterator<std::forward_iterator_tag, int>
          */
         SignalSource<DataType, Container_t>& operator*=(const SignalSource<DataType, Container_t>& rhs)
 		{
-            std::transform(
-                std::begin(m_data),
-                std::end(m_data),
-                std::begin(rhs.m_data),
-                std::begin(m_data),
-                [] (DataType x, DataType y) { return x * y; }
+            return multiplySource(rhs);
+		}
+
+        /**
+         * Per-sample multiplication with a source using another kind of
+         * storage, e.g. a window.
+         *
+         * @param rhs source on the right-hand side of the operator
+         * @return product of two sources
+         */
+        template<template<typename ...> class OtherContainer_t>
+        SignalSource<DataType, Container_t>& operator*=(const SignalSource<DataType, OtherContainer_t>& rhs)
+		{
+            return multiplySource(rhs);
+		}
+
+        /**
+         * Per-sample multiplication with an expression, evaluated in place.
+         *
+         * @param rhs expression on the right-hand side of the operator
+         * @return product of the source and the expression
+         */
+        template<typename Expr>
+        SignalSource<DataType, Container_t>& operator*=(const SignalExpression<Expr>& rhs)
+		{
+            typedef SignalLeafExpression<DataType, Container_t> Leaf;
+            evaluateExpression(
+                SignalBinaryExpression<Leaf, Expr, SignalMultiplication>(Leaf(*this), rhs.derived()),
+                writableSamples()
             );
             return *this;
 		}
@@ -448,24 +718,36 @@ public std::iterator<std::forward_iterator_tag, int>
          * Overloads the [] operator for signal source for
          * sample access.
          *
+         * Goes through the virtual toArray(), so it works for every
+         * source whose samples can be written in place, see
+         * writableSamples(). Tight loops should use toArray() or span().
+         *
          * @param index The signal sample to get.
          * @return Value of the sample at index.
+         * @throw std::logic_error if the samples are read-only
          */
         DataType& operator[](std::size_t index)
         {
-        	return this->m_data[index];
+        	return writableSamples()[index];
         }
 
         /**
 		 * Overloads the [] operator for signal source for
 		 * sample access.
 		 *
+		 * Works for every contiguous source, use sample() for the others.
+		 *
 		 * @param index The signal sample to get.
 		 * @return Value of the sample at index.
+		 * @throw std::logic_error if the source is not contiguous
 		 */
         const DataType& operator[](std::size_t index) const
         {
-        	return this->m_data[index];
+        	if (!isContiguous())
+        	{
+        		throw std::logic_error("Samples of this source are not held in memory.");
+        	}
+        	return toArray()[index];
         }
 
         /**
@@ -476,11 +758,148 @@ public std::iterator<std::forward_iterator_tag, int>
          */
         SignalSource& operator =(const SignalSource& from)
         {
-        	this->m_data = from.m_data;
-        	this->m_sampleFrequency = from.m_sampleFrequency;
+        	if (this != &from)
+        	{
+        		this->m_data = copySamples(from);
+        	}
+        	this->m_sampleFrequency = from.getSampleFrequency();
+        	return *(this);
+        }
+
+        /**
+         * Signal source move assignment operator.
+         *
+         * @param from The temporary signal source whose samples are taken over.
+         * @return this object after moving the values from from.
+         */
+        SignalSource& operator =(SignalSource&& from)
+        {
+        	if (from.storesSamples())
+        	{
+        		this->m_data = std::move(from.m_data);
+        	}
+        	else
+        	{
+        		this->m_data = copySamples(from);
+        	}
+        	this->m_sampleFrequency = from.getSampleFrequency();
         	return *(this);
         }
+
+        /**
+         * Assigns the result of an expression to the source.
+         *
+         * When the length does not change, the expression is evaluated
+         * directly into the existing samples and nothing is allocated.
+         *
+         * @param expression element-wise expression, see SignalExpression
+         * @return this object holding the evaluated expression
+         */
+        template<typename Expr>
+        SignalSource& operator =(const SignalExpression<Expr>& expression)
+        {
+        	const std::size_t length = expression.derived().getSamplesCount();
+        	if (getSamplesCount() == length)
+        	{
+        		evaluateExpression(expression, writableSamples());
+        	}
+        	else
+        	{
+        		// the expression may read the current samples, so it can
+        		// not be evaluated into a buffer that is being reallocated
+        		Container_t<DataType> result(length);
+        		evaluateExpression(expression, result.data());
+        		this->m_data.swap(result);
+        	}
+        	this->m_sampleFrequency = expression.derived().getSampleFrequency();
+        	return *(this);
+        }
+
+        /**
+         * Checks whether the samples of this source are the ones in m_data.
+         *
+         * False for derived classes referring to samples stored elsewhere.
+         *
+         * @return true if m_data holds the samples
+         */
+        bool storesSamples() const
+        {
+        	return toArray() == m_data.data() && getSamplesCount() == m_data.size();
+        }
+
     protected:
+
+        /**
+         * Adds samples of a source of any storage kind.
+         *
+         * @param rhs source to add
+         * @return updated source
+         */
+        template<template<typename ...> class OtherContainer_t>
+        SignalSource& addSource(const SignalSource<DataType, OtherContainer_t>& rhs)
+        {
+            if (rhs.isContiguous())
+            {
+                Simd::add(writableSamples(), rhs.toArray(), getSamplesCount());
+                return *this;
+            }
+            return *this += SignalLeafExpression<DataType, OtherContainer_t>(rhs);
+        }
+
+        /**
+         * Multiplies by samples of a source of any storage kind.
+         *
+         * @param rhs source to multiply by
+         * @return updated source
+         */
+        template<template<typename ...> class OtherContainer_t>
+        SignalSource& multiplySource(const SignalSource<DataType, OtherContainer_t>& rhs)
+        {
+            if (rhs.isContiguous())
+            {
+                Simd::multiply(writableSamples(), rhs.toArray(), getSamplesCount());
+                return *this;
+            }
+            return *this *= SignalLeafExpression<DataType, OtherContainer_t>(rhs);
+        }
+
+        /**
+         * Copies the samples of a source using another kind of storage.
+         *
+         * @param source source to copy
+         * @return container holding the samples of the source
+         */
+        template<template<typename ...> class OtherContainer_t>
+        static Container_t<DataType> copyForeignSamples(const SignalSource<DataType, OtherContainer_t>& source)
+        {
+        	if (source.isContiguous())
+        	{
+        		const DataType* data = source.toArray();
+        		return Container_t<DataType>(data, data + source.getSamplesCount());
+        	}
+        	return Container_t<DataType>(source.begin(), source.end());
+        }
+
+        /**
+         * Copies the samples of any source into a new container.
+         *
+         * @param source source to copy
+         * @return container holding the samples of the source
+         */
+        static Container_t<DataType> copySamples(const SignalSource& source)
+        {
+        	if (source.storesSamples())
+        	{
+        		return source.m_data;
+        	}
+        	if (source.isContiguous())
+        	{
+        		const DataType* data = source.toArray();
+        		return Container_t<DataType>(data, data + source.getSamplesCount());
+        	}
+        	return Container_t<DataType>(source.begin(), source.end());
+        }
+
         /**
          * Actual sample data.
          */
@@ -492,16 +911,68 @@ public std::iterator<std::forward_iterator_tag, int>
         FrequencyType m_sampleFrequency;
     };
 
+/***************************************************************************
+ *
+ * Element-wise operators.
+ *
+ * Operators taking lvalue sources compute the result into a new source,
+ * in a single pass. Operators taking a temporary source storing its own
+ * samples reuse its storage and compute the result immediately, so a
+ * chain like a * b + c allocates only once; temporary frames and views
+ * are only read. The result has the length of the left-hand operand. Operators taking an expression (see lazy() and
+ * SignalExpression) return lazily evaluated expressions, which fuse the
+ * whole chain into one loop when assigned to a SignalSource. Both
+ * operands may use different storage (e.g. a signal in a std::vector and
+ * a window in an AlignedVector); the result uses the storage of the
+ * left-hand operand, or of the temporary one.
+ *
+ **************************************************************************/
+
+/**
+ * Leaf expression type of a signal source.
+ */
+#define SignalLeafType SignalLeafExpression<DataType, Container_t>
+
+/**
+ * Prepares a temporary operand to hold the result of an operation.
+ *
+ * Only a temporary storing its own samples and at least as long as the
+ * result qualifies; it is shortened to the length of the result. Others,
+ * e.g. a temporary Frame or SignalView referring to samples owned by
+ * someone else, must be left alone and the result computed into a new
+ * source.
+ *
+ * @param temporary operand about to be destroyed
+ * @param length samples in the result
+ * @return true if the result can be computed in place of the temporary
+ */
+SignalSourceTemplate
+bool reuseTemporary(SignalSource<DataType, Container_t>& temporary, std::size_t length)
+{
+	if (!temporary.storesSamples() || temporary.getSamplesCount() < length)
+	{
+		return false;
+	}
+	if (temporary.getSamplesCount() > length)
+	{
+		temporary.setSamplesCount(length);
+	}
+	return true;
+}
+
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator+(const SignalSource<DataType, Container_t> & lhs, DataType x)
 {
-	SignalSource<DataType, Container_t> result(lhs);
-	return result += x;
+	return SignalSource<DataType, Container_t>(lazy(lhs) + x);
 }
 
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t> && lhs, DataType x)
 {
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) + x);
+	}
 	lhs += x;
 	return std::move(lhs);
 }
@@ -509,48 +980,62 @@ SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator+(DataType x, const SignalSource<DataType, Container_t>& rhs)
 {
-	SignalSource<DataType, Container_t> result(rhs);
-	return result += x;
+	return SignalSource<DataType, Container_t>(x + lazy(rhs));
 }
 
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator+(DataType x, SignalSource<DataType, Container_t>&& rhs)
 {
-	rhs += x;
-	return std::move(rhs);
+	return std::move(rhs) + x;
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator+(const SignalSource<DataType, Container_t>& lhs, const SignalSource<DataType, Container_t>& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator+(const SignalSource<DataType, Container_t>& lhs, const SignalSource<DataType, Rhs_t>& rhs)
 {
-	SignalSource<DataType, Container_t> result(lhs);
-	return result += rhs;
+	return SignalSource<DataType, Container_t>(lazy(lhs) + rhs);
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t>&& lhs, const SignalSource<DataType, Container_t>& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t>&& lhs, const SignalSource<DataType, Rhs_t>& rhs)
 {
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) + rhs);
+	}
 	lhs += rhs;
 	return std::move(lhs);
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator+(const SignalSource<DataType, Container_t>& lhs, SignalSource<DataType, Container_t>&& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Lhs_t>
+SignalSource<DataType, Container_t> operator+(const SignalSource<DataType, Lhs_t>& lhs, SignalSource<DataType, Container_t>&& rhs)
 {
+	if (!reuseTemporary(rhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) + rhs);
+	}
 	rhs += lhs;
 	return std::move(rhs);
 }
 
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t>&& lhs, SignalSource<DataType, Rhs_t>&& rhs)
+{
+	return std::move(lhs) + static_cast<const SignalSource<DataType, Rhs_t>&>(rhs);
+}
+
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Container_t>& lhs, DataType x)
 {
-	SignalSource<DataType, Container_t> result(lhs);
-	return result *= x;
+	return SignalSource<DataType, Container_t>(lazy(lhs) * x);
 }
 
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t>&& lhs, DataType x)
 {
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) * x);
+	}
 	lhs *= x;
 	return std::move(lhs);
 }
@@ -558,38 +1043,304 @@ SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator*(DataType x, const SignalSource<DataType, Container_t>& rhs)
 {
-	SignalSource<DataType, Container_t> result(rhs);
-	return result *= x;
+	return SignalSource<DataType, Container_t>(x * lazy(rhs));
 }
 
 SignalSourceTemplate
 SignalSource<DataType, Container_t> operator*(DataType x, SignalSource<DataType, Container_t>&& rhs)
 {
-	rhs *= x;
-	return std::move(rhs);
+	return std::move(rhs) * x;
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Container_t>& lhs, const SignalSource<DataType, Container_t>& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Container_t>& lhs, const SignalSource<DataType, Rhs_t>& rhs)
 {
-	SignalSource<DataType, Container_t> result(lhs);
-	return result *= rhs;
+	return SignalSource<DataType, Container_t>(lazy(lhs) * rhs);
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t>&& lhs, const SignalSource<DataType, Container_t>& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t>&& lhs, const SignalSource<DataType, Rhs_t>& rhs)
 {
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) * rhs);
+	}
 	lhs *= rhs;
 	return std::move(lhs);
 }
 
-SignalSourceTemplate
-SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Container_t>& lhs, SignalSource<DataType, Container_t>&& rhs)
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Lhs_t>
+SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Lhs_t>& lhs, SignalSource<DataType, Container_t>&& rhs)
 {
+	if (!reuseTemporary(rhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) * rhs);
+	}
 	rhs *= lhs;
 	return std::move(rhs);
 }
 
+template<typename DataType, template<typename ...> class Container_t, template<typename ...> class Rhs_t>
+SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t>&& lhs, SignalSource<DataType, Rhs_t>&& rhs)
+{
+	return std::move(lhs) * static_cast<const SignalSource<DataType, Rhs_t>&>(rhs);
+}
+
+/*
+ * Operators combining expressions with scalars, sources and other
+ * expressions. Expression operands are copied into the resulting
+ * expression, source operands are referenced.
+ */
+
+template<typename Expr>
+SignalScalarExpression<Expr, SignalAddition>
+operator+(const SignalExpression<Expr>& lhs, typename Expr::value_type x)
+{
+	return SignalScalarExpression<Expr, SignalAddition>(lhs.derived(), x);
+}
+
+template<typename Expr>
+SignalScalarExpression<Expr, SignalAddition>
+operator+(typename Expr::value_type x, const SignalExpression<Expr>& rhs)
+{
+	return SignalScalarExpression<Expr, SignalAddition>(rhs.derived(), x);
+}
+
+template<typename Lhs, typename Rhs>
+SignalBinaryExpression<Lhs, Rhs, SignalAddition>
+operator+(const SignalExpression<Lhs>& lhs, const SignalExpression<Rhs>& rhs)
+{
+	return SignalBinaryExpression<Lhs, Rhs, SignalAddition>(lhs.derived(), rhs.derived());
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalBinaryExpression<Expr, SignalLeafType, SignalAddition>
+operator+(const SignalExpression<Expr>& lhs, const SignalSource<DataType, Container_t>& rhs)
+{
+	return SignalBinaryExpression<Expr, SignalLeafType, SignalAddition>(lhs.derived(), SignalLeafType(rhs));
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalBinaryExpression<SignalLeafType, Expr, SignalAddition>
+operator+(const SignalSource<DataType, Container_t>& lhs, const SignalExpression<Expr>& rhs)
+{
+	return SignalBinaryExpression<SignalLeafType, Expr, SignalAddition>(SignalLeafType(lhs), rhs.derived());
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalSource<DataType, Container_t> operator+(const SignalExpression<Expr>& lhs, SignalSource<DataType, Container_t>&& rhs)
+{
+	if (!reuseTemporary(rhs, lhs.derived().getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lhs + rhs);
+	}
+	rhs += lhs;
+	return std::move(rhs);
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalSource<DataType, Container_t> operator+(SignalSource<DataType, Container_t>&& lhs, const SignalExpression<Expr>& rhs)
+{
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) + rhs);
+	}
+	lhs += rhs;
+	return std::move(lhs);
+}
+
+template<typename Expr>
+SignalScalarExpression<Expr, SignalMultiplication>
+operator*(const SignalExpression<Expr>& lhs, typename Expr::value_type x)
+{
+	return SignalScalarExpression<Expr, SignalMultiplication>(lhs.derived(), x);
+}
+
+template<typename Expr>
+SignalScalarExpression<Expr, SignalMultiplication>
+operator*(typename Expr::value_type x, const SignalExpression<Expr>& rhs)
+{
+	return SignalScalarExpression<Expr, SignalMultiplication>(rhs.derived(), x);
+}
+
+template<typename Lhs, typename Rhs>
+SignalBinaryExpression<Lhs, Rhs, SignalMultiplication>
+operator*(const SignalExpression<Lhs>& lhs, const SignalExpression<Rhs>& rhs)
+{
+	return SignalBinaryExpression<Lhs, Rhs, SignalMultiplication>(lhs.derived(), rhs.derived());
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalBinaryExpression<Expr, SignalLeafType, SignalMultiplication>
+operator*(const SignalExpression<Expr>& lhs, const SignalSource<DataType, Container_t>& rhs)
+{
+	return SignalBinaryExpression<Expr, SignalLeafType, SignalMultiplication>(lhs.derived(), SignalLeafType(rhs));
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalBinaryExpression<SignalLeafType, Expr, SignalMultiplication>
+operator*(const SignalSource<DataType, Container_t>& lhs, const SignalExpression<Expr>& rhs)
+{
+	return SignalBinaryExpression<SignalLeafType, Expr, SignalMultiplication>(SignalLeafType(lhs), rhs.derived());
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalSource<DataType, Container_t> operator*(const SignalExpression<Expr>& lhs, SignalSource<DataType, Container_t>&& rhs)
+{
+	if (!reuseTemporary(rhs, lhs.derived().getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lhs * rhs);
+	}
+	rhs *= lhs;
+	return std::move(rhs);
+}
+
+template<typename Expr, typename DataType, template<typename ...> class Container_t>
+SignalSource<DataType, Container_t> operator*(SignalSource<DataType, Container_t>&& lhs, const SignalExpression<Expr>& rhs)
+{
+	if (!reuseTemporary(lhs, lhs.getSamplesCount()))
+	{
+		return SignalSource<DataType, Container_t>(lazy(lhs) * rhs);
+	}
+	lhs *= rhs;
+	return std::move(lhs);
+}
+
+#undef SignalLeafType
+
+/**
+ * Evaluates an expression into a new signal source.
+ *
+ * Useful where a SignalSource is needed but the type can not be
+ * converted implicitly, for example when calling mean() on an expression.
+ *
+ * @param expression element-wise expression
+ * @return source holding the evaluated samples
+ */
+template<typename Expr>
+typename Expr::result_type evaluate(const SignalExpression<Expr>& expression)
+{
+	return typename Expr::result_type(expression);
+}
+
+/***************************************************************************
+ *
+ * Out-parameter variants of the element-wise operations.
+ *
+ * These write into caller-owned memory - a span, a SignalView or a
+ * SignalSource which already has the right length - and never allocate,
+ * so they are safe to use in real-time block processing loops. The
+ * output may alias any of the inputs.
+ *
+ **************************************************************************/
+
+/**
+ * Evaluates an expression into caller-owned memory.
+ *
+ * @param expression element-wise expression
+ * @param output span of at least expression length samples
+ * @throw std::invalid_argument if the span is shorter than the expression
+ */
+template<typename Expr>
+void evaluate(const SignalExpression<Expr>& expression,
+		SignalSpan<typename Expr::value_type> output)
+{
+	const std::size_t length = expression.derived().getSamplesCount();
+	if (output.size() < length)
+	{
+		throw std::invalid_argument("Output span is shorter than the expression.");
+	}
+	evaluateExpression(expression, output.data(), length);
+}
+
+/**
+ * Evaluates an expression into an existing source.
+ *
+ * The source is resized to the length of the expression, which only
+ * allocates if a std::vector based source has to grow.
+ *
+ * @param expression element-wise expression
+ * @param output source receiving the samples
+ * @throw std::invalid_argument if the source can not take the length of
+ *        the expression, e.g. a shorter SignalView
+ * @throw std::logic_error if the samples of the source are read-only
+ */
+template<typename Expr, template<typename ...> class Container_t>
+void evaluate(const SignalExpression<Expr>& expression,
+		SignalSource<typename Expr::value_type, Container_t>& output)
+{
+	const std::size_t length = expression.derived().getSamplesCount();
+	if (output.getSamplesCount() != length)
+	{
+		output.setSamplesCount(length);
+		if (output.getSamplesCount() != length)
+		{
+			throw std::invalid_argument("Output source can not hold the expression.");
+		}
+	}
+	evaluateExpression(expression, output.writableSamples(), length);
+}
+
+/**
+ * Per-sample addition of two sources, out = lhs + rhs.
+ *
+ * @param lhs first source
+ * @param rhs second source, at least as long as lhs
+ * @param output span or source receiving lhs.length() samples
+ * @throw std::invalid_argument if the output can not hold them
+ */
+template<typename DataType, template<typename ...> class Lhs_t,
+		template<typename ...> class Rhs_t, typename Output>
+void add(const SignalSource<DataType, Lhs_t>& lhs,
+		const SignalSource<DataType, Rhs_t>& rhs, Output&& output)
+{
+	evaluate(lazy(lhs) + rhs, std::forward<Output>(output));
+}
+
+/**
+ * Adds a constant to each sample, out = lhs + x.
+ *
+ * @param lhs source
+ * @param x value to add
+ * @param output span or source receiving lhs.length() samples
+ * @throw std::invalid_argument if the output can not hold them
+ */
+template<typename DataType, template<typename ...> class Container_t, typename Output>
+void add(const SignalSource<DataType, Container_t>& lhs, DataType x, Output&& output)
+{
+	evaluate(lazy(lhs) + x, std::forward<Output>(output));
+}
+
+/**
+ * Per-sample multiplication of two sources, out = lhs * rhs.
+ *
+ * @param lhs first source
+ * @param rhs second source, at least as long as lhs
+ * @param output span or source receiving lhs.length() samples
+ * @throw std::invalid_argument if the output can not hold them
+ */
+template<typename DataType, template<typename ...> class Lhs_t,
+		template<typename ...> class Rhs_t, typename Output>
+void multiply(const SignalSource<DataType, Lhs_t>& lhs,
+		const SignalSource<DataType, Rhs_t>& rhs, Output&& output)
+{
+	evaluate(lazy(lhs) * rhs, std::forward<Output>(output));
+}
+
+/**
+ * Multiplies each sample by a constant, out = lhs * x.
+ *
+ * @param lhs source
+ * @param x multiplier
+ * @param output span or source receiving lhs.length() samples
+ * @throw std::invalid_argument if the output can not hold them
+ */
+template<typename DataType, template<typename ...> class Container_t, typename Output>
+void multiply(const SignalSource<DataType, Container_t>& lhs, DataType x, Output&& output)
+{
+	evaluate(lazy(lhs) * x, std::forward<Output>(output));
+}
+
 /***************************************************************************
  *
  * Free-standing functions closely related to signals.
@@ -605,8 +1356,13 @@ SignalSource<DataType, Container_t> operator*(const SignalSource<DataType, Conta
 SignalSourceTemplate
 DataType mean(const SignalSource<DataType, Container_t>& source)
 {
-	DataType sum = std::accumulate(std::begin(source), std::end(source), 0.0);
-	return sum / source.getSamplesCount();
+	if (source.isContiguous())
+	{
+		return mean(source.span());
+	}
+	typedef typename AccumulatorOf<DataType>::type Accumulator;
+	Accumulator sum = std::accumulate(std::begin(source), std::end(source), Accumulator(0));
+	return static_cast<DataType>(sum / static_cast<Accumulator>(source.getSamplesCount()));
 }
 
 /**
@@ -618,14 +1374,19 @@ DataType mean(const SignalSource<DataType, Container_t>& source)
 SignalSourceTemplate
 DataType energy(const SignalSource<DataType, Container_t>& source)
 {
-	return std::accumulate(
+	if (source.isContiguous())
+	{
+		return energy(source.span());
+	}
+	typedef typename AccumulatorOf<DataType>::type Accumulator;
+	return static_cast<DataType>(std::accumulate(
 			std::begin(source),
 			std::end(source),
-			0.0,
-			[] (DataType acc, DataType value) {
+			Accumulator(0),
+			[] (Accumulator acc, DataType value) {
 				return acc + value * value;
 			}
-	);
+	));
 }
 
 /**
@@ -674,7 +1435,12 @@ DataType rms(const SignalSource<DataType, Container_t>& source)
  */
 SignalSourceTemplate DataType ApplyFirFilter(const SignalSource<DataType, Container_t>& source, const DataType x[])
 {
-	return std::inner_product(source.begin(), source.end(), x, 0.0);
+	if (source.isContiguous())
+	{
+		return ApplyFirFilter(source.span(), x);
+	}
+	typedef typename AccumulatorOf<DataType>::type Accumulator;
+	return static_cast<DataType>(std::inner_product(source.begin(), source.end(), x, Accumulator(0)));
 }
 }
 
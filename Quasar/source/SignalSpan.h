@@ -0,0 +1,311 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SignalSpan.h
+ *
+ * A non-owning view over contiguous sample memory.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_SIGNALSPAN_H
+#define QUASAR_SOURCE_SIGNALSPAN_H
+
+#include "../global.h"
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace Quasar {
+
+/**
+ * A pointer and a length describing contiguous samples.
+ *
+ * Unlike SignalSource, a span has no virtual methods, so loops over it
+ * are plain pointer loops the compiler is free to unroll and vectorize.
+ * Spans are obtained from contiguous sources through SignalSource::span()
+ * and stay valid only as long as the memory they point to.
+ *
+ * Use SignalSpan<const T> for read-only access.
+ */
+template<typename DataType>
+class SignalSpan
+{
+public:
+	/**
+	 * Type of the samples, without const qualification.
+	 */
+	typedef typename std::remove_const<DataType>::type value_type;
+
+	/**
+	 * Spans are iterated with raw pointers.
+	 */
+	typedef DataType* iterator;
+
+	/**
+	 * Creates an empty span.
+	 */
+	SignalSpan():
+	m_data(nullptr), m_length(0)
+	{
+	}
+
+	/**
+	 * Creates a span over a C-style array.
+	 *
+	 * @param data pointer to the first sample
+	 * @param length number of samples
+	 */
+	SignalSpan(DataType* data, std::size_t length):
+	m_data(data), m_length(length)
+	{
+	}
+
+	/**
+	 * Converts a mutable span to a read-only one.
+	 *
+	 * @param other span over non-const samples
+	 */
+	template<typename OtherType, typename = typename std::enable_if<
+			std::is_convertible<OtherType*, DataType*>::value>::type>
+	SignalSpan(const SignalSpan<OtherType>& other):
+	m_data(other.data()), m_length(other.size())
+	{
+	}
+
+	/**
+	 * Returns pointer to the first sample.
+	 *
+	 * @return sample data
+	 */
+	DataType* data() const
+	{
+		return m_data;
+	}
+
+	/**
+	 * Returns number of samples in the span.
+	 *
+	 * @return samples count
+	 */
+	std::size_t size() const
+	{
+		return m_length;
+	}
+
+	/**
+	 * Checks whether the span has no samples.
+	 *
+	 * @return true for empty spans
+	 */
+	bool empty() const
+	{
+		return m_length == 0;
+	}
+
+	/**
+	 * Returns pointer to the first sample.
+	 *
+	 * @return iterator
+	 */
+	iterator begin() const
+	{
+		return m_data;
+	}
+
+	/**
+	 * Returns pointer to the "one past last" sample.
+	 *
+	 * @return iterator
+	 */
+	iterator end() const
+	{
+		return m_data + m_length;
+	}
+
+	/**
+	 * Gives access to a sample of the span.
+	 *
+	 * @param index index of the sample
+	 * @return reference to the sample
+	 */
+	DataType& operator[](std::size_t index) const
+	{
+		return m_data[index];
+	}
+
+	/**
+	 * Returns a part of the span.
+	 *
+	 * @param offset index of the first sample of the part
+	 * @param count number of samples in the part
+	 * @return span over samples [offset, offset + count)
+	 */
+	SignalSpan subspan(std::size_t offset, std::size_t count) const
+	{
+		return SignalSpan(m_data + offset, count);
+	}
+
+private:
+	/**
+	 * Non-owning pointer to the first sample.
+	 */
+	DataType* m_data;
+
+	/**
+	 * Number of samples.
+	 */
+	std::size_t m_length;
+};
+
+/**
+ * Sums f(x) over a span.
+ *
+ * Four independent partial sums are kept so the loop carries no
+ * dependency between neighbouring samples and can be vectorized without
+ * relaxing floating point semantics. The sums use AccumulatorOf, so single
+ * precision samples may be summed in double precision.
+ *
+ * @param span samples to reduce
+ * @param f function applied to each sample before summing
+ * @return sum of f(x)
+ */
+template<typename DataType, typename Function>
+typename std::remove_const<DataType>::type spanSum(SignalSpan<DataType> span, Function f)
+{
+	typedef typename std::remove_const<DataType>::type ValueType;
+	typedef typename AccumulatorOf<ValueType>::type Accumulator;
+	const DataType* data = span.data();
+	const std::size_t length = span.size();
+	Accumulator s0 = Accumulator(0), s1 = Accumulator(0), s2 = Accumulator(0), s3 = Accumulator(0);
+	std::size_t i = 0;
+	for (; i + 4 <= length; i += 4)
+	{
+		s0 += f(data[i]);
+		s1 += f(data[i + 1]);
+		s2 += f(data[i + 2]);
+		s3 += f(data[i + 3]);
+	}
+	for (; i < length; ++i)
+	{
+		s0 += f(data[i]);
+	}
+	return static_cast<ValueType>((s0 + s1) + (s2 + s3));
+}
+
+/**
+ * Calculates mean value of contiguous samples.
+ *
+ * @param span samples
+ * @return mean
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type mean(SignalSpan<DataType> span)
+{
+	typedef typename std::remove_const<DataType>::type ValueType;
+	return spanSum(span, [] (ValueType x) { return x; }) /
+			static_cast<ValueType>(span.size());
+}
+
+/**
+ * Calculates energy of contiguous samples.
+ *
+ * @param span samples
+ * @return energy
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type energy(SignalSpan<DataType> span)
+{
+	typedef typename std::remove_const<DataType>::type ValueType;
+	return spanSum(span, [] (ValueType x) { return x * x; });
+}
+
+/**
+ * Calculates power of contiguous samples.
+ *
+ * @param span samples
+ * @return power
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type power(SignalSpan<DataType> span)
+{
+	typedef typename std::remove_const<DataType>::type ValueType;
+	return energy(span) / static_cast<ValueType>(span.size());
+}
+
+/**
+ * Calculates Euclidean (L2) norm of contiguous samples.
+ *
+ * @param span samples
+ * @return norm
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type norm(SignalSpan<DataType> span)
+{
+	return std::sqrt(energy(span));
+}
+
+/**
+ * Calculates root mean square level of contiguous samples.
+ *
+ * @param span samples
+ * @return RMS level
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type rms(SignalSpan<DataType> span)
+{
+	return std::sqrt(power(span));
+}
+
+/**
+ * Applies contiguous filter taps to an array of samples.
+ *
+ * @param taps filter coefficients
+ * @param x samples, at least taps.size() long
+ * @return the summed output of the filter
+ */
+template<typename DataType>
+typename std::remove_const<DataType>::type ApplyFirFilter(SignalSpan<DataType> taps,
+		const typename std::remove_const<DataType>::type x[])
+{
+	typedef typename std::remove_const<DataType>::type ValueType;
+	typedef typename AccumulatorOf<ValueType>::type Accumulator;
+	const DataType* h = taps.data();
+	const std::size_t length = taps.size();
+	Accumulator s0 = Accumulator(0), s1 = Accumulator(0), s2 = Accumulator(0), s3 = Accumulator(0);
+	std::size_t i = 0;
+	for (; i + 4 <= length; i += 4)
+	{
+		s0 += h[i] * x[i];
+		s1 += h[i + 1] * x[i + 1];
+		s2 += h[i + 2] * x[i + 2];
+		s3 += h[i + 3] * x[i + 3];
+	}
+	for (; i < length; ++i)
+	{
+		s0 += h[i] * x[i];
+	}
+	return static_cast<ValueType>((s0 + s1) + (s2 + s3));
+}
+
+}
+
+#endif // QUASAR_SOURCE_SIGNALSPAN_H
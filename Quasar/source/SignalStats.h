@@ -0,0 +1,354 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SignalStats.h
+ *
+ * Single pass calculation of basic signal statistics.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_SIGNALSTATS_H
+#define QUASAR_SOURCE_SIGNALSTATS_H
+
+#include "../global.h"
+#include "SignalSource.h"
+#include "SignalSpan.h"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace Quasar {
+
+/**
+ * Accumulates mean, energy, RMS, minimum, maximum, peak and crest factor
+ * of real signals in one pass over the data.
+ *
+ * Each call to update() reads the block once, keeping four independent
+ * partial results so the loop vectorizes. Blocks are summed in chunks
+ * and the chunk sums are added with Kahan compensation, which keeps the
+ * error close to pairwise summation even for very long signals.
+ *
+ * Statistics of separate blocks (or of separate threads) can be
+ * combined with merge():
+ *
+ * @verbatim
+ * Quasar::SignalStats<> total;
+ * for (auto frame : frames) {
+ *     Quasar::SignalStats<> stats(frame);
+ *     total.merge(stats);
+ * }
+ * double crest = total.crestFactor();      @endverbatim
+ *
+ * AccumulatorType selects the precision of the sums, e.g.
+ * SignalStats<float, double> for float samples accumulated in double.
+ * It defaults to AccumulatorOf<DataType>::type.
+ */
+template<typename DataType = SampleType,
+		typename AccumulatorType = typename AccumulatorOf<DataType>::type>
+class SignalStats
+{
+public:
+	/**
+	 * Creates empty statistics.
+	 */
+	SignalStats()
+	{
+		reset();
+	}
+
+	/**
+	 * Creates statistics of a signal source.
+	 *
+	 * @param source signal source
+	 */
+	template<template<typename ...> class Container_t>
+	explicit SignalStats(const SignalSource<DataType, Container_t>& source)
+	{
+		reset();
+		update(source);
+	}
+
+	/**
+	 * Clears all accumulated statistics.
+	 */
+	void reset()
+	{
+		m_count = 0;
+		m_sum = m_sumCompensation = AccumulatorType(0);
+		m_sumSquares = m_sumSquaresCompensation = AccumulatorType(0);
+		m_min = std::numeric_limits<DataType>::max();
+		m_max = std::numeric_limits<DataType>::lowest();
+	}
+
+	/**
+	 * Adds a block of contiguous samples to the statistics.
+	 *
+	 * @param block samples
+	 */
+	void update(SignalSpan<const DataType> block)
+	{
+		const DataType* data = block.data();
+		const std::size_t length = block.size();
+		for (std::size_t chunk = 0; chunk < length; chunk += CHUNK_SIZE)
+		{
+			const std::size_t end = (length - chunk < CHUNK_SIZE) ? length : chunk + CHUNK_SIZE;
+			updateChunk(data, chunk, end);
+		}
+		m_count += length;
+	}
+
+	/**
+	 * Adds all samples of a source to the statistics.
+	 *
+	 * Non-contiguous sources are read through sample() into a small
+	 * buffer, block by block.
+	 *
+	 * @param source signal source
+	 */
+	template<template<typename ...> class Container_t>
+	void update(const SignalSource<DataType, Container_t>& source)
+	{
+		if (source.isContiguous())
+		{
+			update(source.span());
+			return;
+		}
+		DataType buffer[CHUNK_SIZE];
+		const std::size_t length = source.getSamplesCount();
+		for (std::size_t offset = 0; offset < length; offset += CHUNK_SIZE)
+		{
+			const std::size_t count = (length - offset < CHUNK_SIZE) ? length - offset : CHUNK_SIZE;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				buffer[i] = source.sample(offset + i);
+			}
+			update(SignalSpan<const DataType>(buffer, count));
+		}
+	}
+
+	/**
+	 * Combines statistics of another set of samples with these.
+	 *
+	 * The result is the same as if all samples were passed to a single
+	 * accumulator.
+	 *
+	 * @param other statistics to merge
+	 */
+	void merge(const SignalStats& other)
+	{
+		kahanAdd(m_sum, m_sumCompensation, other.m_sum);
+		kahanAdd(m_sum, m_sumCompensation, -other.m_sumCompensation);
+		kahanAdd(m_sumSquares, m_sumSquaresCompensation, other.m_sumSquares);
+		kahanAdd(m_sumSquares, m_sumSquaresCompensation, -other.m_sumSquaresCompensation);
+		if (other.m_min < m_min)
+		{
+			m_min = other.m_min;
+		}
+		if (other.m_max > m_max)
+		{
+			m_max = other.m_max;
+		}
+		m_count += other.m_count;
+	}
+
+	/**
+	 * Returns number of accumulated samples.
+	 *
+	 * @return samples count
+	 */
+	std::size_t count() const
+	{
+		return m_count;
+	}
+
+	/**
+	 * Returns mean value of the samples.
+	 *
+	 * @return mean
+	 */
+	AccumulatorType mean() const
+	{
+		return m_sum / static_cast<AccumulatorType>(m_count);
+	}
+
+	/**
+	 * Returns energy (sum of squares) of the samples.
+	 *
+	 * @return energy
+	 */
+	AccumulatorType energy() const
+	{
+		return m_sumSquares;
+	}
+
+	/**
+	 * Returns power (mean square) of the samples.
+	 *
+	 * @return power
+	 */
+	AccumulatorType power() const
+	{
+		return m_sumSquares / static_cast<AccumulatorType>(m_count);
+	}
+
+	/**
+	 * Returns root mean square level of the samples.
+	 *
+	 * @return RMS level
+	 */
+	AccumulatorType rms() const
+	{
+		return std::sqrt(power());
+	}
+
+	/**
+	 * Returns the smallest sample.
+	 *
+	 * @return minimum
+	 */
+	DataType min() const
+	{
+		return m_min;
+	}
+
+	/**
+	 * Returns the largest sample.
+	 *
+	 * @return maximum
+	 */
+	DataType max() const
+	{
+		return m_max;
+	}
+
+	/**
+	 * Returns the largest absolute sample value.
+	 *
+	 * @return peak level
+	 */
+	DataType peak() const
+	{
+		return (-m_min > m_max) ? -m_min : m_max;
+	}
+
+	/**
+	 * Returns the ratio of peak level to RMS level.
+	 *
+	 * @return crest factor
+	 */
+	AccumulatorType crestFactor() const
+	{
+		return static_cast<AccumulatorType>(peak()) / rms();
+	}
+
+private:
+	/**
+	 * Number of samples summed before the partial sums are added to the
+	 * compensated totals.
+	 */
+	static const std::size_t CHUNK_SIZE = 256;
+
+	/**
+	 * Adds a value to a compensated (Kahan) sum.
+	 *
+	 * @param sum running sum
+	 * @param compensation running compensation of lost low-order bits
+	 * @param value value to add
+	 */
+	static void kahanAdd(AccumulatorType& sum, AccumulatorType& compensation, AccumulatorType value)
+	{
+		const AccumulatorType y = value - compensation;
+		const AccumulatorType t = sum + y;
+		compensation = (t - sum) - y;
+		sum = t;
+	}
+
+	/**
+	 * Accumulates samples [begin, end) using four independent lanes.
+	 *
+	 * @param data sample memory
+	 * @param begin index of the first sample
+	 * @param end index past the last sample
+	 */
+	void updateChunk(const DataType* data, std::size_t begin, std::size_t end)
+	{
+		AccumulatorType sum[4] = {0, 0, 0, 0};
+		AccumulatorType squares[4] = {0, 0, 0, 0};
+		DataType lo[4] = {m_min, m_min, m_min, m_min};
+		DataType hi[4] = {m_max, m_max, m_max, m_max};
+		std::size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			for (std::size_t lane = 0; lane < 4; ++lane)
+			{
+				const AccumulatorType x = data[i + lane];
+				sum[lane] += x;
+				squares[lane] += x * x;
+				lo[lane] = (data[i + lane] < lo[lane]) ? data[i + lane] : lo[lane];
+				hi[lane] = (data[i + lane] > hi[lane]) ? data[i + lane] : hi[lane];
+			}
+		}
+		for (; i < end; ++i)
+		{
+			const AccumulatorType x = data[i];
+			sum[0] += x;
+			squares[0] += x * x;
+			lo[0] = (data[i] < lo[0]) ? data[i] : lo[0];
+			hi[0] = (data[i] > hi[0]) ? data[i] : hi[0];
+		}
+		kahanAdd(m_sum, m_sumCompensation, (sum[0] + sum[1]) + (sum[2] + sum[3]));
+		kahanAdd(m_sumSquares, m_sumSquaresCompensation,
+				(squares[0] + squares[1]) + (squares[2] + squares[3]));
+		for (std::size_t lane = 0; lane < 4; ++lane)
+		{
+			m_min = (lo[lane] < m_min) ? lo[lane] : m_min;
+			m_max = (hi[lane] > m_max) ? hi[lane] : m_max;
+		}
+	}
+
+	/**
+	 * Number of accumulated samples.
+	 */
+	std::size_t m_count;
+
+	/**
+	 * Compensated sum of samples.
+	 */
+	AccumulatorType m_sum, m_sumCompensation;
+
+	/**
+	 * Compensated sum of squared samples.
+	 */
+	AccumulatorType m_sumSquares, m_sumSquaresCompensation;
+
+	/**
+	 * Smallest and largest sample so far.
+	 */
+	DataType m_min, m_max;
+};
+
+template<typename DataType, typename AccumulatorType>
+const std::size_t SignalStats<DataType, AccumulatorType>::CHUNK_SIZE;
+
+}
+
+#endif // QUASAR_SOURCE_SIGNALSTATS_H
@@ -0,0 +1,269 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SignalView.h
+ *
+ * A signal source over samples owned by someone else.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_SIGNALVIEW_H
+#define QUASAR_SOURCE_SIGNALVIEW_H
+
+#include "../global.h"
+#include "SignalSource.h"
+#include "SignalSpan.h"
+#include <cstddef>
+#include <stdexcept>
+
+namespace Quasar {
+
+/**
+ * A non-owning signal source over an external buffer.
+ *
+ * SignalView wraps memory which is already filled with samples - a driver
+ * DMA buffer, a memory mapped file, a slot of a ring buffer - and makes it
+ * usable wherever a SignalSource is expected, without copying a single
+ * sample. Frames can be cut from it, windows can be applied to it,
+ * FFTs transform it in place and the free functions reduce it directly.
+ *
+ * Arithmetic writes into the viewed memory:
+ *
+ * @verbatim
+ * Quasar::SignalView<> block(dmaBuffer, blockSize, sampleRate);
+ * block *= window;                   // in place, in the DMA buffer
+ * Quasar::SignalSource<> out = block * gain + offset;    // into a new source
+ * @endverbatim
+ *
+ * The view never allocates or frees the memory and the buffer must
+ * outlive it. The length of a view can only shrink; a view can be
+ * pointed to another buffer with reset().
+ */
+SignalSourceClass(SignalView)
+{
+public:
+	/**
+	 * Creates an empty view.
+	 *
+	 * @param sampleFrequency sample frequency in Hz
+	 */
+	SignalView(FrequencyType sampleFrequency = 0):
+	SignalSourceType(sampleFrequency), m_view(nullptr), m_length(0)
+	{
+	}
+
+	/**
+	 * Creates a view over a C-style array.
+	 *
+	 * @param data pointer to the first sample
+	 * @param length number of samples
+	 * @param sampleFrequency sample frequency in Hz
+	 */
+	SignalView(DataType* data, std::size_t length, FrequencyType sampleFrequency = 0):
+	SignalSourceType(sampleFrequency), m_view(data), m_length(length)
+	{
+	}
+
+	/**
+	 * Creates a view over a span.
+	 *
+	 * @param span samples to view
+	 * @param sampleFrequency sample frequency in Hz
+	 */
+	SignalView(SignalSpan<DataType> span, FrequencyType sampleFrequency = 0):
+	SignalSourceType(sampleFrequency), m_view(span.data()), m_length(span.size())
+	{
+	}
+
+	/**
+	 * Creates a view over the samples of another contiguous source.
+	 *
+	 * @param source source whose samples are viewed, must outlive the view
+	 * @throw std::invalid_argument if the samples of the source are
+	 *        read-only (a Frame) or not in memory (a PagedPcmFile)
+	 */
+	explicit SignalView(SignalSourceType& source):
+	SignalSourceType(source.getSampleFrequency()),
+	m_view(viewedSamples(source)), m_length(source.getSamplesCount())
+	{
+	}
+
+	/**
+	 * Copies the view - both views refer to the same memory.
+	 *
+	 * @param other view to copy
+	 */
+	SignalView(const SignalView& other):
+	SignalSourceType(other.m_sampleFrequency),
+	m_view(other.m_view), m_length(other.m_length)
+	{
+	}
+
+	/**
+	 * Points this view to the memory of another view.
+	 *
+	 * No samples are copied.
+	 *
+	 * @param other view to copy
+	 * @return reference to the current object
+	 */
+	SignalView& operator=(const SignalView& other)
+	{
+		this->m_sampleFrequency = other.m_sampleFrequency;
+		m_view = other.m_view;
+		m_length = other.m_length;
+		return *this;
+	}
+
+	/**
+	 * Evaluates an expression into the viewed memory.
+	 *
+	 * The viewed memory can not grow: a longer expression is computed
+	 * only for the first getSamplesCount() samples, and a shorter one
+	 * shortens the view to its own length.
+	 *
+	 * @param expression element-wise expression, see SignalExpression
+	 * @return reference to the current object
+	 */
+	template<typename Expr>
+	SignalView& operator=(const SignalExpression<Expr>& expression)
+	{
+		if (expression.derived().getSamplesCount() < m_length)
+		{
+			m_length = expression.derived().getSamplesCount();
+		}
+		evaluateExpression(expression, m_view, m_length);
+		return *this;
+	}
+
+	/**
+	 * Points the view to another buffer.
+	 *
+	 * Handy for walking over consecutive driver or ring buffer blocks
+	 * with a single view object.
+	 *
+	 * @param data pointer to the first sample
+	 * @param length number of samples
+	 */
+	void reset(DataType* data, std::size_t length)
+	{
+		m_view = data;
+		m_length = length;
+	}
+
+	/**
+	 * Returns number of viewed samples.
+	 *
+	 * @return samples count
+	 */
+	virtual std::size_t getSamplesCount() const
+	{
+		return m_length;
+	}
+
+	/**
+	 * Shortens the view.
+	 *
+	 * The viewed memory can not grow, so a length greater than the
+	 * current one is ignored.
+	 *
+	 * @param length the new length of the view
+	 * @param value unused
+	 * @return the view
+	 */
+	virtual SignalSourceType& setSamplesCount(std::size_t length, DataType = 0)
+	{
+		if (length < m_length)
+		{
+			m_length = length;
+		}
+		return *this;
+	}
+
+	/**
+	 * Returns sample located at the "position" in the view.
+	 *
+	 * @param position sample index in the view
+	 * @return sample value
+	 */
+	virtual DataType sample(std::size_t position) const
+	{
+		return m_view[position];
+	}
+
+	/**
+	 * Returns the viewed memory.
+	 *
+	 * @return C-style array containing sample data
+	 */
+	virtual DataType* toArray()
+	{
+		return m_view;
+	}
+
+	/**
+	 * Returns the viewed memory.
+	 *
+	 * @return C-style array containing sample data
+	 */
+	virtual const DataType* toArray() const
+	{
+		return m_view;
+	}
+
+private:
+	/**
+	 * Returns the samples of a source a view can write to.
+	 *
+	 * A Frame overrides only the const toArray(), so the two overloads
+	 * disagree for it, and sources which are not contiguous have no
+	 * memory to view at all.
+	 *
+	 * @param source source to view
+	 * @return pointer to its first sample
+	 * @throw std::invalid_argument if the samples can not be viewed
+	 */
+	static DataType* viewedSamples(SignalSourceType& source)
+	{
+		DataType* data = source.toArray();
+		if (source.getSamplesCount() > 0 && (!source.isContiguous() ||
+				data != static_cast<const SignalSourceType&>(source).toArray()))
+		{
+			throw std::invalid_argument("Only sources with writable samples in memory can be viewed.");
+		}
+		return data;
+	}
+
+	/**
+	 * Non-owning pointer to the first sample.
+	 */
+	DataType* m_view;
+
+	/**
+	 * Number of viewed samples.
+	 */
+	std::size_t m_length;
+};
+
+}
+
+#endif // QUASAR_SOURCE_SIGNALVIEW_H
@@ -0,0 +1,301 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file StreamingFramer.h
+ *
+ * Division of a live stream of samples into overlapping frames.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_SOURCE_STREAMINGFRAMER_H
+#define QUASAR_SOURCE_STREAMINGFRAMER_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "SignalSource.h"
+#include "SignalSpan.h"
+#include "SignalView.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace Quasar {
+
+/**
+ * Cuts frames from a stream of samples pushed in blocks of any size.
+ *
+ * Frames have the same layout as in FramesCollection::divideFrames():
+ * samplesPerFrame long, adjacent frames sharing samplesPerOverlap
+ * samples. Each frame is passed to a callback as soon as its last sample
+ * arrives, as a read-only SignalView into the internal ring buffer:
+ *
+ * @verbatim
+ * Quasar::StreamingFramer<> framer(1024, 512, sampleRate);
+ * while (device.read(block, blockSize)) {
+ *     framer.push(block, blockSize, [&] (const Quasar::SignalView<>& frame) {
+ *         spectrum = frame * window;
+ *     });
+ * }                                                               @endverbatim
+ *
+ * The ring holds a multiple of the hop size, followed by a mirror of its
+ * first samplesPerFrame - 1 samples which is written together with them.
+ * A frame starting anywhere in the ring therefore continues linearly
+ * into the mirror, and every frame is handed out without copying. The
+ * buffer is allocated once, in the constructor; pushing never allocates.
+ *
+ * The view is valid only during the callback and must not be modified,
+ * as its samples are shared with the following frames.
+ */
+SignalSourceTemplate
+class StreamingFramer
+{
+public:
+	/**
+	 * Type of the frames passed to the callback.
+	 */
+	typedef SignalSourceTemplatedType(SignalView) FrameType;
+
+	/**
+	 * Creates the framer.
+	 *
+	 * An overlap not smaller than the frame emits no frames, as in
+	 * FramesCollection.
+	 *
+	 * @param samplesPerFrame how many samples each frame holds
+	 * @param samplesPerOverlap how many samples are common to adjacent frames
+	 * @param sampleFrequency sample frequency of the stream in Hz
+	 */
+	StreamingFramer(std::size_t samplesPerFrame,
+			std::size_t samplesPerOverlap = 0,
+			FrequencyType sampleFrequency = 0):
+	m_samplesPerFrame(samplesPerFrame),
+	m_hop((samplesPerOverlap < samplesPerFrame) ? samplesPerFrame - samplesPerOverlap : 0),
+	m_capacity(ringCapacity(samplesPerFrame, m_hop)),
+	m_buffer(m_capacity ? m_capacity + samplesPerFrame - 1 : 0),
+	m_sampleFrequency(sampleFrequency),
+	m_write(0), m_frameStart(0), m_filled(0)
+	{
+	}
+
+	/**
+	 * Pushes a block of samples, emitting all frames it completes.
+	 *
+	 * @param samples pointer to the samples
+	 * @param count number of samples
+	 * @param onFrame callable taking const FrameType&
+	 */
+	template<typename Callback>
+	void push(const DataType* samples, std::size_t count, Callback&& onFrame)
+	{
+		if (m_capacity == 0)
+		{
+			return;
+		}
+		while (count > 0)
+		{
+			std::size_t n = std::min(count, m_samplesPerFrame - m_filled);
+			n = std::min(n, m_capacity - m_write);
+			write(samples, n);
+			samples += n;
+			count -= n;
+			m_filled += n;
+			if (m_filled == m_samplesPerFrame)
+			{
+				const FrameType frame(m_buffer.data() + m_frameStart,
+						m_samplesPerFrame, m_sampleFrequency);
+				onFrame(frame);
+				m_frameStart += m_hop;
+				if (m_frameStart >= m_capacity)
+				{
+					m_frameStart -= m_capacity;
+				}
+				m_filled -= m_hop;
+			}
+		}
+	}
+
+	/**
+	 * Pushes a span of samples, emitting all frames it completes.
+	 *
+	 * @param samples block of samples
+	 * @param onFrame callable taking const FrameType&
+	 */
+	template<typename Callback>
+	void push(SignalSpan<const DataType> samples, Callback&& onFrame)
+	{
+		push(samples.data(), samples.size(), onFrame);
+	}
+
+	/**
+	 * Pushes all samples of a source, emitting all frames they complete.
+	 *
+	 * @param source block of samples
+	 * @param onFrame callable taking const FrameType&
+	 */
+	template<template<typename ...> class SourceContainer_t, typename Callback>
+	void push(const SignalSource<DataType, SourceContainer_t>& source, Callback&& onFrame)
+	{
+		if (source.isContiguous())
+		{
+			push(source.toArray(), source.getSamplesCount(), onFrame);
+			return;
+		}
+		const std::size_t block = 256;
+		DataType buffer[block];
+		const std::size_t length = source.getSamplesCount();
+		for (std::size_t offset = 0; offset < length; offset += block)
+		{
+			const std::size_t count = std::min(block, length - offset);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				buffer[i] = source.sample(offset + i);
+			}
+			push(buffer, count, onFrame);
+		}
+	}
+
+	/**
+	 * Drops the buffered samples, the next pushed sample starts a frame.
+	 */
+	void reset()
+	{
+		m_write = 0;
+		m_frameStart = 0;
+		m_filled = 0;
+	}
+
+	/**
+	 * Returns number of samples in each frame.
+	 *
+	 * @return frame size in samples
+	 */
+	std::size_t getSamplesPerFrame() const
+	{
+		return m_samplesPerFrame;
+	}
+
+	/**
+	 * Returns distance between beginnings of adjacent frames.
+	 *
+	 * @return hop size in samples
+	 */
+	std::size_t getHop() const
+	{
+		return m_hop;
+	}
+
+	/**
+	 * Returns number of samples buffered towards the next frame.
+	 *
+	 * @return samples count
+	 */
+	std::size_t getBufferedCount() const
+	{
+		return m_filled;
+	}
+
+private:
+	/**
+	 * Returns ring size: a multiple of the hop, large enough for the
+	 * mirrored part to stay small compared to the whole ring.
+	 *
+	 * @param samplesPerFrame frame length
+	 * @param hop distance between beginnings of adjacent frames
+	 * @return number of samples in the ring, 0 if no frames are emitted
+	 */
+	static std::size_t ringCapacity(std::size_t samplesPerFrame, std::size_t hop)
+	{
+		if (samplesPerFrame == 0 || hop == 0)
+		{
+			return 0;
+		}
+		const std::size_t minimum = 4 * samplesPerFrame;
+		return ((minimum + hop - 1) / hop) * hop;
+	}
+
+	/**
+	 * Copies samples at the write position, which must not wrap, and
+	 * keeps the mirror of the ring beginning up to date.
+	 *
+	 * @param samples pointer to the samples
+	 * @param count number of samples
+	 */
+	void write(const DataType* samples, std::size_t count)
+	{
+		DataType* ring = m_buffer.data();
+		std::copy(samples, samples + count, ring + m_write);
+		const std::size_t mirrored = m_samplesPerFrame - 1;
+		if (m_write < mirrored)
+		{
+			const std::size_t n = std::min(count, mirrored - m_write);
+			std::copy(samples, samples + n, ring + m_capacity + m_write);
+		}
+		m_write += count;
+		if (m_write == m_capacity)
+		{
+			m_write = 0;
+		}
+	}
+
+	/**
+	 * Number of samples in each frame.
+	 */
+	std::size_t m_samplesPerFrame;
+
+	/**
+	 * Distance between beginnings of adjacent frames.
+	 */
+	std::size_t m_hop;
+
+	/**
+	 * Size of the ring, without the mirror.
+	 */
+	std::size_t m_capacity;
+
+	/**
+	 * The ring followed by the mirror of its beginning.
+	 */
+	AlignedVector<DataType> m_buffer;
+
+	/**
+	 * Sample frequency reported by the frames.
+	 */
+	FrequencyType m_sampleFrequency;
+
+	/**
+	 * Ring position of the next pushed sample.
+	 */
+	std::size_t m_write;
+
+	/**
+	 * Ring position of the first sample of the next frame.
+	 */
+	std::size_t m_frameStart;
+
+	/**
+	 * Samples of the next frame received so far.
+	 */
+	std::size_t m_filled;
+};
+
+}
+
+#endif // QUASAR_SOURCE_STREAMINGFRAMER_H
@@ -85,18 +85,19 @@ public:
 		return *(this);
 	}
 
+	using GeneratorType::generate;
+
 
 	/*
 	 * Generates a linear chirp from start to stop frequency with
 	 * time period 1/Frequency (setFrequency). setPhase sets the
 	 * initial phase of the signal.
 	 *
-	 * @param samplesCount The number of samples to generate. A value
-	 * larger then sampleFrequency /frequency will result in
-	 * a periodic waveform.
+	 * @param output The buffer to fill. A buffer longer then
+	 * sampleFrequency /frequency will result in a periodic waveform.
 	 */
-	void generate(std::size_t samplesCount) {
-
+	void generate(SignalSpan<DataType> output)
+	{
 		FieldType normStartFreq = this->m_startFrequency / this->m_sampleFrequency;
 		FieldType normStopFreq = this->m_endFrequency / this->m_sampleFrequency;
 		FieldType normRepeatRate = this->m_sampleFrequency / this->m_frequency;
@@ -106,12 +107,10 @@ public:
 
 		std::size_t samplesPerPeriod = static_cast<std::size_t>(normRepeatRate);
 
-		this->m_data.resize(samplesCount);
-
-		for(std::size_t i = 0; i < samplesCount; i++)
+		for(std::size_t i = 0; i < output.size(); i++)
 		{
 			std::size_t pos = i % samplesPerPeriod;
-			this->m_data[i] = this->m_amplitude * expFun(phaseOffset + 2.0 * M_PI * (normStartFreq * pos + ((k / 2) * pos * pos)));
+			output[i] = this->m_amplitude * expFun(phaseOffset + 2.0 * M_PI * (normStartFreq * pos + ((k / 2) * pos * pos)));
 		}
 	}
 private:
@@ -131,7 +130,7 @@ private:
 template<typename T>
 std::complex<T> ComplexExp(T value)
 {
-	return std::complex<double>(std::cos(value), std::sin(value));
+	return std::complex<T>(std::cos(value), std::sin(value));
 }
 
 /**
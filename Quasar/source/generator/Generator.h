@@ -100,11 +100,29 @@ namespace Quasar
         }
 
         /**
-         * Generates a given number of samples.
+         * Generates a given number of samples into the generator itself.
+         *
+         * Reallocates only when the generator has to grow, so generating
+         * blocks of the same size repeatedly does not touch the heap.
          *
          * @param samplesCount how many samples to generate
          */
-        virtual void generate(std::size_t samplesCount) = 0;
+        virtual void generate(std::size_t samplesCount)
+        {
+            this->m_data.resize(samplesCount);
+            generate(SignalSpan<DataType>(this->m_data.data(), samplesCount));
+        }
+
+        /**
+         * Generates samples into caller-owned memory.
+         *
+         * The generator's own samples are left untouched. Derived classes
+         * implement this method and should bring the base class overloads
+         * into scope with "using GeneratorType::generate;".
+         *
+         * @param output buffer to fill, its size is the number of samples
+         */
+        virtual void generate(SignalSpan<DataType> output) = 0;
 
     protected:
         /**
@@ -39,7 +39,7 @@ namespace Quasar
     /**
      * Pink noise generator using Voss algorithm.
      */
-	GeneratorClassTemplateOpen(DataType RandomData() = &randomDouble)
+	GeneratorClassTemplateOpen(DataType RandomData() = &randomReal<DataType>)
     class PinkNoiseGenerator : public GeneratorType
     {
     public:
@@ -53,15 +53,15 @@ namespace Quasar
         {
         }
 
+        using GeneratorType::generate;
+
         /**
          * Fills the buffer with generated pink noise samples.
          *
-         * @param samplesCount how many samples to generate
+         * @param output buffer to fill, its size is the number of samples
          */
-        void generate(std::size_t samplesCount)
+        void generate(SignalSpan<DataType> output)
         {
-            this->m_data.resize(samplesCount);
-
             // Voss algorithm initialization
             maxKey = 0xFFFF;
             key = 0;
@@ -70,9 +70,9 @@ namespace Quasar
                 whiteSamples[i] = RandomData() - 0.5;
             }
 
-            for (std::size_t i = 0; i < samplesCount; ++i)
+            for (std::size_t i = 0; i < output.size(); ++i)
             {
-                this->m_data[i] = this->m_amplitude * pinkSample();
+                output[i] = this->m_amplitude * pinkSample();
             }
         }
 
@@ -50,19 +50,20 @@ public:
 
 	}
 
+	using GeneratorType::generate;
+
 	/**
 	 * Fills the buffer with generated sine samples.
 	 *
-	 * @param samplesCount how many samples to generate
+	 * @param output buffer to fill, its size is the number of samples
 	 */
-	void generate(std::size_t samplesCount)
+	void generate(SignalSpan<DataType> output)
 	{
-		this->m_data.resize(samplesCount);
 		FieldType normalizedFrequency = this->m_frequency /
 									 static_cast<FieldType>(this->m_sampleFrequency);
-		for (std::size_t i = 0; i < samplesCount; ++i)
+		for (std::size_t i = 0; i < output.size(); ++i)
 		{
-			this->m_data[i] = this->m_amplitude * std::sin(
+			output[i] = this->m_amplitude * std::sin(
 				2.0 * M_PI * normalizedFrequency * i +
 				this->m_phase * 2.0 * M_PI
 			);
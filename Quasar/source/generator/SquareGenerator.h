@@ -64,23 +64,24 @@ namespace Quasar
         {
         }
 
+        using GeneratorType::generate;
+
         /**
          * Fills the buffer with generated square samples.
          *`
-         * @param samplesCount how many samples to generate
+         * @param output buffer to fill, its size is the number of samples
          */
-        void generate(std::size_t samplesCount)
+        void generate(SignalSpan<DataType> output)
         {
-            this->m_data.resize(samplesCount);
             std::size_t samplesPerPeriod = static_cast<std::size_t>(
                 this->m_sampleFrequency / static_cast<FieldType>(this->m_frequency));
             std::size_t positiveLength = static_cast<std::size_t>(m_duty *
                                                                   samplesPerPeriod);
 
-            for (std::size_t i = 0; i < samplesCount; ++i)
+            for (std::size_t i = 0; i < output.size(); ++i)
             {
                 std::size_t t = i % samplesPerPeriod;
-                this->m_data[i] = this->m_amplitude * (t < positiveLength ? 1 : -1);
+                output[i] = this->m_amplitude * (t < positiveLength ? 1 : -1);
             }
         }
 
@@ -50,18 +50,18 @@ namespace Quasar
         {
         }
 
+        using GeneratorType::generate;
+
         /**
          * Fills the buffer with generated triangle wave samples.
          *
          * The default behaviour is to generate a sawtooth wave. To change that
          * to a triangle wave, call setWidth() with some value between 0 and 1.
          *
-         * @param samplesCount how many samples to generate
+         * @param output buffer to fill, its size is the number of samples
          */
-        void generate(std::size_t samplesCount)
+        void generate(SignalSpan<DataType> output)
         {
-            this->m_data.resize(samplesCount);
-
             FieldType dt = 1.0 / this->m_sampleFrequency;
             FieldType period = 1.0 / this->m_frequency;
             FieldType risingLength = m_width * period;
@@ -74,7 +74,7 @@ namespace Quasar
                 (fallingLength != 0) ? (2.0 * this->m_amplitude / fallingLength) : 0;
 
             FieldType t = 0;
-            for (std::size_t i = 0; i < samplesCount; ++i)
+            for (std::size_t i = 0; i < output.size(); ++i)
             {
                 if (t > period)
                 {
@@ -82,11 +82,11 @@ namespace Quasar
                 }
                 if (t < risingLength)
                 {
-                    this->m_data[i] = -this->m_amplitude + t * risingIncrement;
+                    output[i] = -this->m_amplitude + t * risingIncrement;
                 }
                 else
                 {
-                    this->m_data[i] = this->m_amplitude - (t - risingLength) * fallingDecrement;
+                    output[i] = this->m_amplitude - (t - risingLength) * fallingDecrement;
                 }
                 t += dt;
             }
@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * White noise generator.
      */
-	GeneratorClassTemplateOpen(DataType RandomData() = &randomDouble)
+	GeneratorClassTemplateOpen(DataType RandomData() = &randomReal<DataType>)
     class WhiteNoiseGenerator : public GeneratorType
     {
     public:
@@ -51,17 +51,18 @@ namespace Quasar
         {
         }
 
+        using GeneratorType::generate;
+
         /**
          * Fills the buffer with generated white noise samples.
          *
-         * @param samplesCount how many samples to generate
+         * @param output buffer to fill, its size is the number of samples
          */
-        void generate(std::size_t samplesCount)
+        void generate(SignalSpan<DataType> output)
         {
-            this->m_data.resize(samplesCount);
-            for (std::size_t i = 0; i < samplesCount; ++i)
+            for (std::size_t i = 0; i < output.size(); ++i)
             {
-                this->m_data[i] = this->m_amplitude * (RandomData() - 0.5);
+                output[i] = this->m_amplitude * (RandomData() - 0.5);
             }
         }
     };
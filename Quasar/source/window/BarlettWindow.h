@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Barlett (triangular) window.
      */
-	SignalSourceTemplateMod(DataType Abs(DataType) = &std::fabs)
+	WindowTemplateMod(DataType Abs(DataType) = &std::fabs)
     class BarlettWindow : SignalSourceType
     {
     public:
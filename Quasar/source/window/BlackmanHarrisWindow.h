@@ -36,7 +36,7 @@ namespace Quasar
     /**
      * Nuttall window.
      */
-	SignalSourceTemplateMod(DataType Cos(DataType) = &std::cos)
+	WindowTemplateMod(DataType Cos(DataType) = &std::cos)
     class BlackmanHarrisWindow : public SignalSourceType
     {
     public:
@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Nuttall window.
      */
-	SignalSourceTemplateMod(DataType Cos(DataType) = &std::cos)
+	WindowTemplateMod(DataType Cos(DataType) = &std::cos)
     class BlackmanNuttallWindow : public SignalSourceType
     {
     public:
@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Blackman window.
      */
-	SignalSourceTemplateMod(DataType Cos(DataType) = &std::cos)
+	WindowTemplateMod(DataType Cos(DataType) = &std::cos)
     class BlackmanWindow : public SignalSourceType
     {
     public:
@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Cosine window.
      */
-	SignalSourceTemplateMod(DataType Sin(DataType) = &std::sin)
+	WindowTemplateMod(DataType Sin(DataType) = &std::sin)
     class CosineWindow : public SignalSourceType
     {
     public:
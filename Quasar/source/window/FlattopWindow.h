@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Flat-top window.
      */
-	SignalSourceTemplateMod(DataType Cos(DataType) = &std::cos)
+	WindowTemplateMod(DataType Cos(DataType) = &std::cos)
     class FlattopWindow : public SignalSourceType
     {
     public:
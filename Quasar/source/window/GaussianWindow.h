@@ -38,7 +38,7 @@ namespace Quasar
     /**
      * Creates Gaussian window of given size, with optional sigma parameter.
      */
-	SignalSourceTemplateMod(DataType Pow(DataType, DataType) = &std::pow, DataType Exp(DataType) = &std::exp)
+	WindowTemplateMod(DataType Pow(DataType, DataType) = &std::pow, DataType Exp(DataType) = &std::exp)
     class GaussianWindow : public SignalSourceType
     {
     public:
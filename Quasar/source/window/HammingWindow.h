@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Hamming window.
      */
-	SignalSourceTemplateMod(typename FieldType = DataType, DataType Cos(FieldType) = &std::cos)
+	WindowTemplateMod(typename FieldType = DataType, DataType Cos(FieldType) = &std::cos)
     class HammingWindow : public SignalSourceType
     {
     public:
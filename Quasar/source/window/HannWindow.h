@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Hann window.
      */
-	SignalSourceTemplateMod(DataType Cos(DataType) = &std::cos)
+	WindowTemplateMod(DataType Cos(DataType) = &std::cos)
     class HannWindow : public SignalSourceType
     {
     public:
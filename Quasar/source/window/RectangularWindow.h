@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Rectangular window.
      */
-    SignalSourceClass(RectangularWindow)
+    WindowClass(RectangularWindow)
     {
     public:
         /**
@@ -37,7 +37,7 @@ namespace Quasar
     /**
      * Welch window.
      */
-    SignalSourceClass(WelchWindow)
+    WindowClass(WelchWindow)
     {
     public:
         /**
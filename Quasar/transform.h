@@ -33,5 +33,14 @@
 
 #include "transform/Fft.h"
 #include "transform/OouraFft.h"
+#include "transform/OouraDct.h"
+#include "transform/MixedRadixFft.h"
+#include "transform/SimdFft.h"
+#include "transform/FftFactory.h"
+#include "transform/BatchFft.h"
+#include "transform/FourStepFft.h"
+#include "transform/Fft2d.h"
+#include "transform/GoertzelBank.h"
+#include "transform/SlidingDft.h"
 
 #endif // QUASAR_TRANSFORM_H
@@ -0,0 +1,341 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file BatchFft.h
+ *
+ * FFT of many equally sized frames in one call.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_BATCHFFT_H
+#define QUASAR_TRANSFORM_BATCHFFT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../parallel/ThreadPool.h"
+#include "../simd/SimdKernels.h"
+#include "../source/FrameMatrix.h"
+#include "OouraFft.h"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Transforms a batch of frames of the same length.
+     *
+     * DataType selects the transform: std::complex<Real> for the complex
+     * FFT (as OouraFftComplex), Real for the real one, whose spectra are
+     * in Ooura's packed format (as OouraFftReal).
+     *
+     * Frame m of a batch starts at data + m * distance and its samples are
+     * stride elements apart, so rows of a FrameMatrix (distance = stride()
+     * of the matrix, stride = 1) and interleaved channels (distance = 1,
+     * stride = channels count) are both batches. Frames with unit stride
+     * are transformed where they are, others are gathered into a scratch
+     * buffer and scattered back.
+     *
+     * Frames are processed one after another against the same tables,
+     * which stay in cache for the whole batch, instead of being reached
+     * through one transform object per frame. With a ThreadPool, the
+     * batch is split into contiguous blocks of frames, one block per task,
+     * and every task uses its own work area, kept for later calls.
+     *
+     * @verbatim
+     * Quasar::FrameMatrix<> frames;
+     * frames.gather(Quasar::FrameRange<>(signal, 1024, 512), window);
+     * Quasar::BatchFft<double> fft(1024);
+     * fft.fft(frames, &Quasar::ThreadPool::shared());          @endverbatim
+     */
+    template<typename DataType = ComplexType>
+    class BatchFft
+    {
+    public:
+        /**
+         * Prepares the transform.
+         *
+         * @param length frame length, a power of 2
+         * @throw std::invalid_argument for other lengths
+         */
+        explicit BatchFft(std::size_t length):
+            m_length(length),
+            m_plan(),
+            m_ip(),
+            m_scratch(),
+            m_blockIp(),
+            m_blockScratch()
+        {
+            if (length < 2 || (length & (length - 1)) != 0)
+            {
+                throw std::invalid_argument("Batched FFT length must be a power of 2.");
+            }
+            m_plan = OouraPlan<Real>::get(length, !isComplex);
+            m_ip = m_plan->bitReversal();
+        }
+
+        /**
+         * Returns the frame length.
+         *
+         * @return samples in each frame
+         */
+        std::size_t getLength() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Applies the forward FFT to every frame of a batch, in place.
+         *
+         * @param data first sample of the first frame
+         * @param count number of frames
+         * @param distance elements between beginnings of adjacent frames
+         * @param stride elements between adjacent samples of a frame
+         * @param pool threads to use, null to run on the calling thread
+         */
+        void fft(DataType* data, std::size_t count, std::size_t distance,
+                 std::size_t stride = 1, ThreadPool* pool = nullptr)
+        {
+            run(data, count, distance, stride, 1, pool);
+        }
+
+        /**
+         * Applies the inverse FFT to every frame of a batch, in place.
+         *
+         * @param data first sample of the first frame
+         * @param count number of frames
+         * @param distance elements between beginnings of adjacent frames
+         * @param stride elements between adjacent samples of a frame
+         * @param pool threads to use, null to run on the calling thread
+         */
+        void ifft(DataType* data, std::size_t count, std::size_t distance,
+                  std::size_t stride = 1, ThreadPool* pool = nullptr)
+        {
+            run(data, count, distance, stride, -1, pool);
+        }
+
+        /**
+         * Applies the forward FFT to every row of a matrix.
+         *
+         * @param frames matrix with getLength() columns
+         * @param pool threads to use, null to run on the calling thread
+         * @throw std::invalid_argument for a different number of columns
+         */
+        void fft(FrameMatrix<DataType>& frames, ThreadPool* pool = nullptr)
+        {
+            checkColumns(frames);
+            run(frames.data(), frames.rows(), frames.stride(), 1, 1, pool);
+        }
+
+        /**
+         * Applies the inverse FFT to every row of a matrix.
+         *
+         * @param frames matrix with getLength() columns
+         * @param pool threads to use, null to run on the calling thread
+         * @throw std::invalid_argument for a different number of columns
+         */
+        void ifft(FrameMatrix<DataType>& frames, ThreadPool* pool = nullptr)
+        {
+            checkColumns(frames);
+            run(frames.data(), frames.rows(), frames.stride(), 1, -1, pool);
+        }
+
+    private:
+        /**
+         * Precision of the transform.
+         */
+        typedef typename RealOf<DataType>::type Real;
+
+        /**
+         * Whether the frames are complex.
+         */
+        static const bool isComplex = !std::is_same<Real, DataType>::value;
+
+        /**
+         * Work areas of a thread: bit reversal array and gather buffer.
+         */
+        struct WorkArea
+        {
+            AlignedVector<int>* ip;
+            AlignedVector<DataType>* scratch;
+        };
+
+        void checkColumns(const FrameMatrix<DataType>& frames) const
+        {
+            if (frames.columns() != m_length)
+            {
+                throw std::invalid_argument("Frame length does not match the transform.");
+            }
+        }
+
+        /**
+         * Transforms a batch, splitting it between threads if asked to.
+         */
+        void run(DataType* data, std::size_t count, std::size_t distance,
+                 std::size_t stride, int direction, ThreadPool* pool)
+        {
+            if (stride != 1 && m_scratch.size() != m_length)
+            {
+                m_scratch.resize(m_length);
+            }
+            if (!pool || pool->getWorkersCount() == 0 || count < 2)
+            {
+                WorkArea area = {&m_ip, &m_scratch};
+                transformBlock(area, data, 0, count, distance, stride, direction);
+                return;
+            }
+            const std::size_t blocks = std::min(count, 4 * (pool->getWorkersCount() + 1));
+            prepareWork(blocks, stride);
+            pool->parallelFor(blocks, [&] (std::size_t block)
+            {
+                WorkArea area = {&m_blockIp[block], &m_blockScratch[block]};
+                transformBlock(area, data, count * block / blocks,
+                               count * (block + 1) / blocks, distance, stride, direction);
+            });
+        }
+
+        /**
+         * Makes sure there is a work area for each task.
+         *
+         * Work areas are kept between calls, so only the first threaded
+         * call (or one with more tasks or strided frames) allocates.
+         */
+        void prepareWork(std::size_t blocks, std::size_t stride)
+        {
+            if (m_blockIp.size() < blocks)
+            {
+                m_blockIp.resize(blocks, m_plan->bitReversal());
+                m_blockScratch.resize(blocks);
+            }
+            if (stride == 1)
+            {
+                return;
+            }
+            for (std::size_t block = 0; block < blocks; ++block)
+            {
+                if (m_blockScratch[block].size() != m_length)
+                {
+                    m_blockScratch[block].resize(m_length);
+                }
+            }
+        }
+
+        /**
+         * Transforms frames [first, last) of a batch on one thread.
+         */
+        void transformBlock(WorkArea& area, DataType* data, std::size_t first,
+                            std::size_t last, std::size_t distance,
+                            std::size_t stride, int direction) const
+        {
+            for (std::size_t m = first; m < last; ++m)
+            {
+                DataType* frame = data + m * distance;
+                if (stride == 1)
+                {
+                    transform(frame, *area.ip, direction);
+                    continue;
+                }
+                DataType* buffer = area.scratch->data();
+                for (std::size_t i = 0; i < m_length; ++i)
+                {
+                    buffer[i] = frame[i * stride];
+                }
+                transform(buffer, *area.ip, direction);
+                for (std::size_t i = 0; i < m_length; ++i)
+                {
+                    frame[i * stride] = buffer[i];
+                }
+            }
+        }
+
+        /**
+         * Transforms one contiguous complex frame, as OouraFftComplex.
+         */
+        void transform(std::complex<Real>* frame, AlignedVector<int>& ip, int direction) const
+        {
+            Real* a = reinterpret_cast<Real*>(frame);
+            Ooura::cdft(static_cast<int>(2 * m_length), direction, a, ip.data(), tables());
+            if (direction == -1)
+            {
+                const Real scale = Real(1) / static_cast<Real>(m_length);
+                Simd::multiplyPattern(a, 2 * m_length, scale, scale);
+            }
+        }
+
+        /**
+         * Transforms one contiguous real frame, as OouraFftReal.
+         */
+        void transform(Real* frame, AlignedVector<int>& ip, int direction) const
+        {
+            Ooura::rdft(static_cast<int>(m_length), direction, frame, ip.data(), tables());
+            if (direction == -1)
+            {
+                const Real scale = Real(2) / static_cast<Real>(m_length);
+                Simd::multiplyPattern(frame, m_length, scale, scale);
+            }
+        }
+
+        /**
+         * Returns the shared tables, only read for power of 2 lengths.
+         */
+        Real* tables() const
+        {
+            return const_cast<Real*>(m_plan->twiddles().data());
+        }
+
+        /**
+         * Frame length.
+         */
+        std::size_t m_length;
+
+        /**
+         * Shared tables for this length.
+         */
+        std::shared_ptr<const OouraPlan<Real>> m_plan;
+
+        /**
+         * Bit reversal work area of the calling thread.
+         */
+        AlignedVector<int> m_ip;
+
+        /**
+         * Gather buffer of the calling thread, for strided frames.
+         */
+        AlignedVector<DataType> m_scratch;
+
+        /**
+         * Bit reversal work areas of the tasks of threaded calls.
+         */
+        std::vector<AlignedVector<int>> m_blockIp;
+
+        /**
+         * Gather buffers of the tasks of threaded calls.
+         */
+        std::vector<AlignedVector<DataType>> m_blockScratch;
+    };
+}
+
+#endif // QUASAR_TRANSFORM_BATCHFFT_H
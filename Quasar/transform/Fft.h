@@ -32,7 +32,11 @@
 
 #include "../global.h"
 #include "../source/SignalSource.h"
+#include "../source/SignalSpan.h"
+#include "../source/SignalView.h"
+#include <algorithm>
 #include <cstddef>
+#include <stdexcept>
 
 namespace Quasar
 {
@@ -51,6 +55,20 @@ namespace Quasar
      * for the base FFT interface. A derived class should calculate the
      * plan once - in the constructor (based on FFT length). Later calls
      * to fft() / ifft() should reuse the already created plan/cache.
+     *
+     * Besides the in-place transforms, fft() and ifft() have out-of-place
+     * versions reading any source - frames and views included - and
+     * writing into a caller provided buffer, so the input is kept and
+     * does not have to be copied into a new SignalSource first:
+     *
+     * @verbatim
+     * std::vector<Quasar::ComplexType> spectrum(N);
+     * for (auto frame : frames) {
+     *     fft.fft(frame, Quasar::SignalSpan<Quasar::ComplexType>(spectrum.data(), N));
+     * }                                                            @endverbatim
+     *
+     * Derived classes overriding any fft() or ifft() should bring the
+     * other overloads in with a using declaration.
      */
 	SignalSourceTemplate
     class Fft
@@ -89,8 +107,140 @@ namespace Quasar
          */
         virtual void ifft(SignalSourceType& signal) = 0;
 
+        /**
+         * Applies the forward FFT transform, out of place.
+         *
+         * The default implementation copies the input to the output and
+         * transforms it there. Inputs shorter than the transform length
+         * are zero padded, longer ones are truncated.
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of getLength() samples for the spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSourceType& input, SignalSpan<DataType> output)
+        {
+            copyInput(input, output);
+            SignalSourceTemplatedType(SignalView) view(output);
+            fft(view);
+        }
+
+        /**
+         * Applies the inverse FFT transform, out of place.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output buffer of getLength() samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSourceType& spectrum, SignalSpan<DataType> output)
+        {
+            copyInput(spectrum, output);
+            SignalSourceTemplatedType(SignalView) view(output);
+            ifft(view);
+        }
+
+        /**
+         * Applies the forward FFT transform, out of place.
+         *
+         * @param input input signal, left unchanged
+         * @param output source for the spectrum, resized to getLength()
+         *        samples when its length differs
+         * @throw std::invalid_argument if the source can not be resized,
+         *        e.g. a shorter SignalView
+         */
+        void fft(const SignalSourceType& input, SignalSourceType& output)
+        {
+            fft(input, outputSpan(output));
+        }
+
+        /**
+         * Applies the inverse FFT transform, out of place.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output source for the signal, resized to getLength()
+         *        samples when its length differs
+         * @throw std::invalid_argument if the source can not be resized
+         */
+        void ifft(const SignalSourceType& spectrum, SignalSourceType& output)
+        {
+            ifft(spectrum, outputSpan(output));
+        }
+
+        /**
+         * Returns the transform length.
+         *
+         * @return signal and spectrum length
+         */
+        std::size_t getLength() const
+        {
+            return N;
+        }
+
 
     protected:
+        /**
+         * Checks the size of a caller provided buffer.
+         *
+         * @param size elements in the buffer
+         * @param required elements the transform writes
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        static void checkLength(std::size_t size, std::size_t required)
+        {
+            if (size < required)
+            {
+                throw std::invalid_argument("Buffer too short for the transform.");
+            }
+        }
+
+        /**
+         * Copies the first N samples of a source, zero padding short ones.
+         *
+         * Every out-of-place transform starts here, so the length of the
+         * output is checked once for all of them.
+         *
+         * @param input source to copy
+         * @param output buffer of N samples
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        void copyInput(const SignalSourceType& input, SignalSpan<DataType> output) const
+        {
+            checkLength(output.size(), N);
+            const std::size_t count = std::min(N, input.getSamplesCount());
+            if (input.isContiguous())
+            {
+                const DataType* samples = input.toArray();
+                if (samples != output.data())
+                {
+                    std::copy(samples, samples + count, output.data());
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    output[i] = input.sample(i);
+                }
+            }
+            std::fill(output.data() + count, output.data() + N, DataType());
+        }
+
+        /**
+         * Sizes an output source for the transform.
+         *
+         * @param output destination source
+         * @return span over its samples, N of them unless it could not be
+         *         resized
+         */
+        SignalSpan<DataType> outputSpan(SignalSourceType& output) const
+        {
+            if (output.getSamplesCount() != N)
+            {
+                output.setSamplesCount(N);
+            }
+            return SignalSpan<DataType>(output.writableSamples(), output.getSamplesCount());
+        }
+
         /**
          * Signal and spectrum length.
          */
@@ -0,0 +1,348 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file Fft2d.h
+ *
+ * Two-dimensional complex FFT.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_FFT2D_H
+#define QUASAR_TRANSFORM_FFT2D_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../parallel/ThreadPool.h"
+#include "../simd/SimdKernels.h"
+#include "../source/FrameMatrix.h"
+#include "MixedRadixFft.h"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Complex FFT of a matrix, along its rows and then along its columns.
+     *
+     * Element (r, c) of a rows x columns matrix is at data[r * distance +
+     * c * stride], so row-major matrices (the rows of a FrameMatrix,
+     * stride = 1), column-major ones (distance = 1, stride = rows) and
+     * sub-matrices of larger arrays are all transformed where they are,
+     * with no transpose. Each pass transforms the lines whose samples are
+     * contiguous in place; the lines of the other pass are copied into a
+     * buffer eight at a time, so the matrix is still read and written a
+     * cache line at a time, transformed there and copied back.
+     *
+     * Both lengths may be any number, through the shared plans of
+     * MixedRadixFft, so range and Doppler dimensions need no padding.
+     * With a ThreadPool, each pass is split into contiguous blocks of
+     * lines, one block per task, and every task has its own work area.
+     *
+     * Results follow the conventions of OouraFftComplex in both
+     * dimensions: the forward transform uses exp(+2 pi i (rk / R + cl / C))
+     * and the inverse one is scaled by 1 / (R C). Like the other
+     * transforms, an object must not be used by several threads at once.
+     *
+     * @verbatim
+     * Quasar::FrameMatrix<Quasar::ComplexType> pulses(128, 1000);
+     * Quasar::Fft2d<> fft(128, 1000);
+     * fft.fft(pulses, &Quasar::ThreadPool::shared());              @endverbatim
+     */
+    template<typename Real = double>
+    class Fft2d
+    {
+        static_assert(std::is_same<Real, double>::value || std::is_same<Real, float>::value,
+                      "Fft2d supports float and double precision");
+
+    public:
+        /**
+         * Prepares the transform.
+         *
+         * @param rows number of rows, length of the column transforms
+         * @param columns number of columns, length of the row transforms
+         * @throw std::invalid_argument for an empty matrix
+         */
+        Fft2d(std::size_t rows, std::size_t columns):
+            m_rows(rows),
+            m_columns(columns),
+            m_rowPlan(),
+            m_columnPlan(),
+            m_blockWork()
+        {
+            if (rows == 0 || columns == 0)
+            {
+                throw std::invalid_argument("2-D FFT dimensions must not be 0.");
+            }
+            m_rowPlan = MixedRadixFftPlan<Real>::get(columns);
+            m_columnPlan = MixedRadixFftPlan<Real>::get(rows);
+        }
+
+        /**
+         * Returns the number of rows.
+         *
+         * @return rows of the matrix
+         */
+        std::size_t getRows() const
+        {
+            return m_rows;
+        }
+
+        /**
+         * Returns the number of columns.
+         *
+         * @return columns of the matrix
+         */
+        std::size_t getColumns() const
+        {
+            return m_columns;
+        }
+
+        /**
+         * Applies the forward transform to a matrix, in place.
+         *
+         * @param data element (0, 0) of the matrix
+         * @param distance elements between beginnings of adjacent rows
+         * @param stride elements between adjacent samples of a row
+         * @param pool threads to use, null to run on the calling thread
+         */
+        void fft(std::complex<Real>* data, std::size_t distance, std::size_t stride = 1,
+                 ThreadPool* pool = nullptr)
+        {
+            transform(reinterpret_cast<Real*>(data), distance, stride, 1, pool);
+        }
+
+        /**
+         * Applies the inverse transform to a matrix, in place.
+         *
+         * @param data element (0, 0) of the matrix
+         * @param distance elements between beginnings of adjacent rows
+         * @param stride elements between adjacent samples of a row
+         * @param pool threads to use, null to run on the calling thread
+         */
+        void ifft(std::complex<Real>* data, std::size_t distance, std::size_t stride = 1,
+                  ThreadPool* pool = nullptr)
+        {
+            transform(reinterpret_cast<Real*>(data), distance, stride, -1, pool);
+        }
+
+        /**
+         * Applies the forward transform to a matrix of frames.
+         *
+         * @param frames matrix of getRows() x getColumns() elements
+         * @param pool threads to use, null to run on the calling thread
+         * @throw std::invalid_argument for a different shape
+         */
+        void fft(FrameMatrix<std::complex<Real>>& frames, ThreadPool* pool = nullptr)
+        {
+            checkShape(frames);
+            fft(frames.data(), frames.stride(), 1, pool);
+        }
+
+        /**
+         * Applies the inverse transform to a matrix of frames.
+         *
+         * @param frames matrix of getRows() x getColumns() elements
+         * @param pool threads to use, null to run on the calling thread
+         * @throw std::invalid_argument for a different shape
+         */
+        void ifft(FrameMatrix<std::complex<Real>>& frames, ThreadPool* pool = nullptr)
+        {
+            checkShape(frames);
+            ifft(frames.data(), frames.stride(), 1, pool);
+        }
+
+    private:
+        /**
+         * Lines gathered into the buffer together, so that each row of
+         * the matrix is read a whole cache line at a time.
+         */
+        static const std::size_t width = 8;
+
+        void checkShape(const FrameMatrix<std::complex<Real>>& frames) const
+        {
+            if (frames.rows() != m_rows || frames.columns() != m_columns)
+            {
+                throw std::invalid_argument("Matrix shape does not match the transform.");
+            }
+        }
+
+        /**
+         * Transforms the rows, then the columns, scaling on the way out.
+         */
+        void transform(Real* x, std::size_t distance, std::size_t stride, int direction,
+                       ThreadPool* pool)
+        {
+            const Real scale = (direction < 0) ?
+                Real(1) / static_cast<Real>(m_rows * m_columns) : Real(1);
+            pass(*m_rowPlan, x, m_columns, stride, m_rows, distance, direction, Real(1), pool);
+            pass(*m_columnPlan, x, m_rows, distance, m_columns, stride, direction, scale, pool);
+        }
+
+        /**
+         * Transforms lines of a matrix, splitting them between threads if
+         * asked to.
+         *
+         * @param plan plan of the line length
+         * @param x first element of the first line
+         * @param length samples in each line
+         * @param step elements between adjacent samples of a line
+         * @param lines number of lines
+         * @param distance elements between beginnings of adjacent lines
+         * @param direction 1 for the forward transform, -1 for the inverse
+         * @param scale factor applied to the results
+         * @param pool threads to use, null to run on the calling thread
+         */
+        void pass(const MixedRadixFftPlan<Real>& plan, Real* x, std::size_t length,
+                  std::size_t step, std::size_t lines, std::size_t distance, int direction,
+                  Real scale, ThreadPool* pool)
+        {
+            const bool inPlace = (step == 1);
+            const std::size_t groups = inPlace ? lines : (lines + width - 1) / width;
+            std::size_t blocks = 1;
+            if (pool && pool->getWorkersCount() > 0)
+            {
+                blocks = std::min(groups, 4 * (pool->getWorkersCount() + 1));
+            }
+            prepareWork(blocks);
+            auto run = [&] (std::size_t block)
+            {
+                Real* buffer = m_blockWork[block].data();
+                Real* work = buffer + 2 * width * std::max(m_rows, m_columns);
+                for (std::size_t g = groups * block / blocks; g < groups * (block + 1) / blocks; ++g)
+                {
+                    if (inPlace)
+                    {
+                        Real* a = x + 2 * g * distance;
+                        plan.transform(a, work, direction);
+                        if (scale != Real(1))
+                        {
+                            Simd::multiplyPattern(a, 2 * length, scale, scale);
+                        }
+                        continue;
+                    }
+                    const std::size_t l0 = g * width, count = std::min(width, lines - l0);
+                    gather(x, buffer, length, step, l0, count, distance);
+                    for (std::size_t l = 0; l < count; ++l)
+                    {
+                        plan.transform(buffer + 2 * l * length, work, direction);
+                    }
+                    scatter(buffer, x, length, step, l0, count, distance, scale);
+                }
+            };
+            if (blocks == 1)
+            {
+                run(0);
+                return;
+            }
+            pool->parallelFor(blocks, run);
+        }
+
+        /**
+         * Makes sure there is a buffer and a work area for each task.
+         */
+        void prepareWork(std::size_t blocks)
+        {
+            const std::size_t size = 2 * width * std::max(m_rows, m_columns) +
+                                     std::max(m_rowPlan->workSize(), m_columnPlan->workSize());
+            if (m_blockWork.size() < blocks)
+            {
+                m_blockWork.resize(blocks);
+            }
+            for (std::size_t block = 0; block < blocks; ++block)
+            {
+                if (m_blockWork[block].size() != size)
+                {
+                    m_blockWork[block].resize(size);
+                }
+            }
+        }
+
+        /**
+         * Copies lines [l0, l0 + count) into contiguous rows of the buffer.
+         *
+         * @param x first element of the first line
+         * @param buffer count x length matrix
+         * @param length samples in each line
+         * @param step elements between adjacent samples of a line
+         * @param l0 first line
+         * @param count number of lines, at most width
+         * @param distance elements between beginnings of adjacent lines
+         */
+        static void gather(const Real* x, Real* buffer, std::size_t length, std::size_t step,
+                           std::size_t l0, std::size_t count, std::size_t distance)
+        {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                const Real* in = x + 2 * (i * step + l0 * distance);
+                for (std::size_t l = 0; l < count; ++l)
+                {
+                    buffer[2 * (l * length + i)] = in[2 * l * distance];
+                    buffer[2 * (l * length + i) + 1] = in[2 * l * distance + 1];
+                }
+            }
+        }
+
+        /**
+         * Copies rows of the buffer back into the lines, scaled, the
+         * reverse of gather().
+         */
+        static void scatter(const Real* buffer, Real* x, std::size_t length, std::size_t step,
+                            std::size_t l0, std::size_t count, std::size_t distance, Real scale)
+        {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                Real* out = x + 2 * (i * step + l0 * distance);
+                for (std::size_t l = 0; l < count; ++l)
+                {
+                    out[2 * l * distance] = scale * buffer[2 * (l * length + i)];
+                    out[2 * l * distance + 1] = scale * buffer[2 * (l * length + i) + 1];
+                }
+            }
+        }
+
+        /**
+         * Matrix shape.
+         */
+        std::size_t m_rows, m_columns;
+
+        /**
+         * Shared plans of the row transforms (of length columns) and of
+         * the column transforms (of length rows).
+         */
+        std::shared_ptr<const MixedRadixFftPlan<Real>> m_rowPlan, m_columnPlan;
+
+        /**
+         * Line buffers and work areas of the plans, one per task.
+         */
+        std::vector<AlignedVector<Real>> m_blockWork;
+    };
+
+    template<typename Real>
+    const std::size_t Fft2d<Real>::width;
+}
+
+#endif // QUASAR_TRANSFORM_FFT2D_H
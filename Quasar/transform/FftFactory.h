@@ -0,0 +1,109 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file FftFactory.h
+ *
+ * Creation of FFT objects of the best implementation for a length.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Zbigniew Siciarz, Robert C. Taylor
+ * @date 2007-2016
+ * @since 3.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_FFTFACTORY_H
+#define QUASAR_TRANSFORM_FFTFACTORY_H
+
+#include "../global.h"
+#include "Fft.h"
+#include "MixedRadixFft.h"
+#include "OouraFft.h"
+#include "SimdFft.h"
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * A factory class to manage the creation of FFT calculation objects.
+     *
+     * FFT objects of the same length and precision share their tables
+     * through OouraPlan, so creating one per frame or per thread is
+     * cheap: after the first one, creation is a cache lookup and a copy
+     * of a small work area. The objects themselves are not thread safe,
+     * use one per thread.
+     *
+     * Complex transforms are SimdFft objects when the CPU and the length
+     * allow the vectorized code, OouraFftComplex objects for other powers
+     * of 2 and MixedRadixFft objects for any other length.
+     */
+    class FftFactory
+    {
+    public:
+        /**
+         * Returns a complex FFT object for a given length.
+         *
+         * @param length FFT length
+         * @return FFT object of double precision
+         */
+        static std::shared_ptr<Fft<ComplexType>> getFft(std::size_t length)
+        {
+            return getComplexFft<double>(length);
+        }
+
+        /**
+         * Returns a complex FFT object of a given precision.
+         *
+         * @param length FFT length
+         * @return FFT object transforming std::complex<Real> signals
+         */
+        template<typename Real = double, template<typename ...> class Container_t = std::vector>
+        static std::shared_ptr<Fft<std::complex<Real>, Container_t>> getComplexFft(std::size_t length)
+        {
+            if (SimdFft<Container_t, Real>::isAccelerated(length))
+            {
+                return std::make_shared<SimdFft<Container_t, Real>>(length);
+            }
+            if (length > 0 && (length & (length - 1)) == 0)
+            {
+                return std::make_shared<OouraFftComplex<Container_t, Real>>(length);
+            }
+            return std::make_shared<MixedRadixFft<Container_t, Real>>(length);
+        }
+
+        /**
+         * Returns a real FFT object of a given precision.
+         *
+         * The object is returned with its own type, which also has the
+         * transforms to and from the N / 2 + 1 complex bins of the half
+         * spectrum, and converts to a pointer to Fft<Real, Container_t>.
+         *
+         * @param length FFT length, a power of 2
+         * @return FFT object transforming Real signals
+         */
+        template<typename Real = double, template<typename ...> class Container_t = std::vector>
+        static std::shared_ptr<OouraFftReal<Container_t, Real>> getRealFft(std::size_t length)
+        {
+            return std::make_shared<OouraFftReal<Container_t, Real>>(length);
+        }
+    };
+}
+
+#endif // QUASAR_TRANSFORM_FFTFACTORY_H
@@ -0,0 +1,474 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file FourStepFft.h
+ *
+ * Multithreaded FFT of very long signals.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_FOURSTEPFFT_H
+#define QUASAR_TRANSFORM_FOURSTEPFFT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../parallel/ThreadPool.h"
+#include "Fft.h"
+#include "MixedRadixFft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Complex FFT of long signals, split into sub-transforms which fit
+     * in cache and run in parallel.
+     *
+     * A transform of length N = N1 * N2, with N1 and N2 close to the
+     * square root of N, is computed in the four steps of Bailey's
+     * algorithm, the signal being seen as N1 rows of N2 samples:
+     *
+     *  - the N2 columns of length N1 are transformed,
+     *  - each element is multiplied by a twiddle factor,
+     *  - the N1 rows of length N2 are transformed,
+     *  - the matrix is transposed into the spectrum, in place when it is
+     *    square (N an even power of 2, for instance).
+     *
+     * Every sub-transform works on a contiguous buffer of a few thousand
+     * samples, which stays in L1 or L2 while Ooura's cdft() would stream
+     * the whole signal through the caches at each of its passes. Columns
+     * are copied in and out of that buffer several at a time, and the
+     * transpose goes through tiles, so the matrix is always read and
+     * written a cache line at a time. The whole signal is thus only read
+     * and written three times. Columns, rows and tiles are spread over a
+     * ThreadPool.
+     *
+     * Lengths must have no prime factor above 7. Results follow the
+     * conventions of OouraFftComplex: the forward transform uses
+     * exp(+2 pi i jk / N) and the inverse one is scaled by 1 / N. Like
+     * the other transforms, an object must not be used by several threads
+     * at once, but each call uses all threads of its pool.
+     *
+     * @verbatim
+     * Quasar::FourStepFft<> fft(1 << 22);
+     * fft.fft(signal);                                         @endverbatim
+     */
+    template<template<typename ...> class Container_t = std::vector, typename Real = double>
+    class FourStepFft : public Fft<std::complex<Real>, Container_t>
+    {
+    public:
+        /**
+         * Initializes the transform for a given input length.
+         *
+         * @param length input signal size, without prime factors above 7
+         * @param pool threads running the sub-transforms
+         * @throw std::invalid_argument for other lengths
+         */
+        explicit FourStepFft(std::size_t length, ThreadPool& pool = ThreadPool::shared()):
+            Fft<std::complex<Real>, Container_t>::Fft(length),
+            m_pool(&pool),
+            m_rows(0),
+            m_columns(0),
+            m_rowPlan(),
+            m_columnPlan(),
+            m_coarse(),
+            m_fine(),
+            m_work(),
+            m_blockWork()
+        {
+            if (!MixedRadixFftPlan<Real>::isSmooth(length))
+            {
+                throw std::invalid_argument("Four-step FFT length must have no prime factor above 7.");
+            }
+            // the largest divisor not above the square root of N
+            m_rows = 1;
+            for (std::size_t d = 1; d * d <= length; ++d)
+            {
+                if (length % d == 0)
+                {
+                    m_rows = d;
+                }
+            }
+            m_columns = length / m_rows;
+            m_rowPlan = MixedRadixFftPlan<Real>::get(m_rows);
+            m_columnPlan = MixedRadixFftPlan<Real>::get(m_columns);
+            // exp(2 pi i j / N) for j = c * N1 + f, as a coarse and a fine table
+            m_coarse.resize(2 * m_columns);
+            m_fine.resize(2 * m_rows);
+            const double step = 2.0 * M_PI / static_cast<double>(length);
+            for (std::size_t c = 0; c < m_columns; ++c)
+            {
+                m_coarse[2 * c] = static_cast<Real>(std::cos(step * (c * m_rows)));
+                m_coarse[2 * c + 1] = static_cast<Real>(std::sin(step * (c * m_rows)));
+            }
+            for (std::size_t f = 0; f < m_rows; ++f)
+            {
+                m_fine[2 * f] = static_cast<Real>(std::cos(step * f));
+                m_fine[2 * f + 1] = static_cast<Real>(std::sin(step * f));
+            }
+            if (m_rows != m_columns)
+            {
+                m_work.resize(2 * length);
+            }
+            m_blockWork.resize(blocksCount());
+            for (AlignedVector<Real>& work : m_blockWork)
+            {
+                work.resize(2 * (width * m_rows + m_columns));
+            }
+        }
+
+        /**
+         * Returns the length of the first sub-transforms, N1.
+         *
+         * @return rows of the signal matrix
+         */
+        std::size_t getRows() const
+        {
+            return m_rows;
+        }
+
+        /**
+         * Returns the length of the second sub-transforms, N2.
+         *
+         * @return columns of the signal matrix
+         */
+        std::size_t getColumns() const
+        {
+            return m_columns;
+        }
+
+        /**
+         * Applies the forward transform in place.
+         *
+         * @param signal input signal, replaced by its spectrum
+         */
+        virtual void fft(SignalSource<std::complex<Real>, Container_t>& signal)
+        {
+            transform(signal.toArray(), 1);
+        }
+
+        /**
+         * Applies the inverse transform in place.
+         *
+         * @param spectrum input spectrum, replaced by the signal
+         */
+        virtual void ifft(SignalSource<std::complex<Real>, Container_t>& spectrum)
+        {
+            transform(spectrum.toArray(), -1);
+        }
+
+        /**
+         * Applies the forward transform out of place.
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of N samples for the spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSource<std::complex<Real>, Container_t>& input,
+                         SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(input, output);
+            transform(output.data(), 1);
+        }
+
+        /**
+         * Applies the inverse transform out of place.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSource<std::complex<Real>, Container_t>& spectrum,
+                          SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(spectrum, output);
+            transform(output.data(), -1);
+        }
+
+        using Fft<std::complex<Real>, Container_t>::fft;
+        using Fft<std::complex<Real>, Container_t>::ifft;
+
+    private:
+        /**
+         * Side of the transpose tiles, in complex numbers.
+         */
+        static const std::size_t tile = 32;
+
+        /**
+         * Columns transformed together, so that each row of the matrix
+         * is read a whole cache line at a time.
+         */
+        static const std::size_t width = 8;
+
+        /**
+         * Number of tasks per step, a few per thread to even out the load.
+         */
+        std::size_t blocksCount() const
+        {
+            return std::min(m_rows, 4 * (m_pool->getWorkersCount() + 1));
+        }
+
+        /**
+         * Runs the six steps.
+         *
+         * @param data N complex numbers, transformed in place
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void transform(std::complex<Real>* data, int direction)
+        {
+            Real* x = reinterpret_cast<Real*>(data);
+            const std::size_t n1 = m_rows, n2 = m_columns;
+            const std::size_t blocks = blocksCount();
+            const Real scale = (direction < 0) ? Real(1) / static_cast<Real>(this->N) : Real(1);
+            // columns n2 of length N1, then twiddles w^(n2 k1), a group of columns at a time
+            const std::size_t groups = (n2 + width - 1) / width;
+            m_pool->parallelFor(blocks, [&] (std::size_t block)
+            {
+                Real* buffer = m_blockWork[block].data();
+                Real* work = buffer + 2 * width * n1;
+                for (std::size_t g = groups * block / blocks; g < groups * (block + 1) / blocks; ++g)
+                {
+                    const std::size_t c0 = g * width, count = std::min(width, n2 - c0);
+                    gather(x, buffer, c0, count);
+                    for (std::size_t c = 0; c < count; ++c)
+                    {
+                        Real* a = buffer + 2 * c * n1;
+                        m_rowPlan->transform(a, work, direction);
+                        twiddle(a, c0 + c, direction);
+                    }
+                    scatter(buffer, x, c0, count);
+                }
+            });
+            // rows k1 of length N2
+            m_pool->parallelFor(blocks, [&] (std::size_t block)
+            {
+                Real* work = m_blockWork[block].data();
+                for (std::size_t row = n1 * block / blocks; row < n1 * (block + 1) / blocks; ++row)
+                {
+                    m_columnPlan->transform(x + 2 * row * n2, work, direction);
+                }
+            });
+            if (n1 == n2)
+            {
+                m_pool->parallelFor((n1 + tile - 1) / tile, [&] (std::size_t tileRow)
+                {
+                    transposeSquare(x, n1, tileRow * tile, scale);
+                });
+                return;
+            }
+            Real* t = m_work.data();
+            m_pool->parallelFor(blocks, [&] (std::size_t block)
+            {
+                transpose(x, t, n1, n2, n2 * block / blocks, n2 * (block + 1) / blocks, scale);
+            });
+            m_pool->parallelFor(blocks, [&] (std::size_t block)
+            {
+                const std::size_t first = 2 * this->N * block / blocks;
+                const std::size_t last = 2 * this->N * (block + 1) / blocks;
+                std::copy(t + first, t + last, x + first);
+            });
+        }
+
+        /**
+         * Copies columns [c0, c0 + count) of the signal matrix into
+         * contiguous rows of the buffer.
+         *
+         * @param x N1 x N2 matrix
+         * @param buffer count x N1 matrix
+         * @param c0 first column
+         * @param count number of columns, at most width
+         */
+        void gather(const Real* x, Real* buffer, std::size_t c0, std::size_t count) const
+        {
+            for (std::size_t r = 0; r < m_rows; ++r)
+            {
+                const Real* in = x + 2 * (r * m_columns + c0);
+                for (std::size_t c = 0; c < count; ++c)
+                {
+                    buffer[2 * (c * m_rows + r)] = in[2 * c];
+                    buffer[2 * (c * m_rows + r) + 1] = in[2 * c + 1];
+                }
+            }
+        }
+
+        /**
+         * Copies rows of the buffer back into columns of the matrix, the
+         * reverse of gather().
+         */
+        void scatter(const Real* buffer, Real* x, std::size_t c0, std::size_t count) const
+        {
+            for (std::size_t r = 0; r < m_rows; ++r)
+            {
+                Real* out = x + 2 * (r * m_columns + c0);
+                for (std::size_t c = 0; c < count; ++c)
+                {
+                    out[2 * c] = buffer[2 * (c * m_rows + r)];
+                    out[2 * c + 1] = buffer[2 * (c * m_rows + r) + 1];
+                }
+            }
+        }
+
+        /**
+         * Transposes rows [first, last) of the output, dst = scale * src^T,
+         * tile by tile.
+         *
+         * @param src matrix of rows x columns complex numbers
+         * @param dst matrix of columns x rows complex numbers
+         * @param rows rows of src
+         * @param columns columns of src
+         * @param first first output row (source column)
+         * @param last end of output rows
+         * @param scale factor applied to every element
+         */
+        static void transpose(const Real* src, Real* dst, std::size_t rows, std::size_t columns,
+                              std::size_t first, std::size_t last, Real scale)
+        {
+            for (std::size_t c0 = first; c0 < last; c0 += tile)
+            {
+                const std::size_t c1 = std::min(c0 + tile, last);
+                for (std::size_t r0 = 0; r0 < rows; r0 += tile)
+                {
+                    const std::size_t r1 = std::min(r0 + tile, rows);
+                    for (std::size_t c = c0; c < c1; ++c)
+                    {
+                        Real* out = dst + 2 * c * rows;
+                        for (std::size_t r = r0; r < r1; ++r)
+                        {
+                            out[2 * r] = scale * src[2 * (r * columns + c)];
+                            out[2 * r + 1] = scale * src[2 * (r * columns + c) + 1];
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Transposes a square matrix in place, a = scale * a^T, for the
+         * tiles of one row of tiles and the tiles they are swapped with.
+         *
+         * @param a matrix of size x size complex numbers
+         * @param size rows and columns of the matrix
+         * @param r0 first row of the tile row
+         * @param scale factor applied to every element
+         */
+        static void transposeSquare(Real* a, std::size_t size, std::size_t r0, Real scale)
+        {
+            const std::size_t r1 = std::min(r0 + tile, size);
+            for (std::size_t c0 = r0; c0 < size; c0 += tile)
+            {
+                const std::size_t c1 = std::min(c0 + tile, size);
+                for (std::size_t r = r0; r < r1; ++r)
+                {
+                    // the diagonal tile is swapped above its diagonal only
+                    for (std::size_t c = (c0 == r0) ? r : c0; c < c1; ++c)
+                    {
+                        Real* p = a + 2 * (r * size + c);
+                        Real* q = a + 2 * (c * size + r);
+                        const Real re = p[0], im = p[1];
+                        p[0] = scale * q[0];
+                        p[1] = scale * q[1];
+                        if (p != q)
+                        {
+                            q[0] = scale * re;
+                            q[1] = scale * im;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Multiplies transformed column n2 by w^(n2 k1).
+         *
+         * @param a N1 complex numbers
+         * @param column column index n2
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void twiddle(Real* a, std::size_t column, int direction) const
+        {
+            const std::size_t n1 = m_rows;
+            const Real sign = static_cast<Real>(direction);
+            const std::size_t stepCoarse = column / n1, stepFine = column % n1;
+            // j = n2 * k1 = c * N1 + f
+            std::size_t c = 0, f = 0;
+            for (std::size_t k = 0; k < n1; ++k)
+            {
+                const Real cRe = m_coarse[2 * c], cIm = sign * m_coarse[2 * c + 1];
+                const Real fRe = m_fine[2 * f], fIm = sign * m_fine[2 * f + 1];
+                const Real wRe = cRe * fRe - cIm * fIm, wIm = cRe * fIm + cIm * fRe;
+                const Real re = a[2 * k], im = a[2 * k + 1];
+                a[2 * k] = re * wRe - im * wIm;
+                a[2 * k + 1] = re * wIm + im * wRe;
+                c += stepCoarse;
+                f += stepFine;
+                if (f >= n1)
+                {
+                    f -= n1;
+                    ++c;
+                }
+            }
+        }
+
+        /**
+         * Threads running the steps.
+         */
+        ThreadPool* m_pool;
+
+        /**
+         * Matrix shape, N1 x N2 with N1 <= N2.
+         */
+        std::size_t m_rows, m_columns;
+
+        /**
+         * Shared plans of the sub-transforms of lengths N1 and N2.
+         */
+        std::shared_ptr<const MixedRadixFftPlan<Real>> m_rowPlan, m_columnPlan;
+
+        /**
+         * exp(2 pi i c N1 / N) for c < N2 and exp(2 pi i f / N) for f < N1.
+         */
+        AlignedVector<Real> m_coarse, m_fine;
+
+        /**
+         * Transposed spectrum, when the matrix is not square.
+         */
+        AlignedVector<Real> m_work;
+
+        /**
+         * Column buffers and work areas of the sub-transforms, one per task.
+         */
+        std::vector<AlignedVector<Real>> m_blockWork;
+    };
+
+    template<template<typename ...> class Container_t, typename Real>
+    const std::size_t FourStepFft<Container_t, Real>::tile;
+
+    template<template<typename ...> class Container_t, typename Real>
+    const std::size_t FourStepFft<Container_t, Real>::width;
+}
+
+#endif // QUASAR_TRANSFORM_FOURSTEPFFT_H
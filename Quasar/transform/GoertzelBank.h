@@ -0,0 +1,339 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file GoertzelBank.h
+ *
+ * A few DFT bins of consecutive blocks, computed with Goertzel's algorithm.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_GOERTZELBANK_H
+#define QUASAR_TRANSFORM_GOERTZELBANK_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/GoertzelKernels.h"
+#include "../source/SignalSource.h"
+#include "../source/SignalSpan.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Computes selected bins of the DFT of consecutive blocks of a stream.
+     *
+     * Each block of getLength() samples yields one value per bin, equal
+     * to bin k of OouraFftComplex (or OouraFftReal) applied to the block:
+     * the sum of x[j] exp(2 pi i jk / N). Bins need not be integers, so
+     * a bank can sit exactly on tones between FFT bins.
+     *
+     * Samples are pushed in blocks of any size and every completed block
+     * is passed to a callback, without buffering or framing the samples:
+     * each sample updates the second order recurrence of every bin once,
+     * with the bins spread across SIMD registers, and one complex
+     * multiplication per bin finishes a block. The recurrence is
+     * Goertzel's in Reinsch's form, which stays accurate for bins near 0
+     * and N / 2, also in single precision. For a handful of bins this
+     * takes far fewer operations than a full transform of the block.
+     *
+     * @verbatim
+     * Quasar::GoertzelBank<> bank({697, 770, 852, 941}, 8000, 205);
+     * bank.push(block, blockSize, [&] (Quasar::SignalSpan<const Quasar::ComplexType> bins) {
+     *     levels = std::norm(bins[0]);
+     * });                                                            @endverbatim
+     */
+    template<typename Real = double>
+    class GoertzelBank
+    {
+        static_assert(std::is_same<Real, double>::value || std::is_same<Real, float>::value,
+                      "GoertzelBank supports float and double precision");
+
+    public:
+        /**
+         * Creates a bank of bins given as DFT indices.
+         *
+         * @param bins bin indices, in cycles per block, not necessarily integer
+         * @param length samples in each block
+         * @throw std::invalid_argument for zero length
+         */
+        GoertzelBank(const std::vector<double>& bins, std::size_t length):
+            m_length(length),
+            m_count(bins.size()),
+            m_filled(0),
+            m_coefficients(),
+            m_s(),
+            m_d(),
+            m_finish(),
+            m_bins(bins.size())
+        {
+            initialize(bins);
+        }
+
+        /**
+         * Creates a bank of bins given as frequencies.
+         *
+         * @param frequencies frequencies of the bins in Hz
+         * @param sampleFrequency sample frequency of the stream in Hz
+         * @param length samples in each block
+         * @throw std::invalid_argument for zero length or sample frequency
+         */
+        GoertzelBank(const std::vector<FrequencyType>& frequencies,
+                     FrequencyType sampleFrequency, std::size_t length):
+            m_length(length),
+            m_count(frequencies.size()),
+            m_filled(0),
+            m_coefficients(),
+            m_s(),
+            m_d(),
+            m_finish(),
+            m_bins(frequencies.size())
+        {
+            if (!(sampleFrequency > 0))
+            {
+                throw std::invalid_argument("Sample frequency must be positive.");
+            }
+            std::vector<double> bins(frequencies.size());
+            for (std::size_t b = 0; b < bins.size(); ++b)
+            {
+                bins[b] = frequencies[b] * static_cast<double>(length) / sampleFrequency;
+            }
+            initialize(bins);
+        }
+
+        /**
+         * Pushes a block of samples, emitting all blocks it completes.
+         *
+         * @param samples pointer to the samples
+         * @param count number of samples
+         * @param onBlock callable taking SignalSpan<const std::complex<Real>>,
+         *                the bins of a completed block
+         */
+        template<typename Callback>
+        void push(const Real* samples, std::size_t count, Callback&& onBlock)
+        {
+            while (count > 0)
+            {
+                const std::size_t n = std::min(count, m_length - m_filled);
+                Simd::goertzel(samples, n, m_s.size(), m_coefficients.data(),
+                               m_s.data(), m_d.data());
+                samples += n;
+                count -= n;
+                m_filled += n;
+                if (m_filled == m_length)
+                {
+                    finish();
+                    onBlock(getBins());
+                }
+            }
+        }
+
+        /**
+         * Pushes a span of samples, emitting all blocks it completes.
+         *
+         * @param samples block of samples
+         * @param onBlock callable taking SignalSpan<const std::complex<Real>>
+         */
+        template<typename Callback>
+        void push(SignalSpan<const Real> samples, Callback&& onBlock)
+        {
+            push(samples.data(), samples.size(), onBlock);
+        }
+
+        /**
+         * Pushes all samples of a source, emitting all blocks they complete.
+         *
+         * @param source block of samples
+         * @param onBlock callable taking SignalSpan<const std::complex<Real>>
+         */
+        template<template<typename ...> class Container_t, typename Callback>
+        void push(const SignalSource<Real, Container_t>& source, Callback&& onBlock)
+        {
+            if (source.isContiguous())
+            {
+                push(source.toArray(), source.getSamplesCount(), onBlock);
+                return;
+            }
+            const std::size_t block = 256;
+            Real buffer[block];
+            const std::size_t length = source.getSamplesCount();
+            for (std::size_t offset = 0; offset < length; offset += block)
+            {
+                const std::size_t count = std::min(block, length - offset);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    buffer[i] = source.sample(offset + i);
+                }
+                push(buffer, count, onBlock);
+            }
+        }
+
+        /**
+         * Drops the samples pushed towards the next block.
+         */
+        void reset()
+        {
+            m_filled = 0;
+            std::fill(m_s.begin(), m_s.end(), Real(0));
+            std::fill(m_d.begin(), m_d.end(), Real(0));
+        }
+
+        /**
+         * Returns the bins of the last completed block, zeros before the
+         * first one.
+         *
+         * @return one value per bin, in the order given to the constructor
+         */
+        SignalSpan<const std::complex<Real>> getBins() const
+        {
+            return SignalSpan<const std::complex<Real>>(m_bins.data(), m_bins.size());
+        }
+
+        /**
+         * Returns number of samples in each block.
+         *
+         * @return block length
+         */
+        std::size_t getLength() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Returns number of bins of the bank.
+         *
+         * @return bins count
+         */
+        std::size_t getBinsCount() const
+        {
+            return m_count;
+        }
+
+        /**
+         * Returns number of samples pushed towards the next block.
+         *
+         * @return samples count
+         */
+        std::size_t getBufferedCount() const
+        {
+            return m_filled;
+        }
+
+    private:
+        /**
+         * Prepares the coefficients, in double precision.
+         */
+        void initialize(const std::vector<double>& bins)
+        {
+            if (m_length == 0)
+            {
+                throw std::invalid_argument("DFT length must be positive.");
+            }
+            const std::size_t padded = (m_count + Simd::binsAlignment - 1) /
+                                       Simd::binsAlignment * Simd::binsAlignment;
+            m_coefficients.assign(2 * padded, Real(0));
+            m_s.assign(padded, Real(0));
+            m_d.assign(padded, Real(0));
+            m_finish.resize(4 * m_count);
+            const double length = static_cast<double>(m_length);
+            for (std::size_t b = 0; b < m_count; ++b)
+            {
+                const double omega = 2.0 * M_PI * bins[b] / length;
+                const double half = 0.5 * omega;
+                const bool positive = std::cos(omega) >= 0;
+                const double k = positive ? -4.0 * std::sin(half) * std::sin(half)
+                                          : 4.0 * std::cos(half) * std::cos(half);
+                // exp(i omega N), 1 for integer bins
+                const double turn = 2.0 * M_PI * (bins[b] - std::floor(bins[b]));
+                m_coefficients[b] = static_cast<Real>(k);
+                m_coefficients[padded + b] = positive ? Real(1) : Real(-1);
+                m_finish[4 * b] = static_cast<Real>(0.5 * k);
+                m_finish[4 * b + 1] = static_cast<Real>(std::sin(omega));
+                m_finish[4 * b + 2] = static_cast<Real>(std::cos(turn));
+                m_finish[4 * b + 3] = static_cast<Real>(std::sin(turn));
+            }
+        }
+
+        /**
+         * Turns the recurrences into bins and restarts them.
+         *
+         * With s = s[N - 1] and d = s[N - 1] - sigma s[N - 2], the sum of
+         * x[j] exp(-i omega (N - 1 - j)) is sigma d + k / 2 s - i sin(omega) s,
+         * which is rotated by exp(i omega N) to start at x[0].
+         */
+        void finish()
+        {
+            const Real* sigma = m_coefficients.data() + m_s.size();
+            for (std::size_t b = 0; b < m_count; ++b)
+            {
+                const Real* f = &m_finish[4 * b];
+                const Real re = sigma[b] * m_d[b] + f[0] * m_s[b];
+                const Real im = -f[1] * m_s[b];
+                m_bins[b] = std::complex<Real>(f[2] * re - f[3] * im, f[2] * im + f[3] * re);
+            }
+            reset();
+        }
+
+        /**
+         * Samples in each block.
+         */
+        std::size_t m_length;
+
+        /**
+         * Number of bins.
+         */
+        std::size_t m_count;
+
+        /**
+         * Samples pushed towards the next block.
+         */
+        std::size_t m_filled;
+
+        /**
+         * Rows of k and sigma of the bins, see Simd::goertzelLoop(), each
+         * padded to Simd::binsAlignment.
+         */
+        AlignedVector<Real> m_coefficients;
+
+        /**
+         * States of the recurrence of each bin.
+         */
+        AlignedVector<Real> m_s, m_d;
+
+        /**
+         * k / 2, sin(omega) and exp(i omega N) of each bin, interleaved.
+         */
+        AlignedVector<Real> m_finish;
+
+        /**
+         * Bins of the last completed block.
+         */
+        AlignedVector<std::complex<Real>> m_bins;
+    };
+}
+
+#endif // QUASAR_TRANSFORM_GOERTZELBANK_H
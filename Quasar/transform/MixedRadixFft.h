@@ -0,0 +1,540 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file MixedRadixFft.h
+ *
+ * Complex FFT of any length.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_MIXEDRADIXFFT_H
+#define QUASAR_TRANSFORM_MIXEDRADIXFFT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/FftKernels.h"
+#include "../simd/SimdKernels.h"
+#include "Fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Tables of MixedRadixFft for one length, shared by all transforms of
+     * that length and precision.
+     *
+     * Lengths whose prime factors are all 2, 3, 5 or 7 are split into
+     * radix 4, 3, 5, 7 and 2 passes. Other lengths use Bluestein's
+     * algorithm: the transform is rewritten as a circular convolution
+     * with a chirp, computed with transforms of a power of 2 length
+     * M >= 2N - 1, whose plan this plan holds.
+     */
+    template<typename Real = double>
+    class MixedRadixFftPlan
+    {
+    public:
+        /**
+         * Builds the tables, in double precision.
+         *
+         * @param length transform length, at least 1
+         */
+        explicit MixedRadixFftPlan(std::size_t length):
+            m_length(length),
+            m_factors(),
+            m_forward(),
+            m_inverse(),
+            m_firstForward(),
+            m_firstInverse(),
+            m_convolution(),
+            m_chirp(),
+            m_kernel()
+        {
+            if (isSmooth(length))
+            {
+                factorize();
+                m_forward.resize(2 * length);
+                m_inverse.resize(2 * length);
+                const double step = 2.0 * M_PI / static_cast<double>(length);
+                for (std::size_t j = 0; j < length; ++j)
+                {
+                    const double c = std::cos(step * j), s = std::sin(step * j);
+                    m_forward[2 * j] = static_cast<Real>(c);
+                    m_forward[2 * j + 1] = static_cast<Real>(s);
+                    m_inverse[2 * j] = static_cast<Real>(c);
+                    m_inverse[2 * j + 1] = static_cast<Real>(-s);
+                }
+                if (!m_factors.empty() && m_factors[0] == 4)
+                {
+                    prepareFirstPass();
+                }
+            }
+            else
+            {
+                prepareBluestein();
+            }
+        }
+
+        /**
+         * Returns the shared plan for a length, building it on first use.
+         *
+         * @param length transform length, at least 1
+         * @return the plan
+         */
+        static std::shared_ptr<const MixedRadixFftPlan> get(std::size_t length)
+        {
+            static std::mutex mutex;
+            static std::map<std::size_t, std::shared_ptr<const MixedRadixFftPlan>> plans;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const auto found = plans.find(length);
+                if (found != plans.end())
+                {
+                    return found->second;
+                }
+            }
+            // built unlocked, as Bluestein plans get the plan of their convolution
+            std::shared_ptr<const MixedRadixFftPlan> plan = std::make_shared<const MixedRadixFftPlan>(length);
+            std::lock_guard<std::mutex> lock(mutex);
+            return plans.insert(std::make_pair(length, plan)).first->second;
+        }
+
+        /**
+         * Checks whether a length has no prime factor above 7.
+         *
+         * @param length transform length
+         * @return false if Bluestein's algorithm is needed
+         */
+        static bool isSmooth(std::size_t length)
+        {
+            if (length == 0)
+            {
+                return false;
+            }
+            const std::size_t primes[] = {2, 3, 5, 7};
+            for (std::size_t prime : primes)
+            {
+                while (length % prime == 0)
+                {
+                    length /= prime;
+                }
+            }
+            return length == 1;
+        }
+
+        /**
+         * Returns the transform length.
+         *
+         * @return length in complex samples
+         */
+        std::size_t length() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Checks whether transforms go through Bluestein's algorithm.
+         *
+         * @return true for lengths with a prime factor above 7
+         */
+        bool isBluestein() const
+        {
+            return static_cast<bool>(m_convolution);
+        }
+
+        /**
+         * Returns the radices of the passes, in order.
+         *
+         * @return radices, empty for Bluestein plans
+         */
+        const std::vector<std::size_t>& factors() const
+        {
+            return m_factors;
+        }
+
+        /**
+         * Returns the size of the work area of transform().
+         *
+         * @return number of Real elements
+         */
+        std::size_t workSize() const
+        {
+            return m_convolution ? 4 * m_convolution->length() : 2 * m_length;
+        }
+
+        /**
+         * Runs a transform without scaling. The plan is only read, so
+         * threads may share it as long as each has its own work area.
+         *
+         * @param data N complex numbers, transformed in place
+         * @param work work area of workSize() elements
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void transform(Real* data, Real* work, int direction) const
+        {
+            if (m_convolution)
+            {
+                bluestein(data, work, direction);
+                return;
+            }
+            const Real* w = (direction > 0) ? m_forward.data() : m_inverse.data();
+            const Real sign = static_cast<Real>(direction);
+            Real* x = data;
+            Real* y = work;
+            std::size_t n = m_length, s = 1;
+            for (std::size_t r : m_factors)
+            {
+                if (s == 1 && r == 4)
+                {
+                    const Real* t = (direction > 0) ? m_firstForward.data() : m_firstInverse.data();
+                    Simd::radix4FirstPass(n, x, y, w, t, sign);
+                }
+                else if (r == 4)
+                {
+                    Simd::radix4Pass(n, s, x, y, w, sign);
+                }
+                else if (r == 2 && n == 2)
+                {
+                    Simd::radix2Pass(s, x, y);
+                }
+                else
+                {
+                    Simd::radixPassLoop(r, n, s, x, y, w);
+                }
+                std::swap(x, y);
+                n /= r;
+                s *= r;
+            }
+            if (x != data)
+            {
+                std::copy(x, x + 2 * m_length, data);
+            }
+        }
+
+    private:
+        /**
+         * Splits a smooth length into radices, fours first so the radix-4
+         * passes get strides which fill registers, a two last so it is
+         * the twiddle free final pass.
+         */
+        void factorize()
+        {
+            std::size_t rest = m_length;
+            while (rest % 4 == 0)
+            {
+                m_factors.push_back(4);
+                rest /= 4;
+            }
+            const bool two = (rest % 2 == 0);
+            if (two)
+            {
+                rest /= 2;
+            }
+            const std::size_t odd[] = {3, 5, 7};
+            for (std::size_t prime : odd)
+            {
+                while (rest % prime == 0)
+                {
+                    m_factors.push_back(prime);
+                    rest /= prime;
+                }
+            }
+            if (two)
+            {
+                m_factors.push_back(2);
+            }
+        }
+
+        /**
+         * Builds the twiddles of a first radix-4 pass, w^p, w^2p and w^3p,
+         * each contiguous in p, for Simd::radix4FirstPass().
+         */
+        void prepareFirstPass()
+        {
+            const std::size_t n4 = m_length / 4;
+            m_firstForward.resize(6 * n4);
+            m_firstInverse.resize(6 * n4);
+            for (std::size_t k = 1; k <= 3; ++k)
+            {
+                for (std::size_t p = 0; p < n4; ++p)
+                {
+                    const std::size_t from = 2 * (k * p), to = 2 * ((k - 1) * n4 + p);
+                    m_firstForward[to] = m_forward[from];
+                    m_firstForward[to + 1] = m_forward[from + 1];
+                    m_firstInverse[to] = m_inverse[from];
+                    m_firstInverse[to + 1] = m_inverse[from + 1];
+                }
+            }
+        }
+
+        /**
+         * Builds the chirp and the convolution kernel.
+         */
+        void prepareBluestein()
+        {
+            const std::size_t length = m_length;
+            std::size_t m = 1;
+            while (m < 2 * length - 1)
+            {
+                m <<= 1;
+            }
+            m_convolution = get(m);
+            m_chirp.resize(2 * length);
+            for (std::size_t n = 0; n < length; ++n)
+            {
+                // n^2 mod 2N keeps the angle exact for long transforms
+                const std::size_t square = static_cast<std::size_t>(
+                    (static_cast<unsigned long long>(n) * n) % (2 * length));
+                const double angle = M_PI * static_cast<double>(square) / static_cast<double>(length);
+                m_chirp[2 * n] = static_cast<Real>(std::cos(angle));
+                m_chirp[2 * n + 1] = static_cast<Real>(std::sin(angle));
+            }
+            // conjugate chirp at lags -(N - 1) .. N - 1, scaled by 1 / M
+            const Real scale = Real(1) / static_cast<Real>(m);
+            m_kernel.assign(2 * m, Real(0));
+            for (std::size_t n = 0; n < length; ++n)
+            {
+                const Real re = m_chirp[2 * n] * scale, im = -m_chirp[2 * n + 1] * scale;
+                m_kernel[2 * n] = re;
+                m_kernel[2 * n + 1] = im;
+                if (n > 0)
+                {
+                    m_kernel[2 * (m - n)] = re;
+                    m_kernel[2 * (m - n) + 1] = im;
+                }
+            }
+            AlignedVector<Real> work(2 * m);
+            m_convolution->transform(m_kernel.data(), work.data(), 1);
+        }
+
+        /**
+         * Bluestein's algorithm, without scaling. The inverse transform
+         * is the forward one of the conjugate, conjugated.
+         *
+         * @param a N complex numbers, transformed in place
+         * @param work convolution buffer of M complex numbers, followed by
+         *             the work area of its transforms
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void bluestein(Real* a, Real* work, int direction) const
+        {
+            const std::size_t length = m_length, m = m_convolution->length();
+            const Real* chirp = m_chirp.data();
+            const Real* kernel = m_kernel.data();
+            const Real conjugate = static_cast<Real>(direction);
+            Real* b = work;
+            Real* passes = work + 2 * m;
+            for (std::size_t n = 0; n < length; ++n)
+            {
+                const Real re = a[2 * n], im = conjugate * a[2 * n + 1];
+                b[2 * n] = re * chirp[2 * n] - im * chirp[2 * n + 1];
+                b[2 * n + 1] = re * chirp[2 * n + 1] + im * chirp[2 * n];
+            }
+            std::fill(b + 2 * length, b + 2 * m, Real(0));
+            m_convolution->transform(b, passes, 1);
+            for (std::size_t k = 0; k < 2 * m; k += 2)
+            {
+                const Real re = b[k], im = b[k + 1];
+                b[k] = re * kernel[k] - im * kernel[k + 1];
+                b[k + 1] = re * kernel[k + 1] + im * kernel[k];
+            }
+            m_convolution->transform(b, passes, -1);
+            for (std::size_t k = 0; k < length; ++k)
+            {
+                const Real re = b[2 * k], im = b[2 * k + 1];
+                a[2 * k] = re * chirp[2 * k] - im * chirp[2 * k + 1];
+                a[2 * k + 1] = conjugate * (re * chirp[2 * k + 1] + im * chirp[2 * k]);
+            }
+        }
+
+        /**
+         * Transform length.
+         */
+        std::size_t m_length;
+
+        /**
+         * Radices of the passes.
+         */
+        std::vector<std::size_t> m_factors;
+
+        /**
+         * Roots of unity of the forward and inverse transforms.
+         */
+        AlignedVector<Real> m_forward, m_inverse;
+
+        /**
+         * Twiddles of a first radix-4 pass, see prepareFirstPass().
+         */
+        AlignedVector<Real> m_firstForward, m_firstInverse;
+
+        /**
+         * Plan of the convolution, for Bluestein plans.
+         */
+        std::shared_ptr<const MixedRadixFftPlan> m_convolution;
+
+        /**
+         * Chirp and convolution kernel, for Bluestein plans.
+         */
+        AlignedVector<Real> m_chirp, m_kernel;
+    };
+
+    /**
+     * Complex FFT of any length.
+     *
+     * Lengths such as 480, 1000 or 1536 are transformed directly, with
+     * Stockham passes of radix 4, 2, 3, 5 and 7 (the radix-4 ones are
+     * vectorized as in SimdFft), instead of being zero padded to the next
+     * power of 2, which changes the bin spacing. Lengths with a larger
+     * prime factor, primes included, use Bluestein's algorithm, about
+     * three transforms of length M >= 2N - 1 each.
+     *
+     * Results follow the conventions of OouraFftComplex: the forward
+     * transform uses exp(+2 pi i jk / N) and the inverse one is scaled
+     * by 1 / N. OouraFftComplex or SimdFft are faster for powers of 2,
+     * FftFactory picks the right one.
+     *
+     * Like the other transforms, an object must not be used by several
+     * threads at once; objects of the same length share their tables.
+     */
+    template<template<typename ...> class Container_t = std::vector, typename Real = double>
+    class MixedRadixFft : public Fft<std::complex<Real>, Container_t>
+    {
+    public:
+        /**
+         * Initializes the transform for a given input length.
+         *
+         * @param length input signal size, at least 1
+         * @throw std::invalid_argument for an empty transform
+         */
+        explicit MixedRadixFft(std::size_t length):
+            Fft<std::complex<Real>, Container_t>::Fft(length),
+            m_plan(),
+            m_work()
+        {
+            if (length == 0)
+            {
+                throw std::invalid_argument("FFT length must not be 0.");
+            }
+            m_plan = MixedRadixFftPlan<Real>::get(length);
+            m_work.resize(m_plan->workSize());
+        }
+
+        /**
+         * Checks whether this transform uses Bluestein's algorithm.
+         *
+         * @return true for lengths with a prime factor above 7
+         */
+        bool isBluestein() const
+        {
+            return m_plan->isBluestein();
+        }
+
+        /**
+         * Applies the forward transform in place.
+         *
+         * @param signal input signal, replaced by its spectrum
+         */
+        virtual void fft(SignalSource<std::complex<Real>, Container_t>& signal)
+        {
+            transform(signal.toArray(), 1);
+        }
+
+        /**
+         * Applies the inverse transform in place.
+         *
+         * @param spectrum input spectrum, replaced by the signal
+         */
+        virtual void ifft(SignalSource<std::complex<Real>, Container_t>& spectrum)
+        {
+            transform(spectrum.toArray(), -1);
+        }
+
+        /**
+         * Applies the forward transform out of place.
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of N samples for the spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSource<std::complex<Real>, Container_t>& input,
+                         SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(input, output);
+            transform(output.data(), 1);
+        }
+
+        /**
+         * Applies the inverse transform out of place.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSource<std::complex<Real>, Container_t>& spectrum,
+                          SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(spectrum, output);
+            transform(output.data(), -1);
+        }
+
+        using Fft<std::complex<Real>, Container_t>::fft;
+        using Fft<std::complex<Real>, Container_t>::ifft;
+
+    private:
+        /**
+         * Transforms N complex numbers in place.
+         *
+         * @param data signal or spectrum
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void transform(std::complex<Real>* data, int direction)
+        {
+            const std::size_t length = this->N;
+            Real* a = reinterpret_cast<Real*>(data);
+            m_plan->transform(a, m_work.data(), direction);
+            if (direction < 0)
+            {
+                const Real scale = Real(1) / static_cast<Real>(length);
+                Simd::multiplyPattern(a, 2 * length, scale, scale);
+            }
+        }
+
+        /**
+         * Shared tables.
+         */
+        std::shared_ptr<const MixedRadixFftPlan<Real>> m_plan;
+
+        /**
+         * Work area of the plan.
+         */
+        AlignedVector<Real> m_work;
+    };
+}
+
+#endif // QUASAR_TRANSFORM_MIXEDRADIXFFT_H
@@ -0,0 +1,496 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file OouraDct.h
+ *
+ * Orthonormal DCT and DST on top of Ooura's ddct() and ddst().
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_OOURADCT_H
+#define QUASAR_TRANSFORM_OOURADCT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/SimdKernels.h"
+#include "../source/SignalSpan.h"
+#include "OouraFft.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Common part of OouraDct and OouraDst: Ooura's tables for lengths
+     * which are powers of 2, a basis matrix for the other lengths.
+     */
+    template<typename Real = double>
+    class OouraTrigonometricTransform
+    {
+    public:
+        /**
+         * Returns the transform length.
+         *
+         * @return number of samples and of coefficients
+         */
+        std::size_t getLength() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Checks whether Ooura's O(N log N) routines are used.
+         *
+         * @return false if the length is not a power of 2
+         */
+        bool isFast() const
+        {
+            return !ip.empty();
+        }
+
+    protected:
+        /**
+         * Prepares the tables.
+         *
+         * @param length transform length, at least 1
+         * @throw std::invalid_argument for an empty transform
+         */
+        explicit OouraTrigonometricTransform(std::size_t length):
+            m_length(length),
+            ip(),
+            w(),
+            m_basis(),
+            m_product(),
+            m_scratch(length)
+        {
+            if (length == 0)
+            {
+                throw std::invalid_argument("Transform length must not be 0.");
+            }
+            if (length < 2 || (length & (length - 1)) != 0)
+            {
+                m_product.resize(length);
+                return;
+            }
+            // the same table set up as done on first use by ddct() and ddst()
+            const int n = static_cast<int>(length);
+            ip.resize(static_cast<std::size_t>(2 + std::sqrt(static_cast<double>(length / 2))));
+            w.resize(length * 5 / 4);
+            const int nw = n >> 2;
+            Ooura::makewt(nw, ip.data(), w.data());
+            Ooura::makect(n, ip.data(), w.data() + nw);
+        }
+
+        /**
+         * Replaces a vector by its product with the basis matrix, or the
+         * transposed one.
+         *
+         * @param data N values
+         * @param transposed true for the inverse transform
+         */
+        void multiplyInPlace(Real* data, bool transposed)
+        {
+            if (transposed)
+            {
+                multiplyTransposed(data, m_product.data());
+            }
+            else
+            {
+                multiply(data, m_product.data(), m_length);
+            }
+            std::copy(m_product.begin(), m_product.end(), data);
+        }
+
+        /**
+         * Multiplies a vector by the first rows of the basis matrix.
+         *
+         * @param input N samples
+         * @param output count results
+         * @param count number of rows, at most N
+         */
+        void multiply(const Real* input, Real* output, std::size_t count) const
+        {
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                const Real* row = m_basis.data() + k * m_length;
+                Real sum = Real(0);
+                for (std::size_t j = 0; j < m_length; ++j)
+                {
+                    sum += row[j] * input[j];
+                }
+                output[k] = sum;
+            }
+        }
+
+        /**
+         * Multiplies a vector by the transposed basis matrix, which for
+         * an orthonormal basis is the inverse transform.
+         *
+         * @param input N coefficients
+         * @param output N samples
+         */
+        void multiplyTransposed(const Real* input, Real* output) const
+        {
+            std::fill(output, output + m_length, Real(0));
+            for (std::size_t k = 0; k < m_length; ++k)
+            {
+                const Real* row = m_basis.data() + k * m_length;
+                for (std::size_t j = 0; j < m_length; ++j)
+                {
+                    output[j] += row[j] * input[k];
+                }
+            }
+        }
+
+        /**
+         * Copies up to N samples into the scratch buffer, zero padding.
+         *
+         * @param input samples to copy
+         * @return the scratch buffer
+         */
+        Real* load(SignalSpan<const Real> input)
+        {
+            const std::size_t count = std::min(m_length, input.size());
+            std::copy(input.data(), input.data() + count, m_scratch.data());
+            std::fill(m_scratch.data() + count, m_scratch.data() + m_length, Real(0));
+            return m_scratch.data();
+        }
+
+        /**
+         * Checks the number of coefficients asked for.
+         *
+         * @param count number of coefficients
+         * @throw std::invalid_argument if above the transform length
+         */
+        void checkCount(std::size_t count) const
+        {
+            if (count > m_length)
+            {
+                throw std::invalid_argument("More coefficients requested than the transform length.");
+            }
+        }
+
+        /**
+         * Checks the size of a buffer receiving a whole signal.
+         *
+         * @param size buffer size
+         * @throw std::invalid_argument if below the transform length
+         */
+        void checkOutput(std::size_t size) const
+        {
+            if (size < m_length)
+            {
+                throw std::invalid_argument("Buffer too short for the transform.");
+            }
+        }
+
+        /**
+         * Transform length.
+         */
+        std::size_t m_length;
+
+        /**
+         * Work area for bit reversal, empty for the matrix fallback.
+         */
+        AlignedVector<int> ip;
+
+        /**
+         * Cos/sin tables of Ooura's routines.
+         */
+        AlignedVector<Real> w;
+
+        /**
+         * Orthonormal basis, one row per coefficient, for the other lengths.
+         */
+        AlignedVector<Real> m_basis;
+
+        /**
+         * Result of the in-place matrix products.
+         */
+        AlignedVector<Real> m_product;
+
+        /**
+         * Buffer of the out-of-place transforms.
+         */
+        AlignedVector<Real> m_scratch;
+    };
+
+    /**
+     * Orthonormal Discrete Cosine Transform, type II, and its inverse,
+     * type III.
+     *
+     * Coefficient k of a signal x of length N is
+     *
+     *   X[k] = c(k) * sum x[j] * cos(pi * (j + 1/2) * k / N),
+     *
+     * with c(0) = sqrt(1 / N) and c(k) = sqrt(2 / N) otherwise, the
+     * scaling of the former experimental Dct. Powers of 2 go through
+     * Ooura's ddct() in O(N log N). Other lengths, such as the outputs of
+     * a mel filter bank, use a cached basis matrix, computing only the
+     * coefficients asked for.
+     *
+     * @verbatim
+     * Quasar::OouraDct<> dct(filters.size());
+     * auto cepstrum = dct.dct(filterOutput, 13);               @endverbatim
+     */
+    template<typename Real = double>
+    class OouraDct : public OouraTrigonometricTransform<Real>
+    {
+    public:
+        /**
+         * Prepares the transform.
+         *
+         * @param length transform length, at least 1
+         * @throw std::invalid_argument for an empty transform
+         */
+        explicit OouraDct(std::size_t length):
+            OouraTrigonometricTransform<Real>(length)
+        {
+            if (this->isFast())
+            {
+                return;
+            }
+            const double c0 = std::sqrt(1.0 / length), cn = std::sqrt(2.0 / length);
+            this->m_basis.resize(length * length);
+            for (std::size_t k = 0; k < length; ++k)
+            {
+                for (std::size_t j = 0; j < length; ++j)
+                {
+                    this->m_basis[k * length + j] = static_cast<Real>(((k == 0) ? c0 : cn) *
+                        std::cos(M_PI * (2 * j + 1) * k / (2.0 * length)));
+                }
+            }
+        }
+
+        /**
+         * Applies the DCT-II in place.
+         *
+         * @param data N samples, replaced by N coefficients
+         */
+        void dct(Real* data)
+        {
+            const std::size_t n = this->m_length;
+            if (!this->isFast())
+            {
+                this->multiplyInPlace(data, false);
+                return;
+            }
+            Ooura::ddct(static_cast<int>(n), -1, data, this->ip.data(), this->w.data());
+            const Real scale = static_cast<Real>(std::sqrt(2.0 / n));
+            Simd::multiplyPattern(data, n, scale, scale);
+            data[0] *= static_cast<Real>(M_SQRT1_2);
+        }
+
+        /**
+         * Applies the inverse transform, DCT-III, in place.
+         *
+         * @param data N coefficients, replaced by N samples
+         */
+        void idct(Real* data)
+        {
+            const std::size_t n = this->m_length;
+            if (!this->isFast())
+            {
+                this->multiplyInPlace(data, true);
+                return;
+            }
+            const Real scale = static_cast<Real>(std::sqrt(2.0 / n));
+            Simd::multiplyPattern(data, n, scale, scale);
+            data[0] *= static_cast<Real>(M_SQRT1_2);
+            Ooura::ddct(static_cast<int>(n), 1, data, this->ip.data(), this->w.data());
+        }
+
+        /**
+         * Computes the first coefficients of a signal.
+         *
+         * @param input up to N samples, zero padded to N
+         * @param output buffer receiving its size() first coefficients
+         * @throw std::invalid_argument if output is longer than N
+         */
+        void dct(SignalSpan<const Real> input, SignalSpan<Real> output)
+        {
+            this->checkCount(output.size());
+            Real* a = this->load(input);
+            if (!this->isFast())
+            {
+                this->multiply(a, output.data(), output.size());
+                return;
+            }
+            dct(a);
+            std::copy(a, a + output.size(), output.data());
+        }
+
+        /**
+         * Computes the first coefficients of a signal.
+         *
+         * @param data up to N samples, zero padded to N
+         * @param outputLength how many coefficients to return
+         * @return vector of DCT coefficients
+         * @throw std::invalid_argument if outputLength is above N
+         */
+        std::vector<Real> dct(const std::vector<Real>& data, std::size_t outputLength)
+        {
+            std::vector<Real> output(outputLength);
+            dct(SignalSpan<const Real>(data.data(), data.size()),
+                SignalSpan<Real>(output.data(), outputLength));
+            return output;
+        }
+
+        /**
+         * Reconstructs a signal from its first coefficients.
+         *
+         * @param input up to N coefficients, the missing ones being 0
+         * @param output buffer of N samples
+         * @throw std::invalid_argument if output is shorter than N
+         */
+        void idct(SignalSpan<const Real> input, SignalSpan<Real> output)
+        {
+            this->checkOutput(output.size());
+            Real* a = this->load(input);
+            idct(a);
+            std::copy(a, a + this->m_length, output.data());
+        }
+    };
+
+    /**
+     * Orthonormal Discrete Sine Transform, type II, and its inverse,
+     * type III.
+     *
+     * Coefficient k of a signal x of length N is
+     *
+     *   X[k] = c(k) * sum x[j] * sin(pi * (j + 1/2) * (k + 1) / N),
+     *
+     * with c(N - 1) = sqrt(1 / N) and c(k) = sqrt(2 / N) otherwise.
+     * Powers of 2 go through Ooura's ddst() in O(N log N), other lengths
+     * use a cached basis matrix.
+     */
+    template<typename Real = double>
+    class OouraDst : public OouraTrigonometricTransform<Real>
+    {
+    public:
+        /**
+         * Prepares the transform.
+         *
+         * @param length transform length, at least 1
+         * @throw std::invalid_argument for an empty transform
+         */
+        explicit OouraDst(std::size_t length):
+            OouraTrigonometricTransform<Real>(length)
+        {
+            if (this->isFast())
+            {
+                return;
+            }
+            const double c = std::sqrt(2.0 / length), cLast = std::sqrt(1.0 / length);
+            this->m_basis.resize(length * length);
+            for (std::size_t k = 0; k < length; ++k)
+            {
+                for (std::size_t j = 0; j < length; ++j)
+                {
+                    this->m_basis[k * length + j] = static_cast<Real>(((k + 1 == length) ? cLast : c) *
+                        std::sin(M_PI * (2 * j + 1) * (k + 1) / (2.0 * length)));
+                }
+            }
+        }
+
+        /**
+         * Applies the DST-II in place.
+         *
+         * @param data N samples, replaced by N coefficients
+         */
+        void dst(Real* data)
+        {
+            const std::size_t n = this->m_length;
+            if (!this->isFast())
+            {
+                this->multiplyInPlace(data, false);
+                return;
+            }
+            Ooura::ddst(static_cast<int>(n), -1, data, this->ip.data(), this->w.data());
+            // ddst() leaves the last coefficient in data[0]
+            std::rotate(data, data + 1, data + n);
+            const Real scale = static_cast<Real>(std::sqrt(2.0 / n));
+            Simd::multiplyPattern(data, n, scale, scale);
+            data[n - 1] *= static_cast<Real>(M_SQRT1_2);
+        }
+
+        /**
+         * Applies the inverse transform, DST-III, in place.
+         *
+         * @param data N coefficients, replaced by N samples
+         */
+        void idst(Real* data)
+        {
+            const std::size_t n = this->m_length;
+            if (!this->isFast())
+            {
+                this->multiplyInPlace(data, true);
+                return;
+            }
+            const Real scale = static_cast<Real>(std::sqrt(2.0 / n));
+            Simd::multiplyPattern(data, n, scale, scale);
+            data[n - 1] *= static_cast<Real>(M_SQRT1_2);
+            std::rotate(data, data + n - 1, data + n);
+            Ooura::ddst(static_cast<int>(n), 1, data, this->ip.data(), this->w.data());
+        }
+
+        /**
+         * Computes the first coefficients of a signal.
+         *
+         * @param input up to N samples, zero padded to N
+         * @param output buffer receiving its size() first coefficients
+         * @throw std::invalid_argument if output is longer than N
+         */
+        void dst(SignalSpan<const Real> input, SignalSpan<Real> output)
+        {
+            this->checkCount(output.size());
+            Real* a = this->load(input);
+            if (!this->isFast())
+            {
+                this->multiply(a, output.data(), output.size());
+                return;
+            }
+            dst(a);
+            std::copy(a, a + output.size(), output.data());
+        }
+
+        /**
+         * Reconstructs a signal from its first coefficients.
+         *
+         * @param input up to N coefficients, the missing ones being 0
+         * @param output buffer of N samples
+         * @throw std::invalid_argument if output is shorter than N
+         */
+        void idst(SignalSpan<const Real> input, SignalSpan<Real> output)
+        {
+            this->checkOutput(output.size());
+            Real* a = this->load(input);
+            idst(a);
+            std::copy(a, a + this->m_length, output.data());
+        }
+    };
+}
+
+#endif // QUASAR_TRANSFORM_OOURADCT_H
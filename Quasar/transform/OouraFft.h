@@ -30,21 +30,192 @@
 #define QUASAR_TRANSFORMS_OOURAFFT_H
 
 #include "Fft.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 namespace Ooura
 {
-
-    void cdft(int, int, double *, int *, double *);
-    void rdft(int, int, double *, int *, double *);
-};
-
+    template<typename Real> void cdft(int, int, Real *, int *, Real *);
+    template<typename Real> void rdft(int, int, Real *, int *, Real *);
+    template<typename Real> void ddct(int, int, Real *, int *, Real *);
+    template<typename Real> void ddst(int, int, Real *, int *, Real *);
+    template<typename Real> void makewt(int nw, int *ip, Real *w);
+    template<typename Real> void makect(int nc, int *ip, Real *c);
+}
 
 namespace Quasar
 {
+    /**
+     * Tables of Ooura's routines for one transform length and precision.
+     *
+     * Plans are built eagerly, so the first transform does not pay for
+     * the cos/sin tables, and are shared through a process wide cache
+     * keyed by length and real/complex input (one cache per precision).
+     * Ooura's routines use the same tables in both directions, so the
+     * direction is not part of the key.
+     *
+     * A plan is immutable once built and may be read by any number of
+     * threads. Each transform still copies the small bit reversal work
+     * area, as Ooura's routines write into it.
+     */
+    template<typename Real = double>
+    class OouraPlan
+    {
+    public:
+        /**
+         * Builds the tables.
+         *
+         * @param length transform length, in complex or real samples
+         * @param realInput true for the real transform
+         * @throw std::invalid_argument if length is not a power of 2
+         */
+        OouraPlan(std::size_t length, bool realInput):
+            m_length(length),
+            m_real(realInput),
+            // according to the description: "length of ip >= 2+sqrt(n/2)"
+            m_ip(static_cast<std::size_t>(2 + std::sqrt(static_cast<double>(realInput ? length / 2 : length)))),
+            m_w(length / 2)
+        {
+            // Ooura's routines write out of bounds for other lengths
+            if (length == 0 || (length & (length - 1)) != 0)
+            {
+                throw std::invalid_argument("Ooura FFT length must be a power of 2.");
+            }
+            m_ip[0] = 0;
+            // the same table set up as done on first use by cdft() and rdft()
+            const int n = static_cast<int>(realInput ? length : 2 * length);
+            int nw = m_ip[0];
+            if (n > (nw << 2))
+            {
+                nw = n >> 2;
+                Ooura::makewt(nw, m_ip.data(), m_w.data());
+            }
+            if (realInput && n > (m_ip[1] << 2))
+            {
+                Ooura::makect(n >> 2, m_ip.data(), m_w.data() + nw);
+            }
+        }
+
+        /**
+         * Returns the shared plan for a transform, building it on first use.
+         *
+         * @param length transform length, in complex or real samples
+         * @param realInput true for the real transform
+         * @return the plan
+         */
+        static std::shared_ptr<const OouraPlan> get(std::size_t length, bool realInput)
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            std::shared_ptr<const OouraPlan>& plan = cache()[std::make_pair(length, realInput)];
+            if (!plan)
+            {
+                plan = std::make_shared<const OouraPlan>(length, realInput);
+            }
+            return plan;
+        }
+
+        /**
+         * Drops all cached plans. Plans still used by transforms stay alive.
+         */
+        static void clearCache()
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            cache().clear();
+        }
+
+        /**
+         * Returns the transform length.
+         *
+         * @return length in complex or real samples
+         */
+        std::size_t getLength() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Checks whether the plan is for the real transform.
+         *
+         * @return true for real input
+         */
+        bool isReal() const
+        {
+            return m_real;
+        }
+
+        /**
+         * Returns the initialized bit reversal work area, to be copied
+         * by each transform.
+         *
+         * @return ip array
+         */
+        const AlignedVector<int>& bitReversal() const
+        {
+            return m_ip;
+        }
+
+        /**
+         * Returns the cos/sin tables.
+         *
+         * @return w array
+         */
+        const AlignedVector<Real>& twiddles() const
+        {
+            return m_w;
+        }
+
+    private:
+        typedef std::map<std::pair<std::size_t, bool>, std::shared_ptr<const OouraPlan>> Cache;
+
+        static Cache& cache()
+        {
+            static Cache plans;
+            return plans;
+        }
+
+        static std::mutex& cacheMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        /**
+         * Transform length.
+         */
+        std::size_t m_length;
+
+        /**
+         * Real or complex transform.
+         */
+        bool m_real;
+
+        /**
+         * Bit reversal work area, with the table sizes in ip[0] and ip[1].
+         */
+        AlignedVector<int> m_ip;
+
+        /**
+         * Cos/sin table, cache line aligned.
+         */
+        AlignedVector<Real> m_w;
+    };
+
     /**
      * A wrapper for the complex FFT algorithm found in Ooura mathematical packages.
+     *
+     * Real selects the precision, OouraFftComplex<std::vector, float>
+     * transforms std::complex<float> signals with single precision tables.
      */
-	template<template<typename ...> class Container_t = std::vector>
-    class OouraFftComplex : public Fft<std::complex<double>, Container_t>
+	template<template<typename ...> class Container_t = std::vector, typename Real = double>
+    class OouraFftComplex : public Fft<std::complex<Real>, Container_t>
     {
     public:
     	/**
@@ -52,24 +223,14 @@ namespace Quasar
     	    *
     	    * Prepares the work area for Ooura's algorithm.
     	    *
-    	    * @param length input signal size (usually a power of 2)
+    	    * @param length input signal size, a power of 2
+    	    * @throw std::invalid_argument if length is not a power of 2
     	    */
     	   OouraFftComplex(std::size_t length):
-    	       Fft<std::complex<double>, Container_t>::Fft(length),
-    	       // according to the description: "length of ip >= 2+sqrt(n)"
-    	       ip(new int[static_cast<std::size_t>(2 + std::sqrt(static_cast<double>(this->N)))]),
-    	       w(new double[this->N / 2])
-    	   {
-    	       ip[0] = 0;
-    	   }
-
-    	   /**
-    	    * Destroys the transform object and cleans up working area.
-    	    */
-    	   ~OouraFftComplex()
+    	       Fft<std::complex<Real>, Container_t>::Fft(length),
+    	       m_plan(OouraPlan<Real>::get(length, false)),
+    	       ip(m_plan->bitReversal())
     	   {
-    	       delete [] w;
-    	       delete [] ip;
     	   }
 
         /**
@@ -78,9 +239,9 @@ namespace Quasar
          * @param spectrum input spectrum
          * @author Robert C. Taylor
          */
-        virtual void ifft(SignalSource<std::complex<double>, Container_t>& spectrum)
+        virtual void ifft(SignalSource<std::complex<Real>, Container_t>& spectrum)
         {
-        	fftInternal(spectrum, -1);
+        	fftInternal(spectrum.toArray(), -1);
         }
 
         /**
@@ -88,51 +249,103 @@ namespace Quasar
 		* @author Robert C. Taylor
 		* @param spectrum input signal to be transformed.
 		*/
-	   virtual void fft(SignalSource<std::complex<double>, Container_t>& spectrum)
+	   virtual void fft(SignalSource<std::complex<Real>, Container_t>& spectrum)
 	   {
-		   fftInternal(spectrum, 1);
+		   fftInternal(spectrum.toArray(), 1);
 	   }
 
+        /**
+         * Applies the transform out of place, reading the input directly.
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of N samples for the spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSource<std::complex<Real>, Container_t>& input,
+                         SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(input, output);
+            fftInternal(output.data(), 1);
+        }
+
+        /**
+         * Applies the inverse transform out of place, reading the input directly.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSource<std::complex<Real>, Container_t>& spectrum,
+                          SignalSpan<std::complex<Real>> output)
+        {
+            this->copyInput(spectrum, output);
+            fftInternal(output.data(), -1);
+        }
 
+        using Fft<std::complex<Real>, Container_t>::fft;
+        using Fft<std::complex<Real>, Container_t>::ifft;
 
     private:
 
-	   void fftInternal(SignalSource<std::complex<double>, Container_t>& spectrum, int direction)
+	   void fftInternal(std::complex<Real>* data, int direction)
 	   {
            static_assert(
-                sizeof(std::complex<double>[2]) == sizeof(double[4]),
-                    "complex<double> has the same memory layout as two consecutive doubles"
+                sizeof(std::complex<Real>[2]) == sizeof(Real[4]),
+                    "complex<Real> has the same memory layout as two consecutive Reals"
             );
 
             // Ooura's function
-            Ooura::cdft(2*this->N, direction, reinterpret_cast<double*>(spectrum.toArray()), ip, w);
+            Ooura::cdft(2*this->N, direction, reinterpret_cast<Real*>(data), ip.data(), tables());
 
             if(direction == -1)
             {
-				spectrum *= 1.0 / static_cast<double>(this->N);
-
+                const Real scale = Real(1) / static_cast<Real>(this->N);
+                Simd::multiplyPattern(reinterpret_cast<Real*>(data), 2 * this->N, scale, scale);
             }
 
 	   }
 
         /**
-         * Work area for bit reversal.
+         * Returns the shared tables, only read for power of 2 lengths.
+         */
+        Real* tables() const
+        {
+            return const_cast<Real*>(m_plan->twiddles().data());
+        }
+
+        /**
+         * Shared tables for this length.
          */
-        int* ip;
+        std::shared_ptr<const OouraPlan<Real>> m_plan;
 
         /**
-         * Cos/sin table.
+         * Work area for bit reversal, copied from the plan.
          */
-        double* w;
+        AlignedVector<int> ip;
     };
 
 
     /**
      * A wrapper for the real FFT algorithm found in Ooura mathematical packages.
      * Does n/2 decimation on the real signal.
+     *
+     * The in-place transforms keep Ooura's packed format: a[2k] and
+     * a[2k + 1] are the real and imaginary parts of bin k, except that
+     * a[1] holds the real part of bin N / 2. The out-of-place fft() and
+     * ifft() taking complex bins work on the half spectrum instead, the
+     * N / 2 + 1 bins as std::complex values, ready for magnitudes or
+     * filter banks:
+     *
+     * @verbatim
+     * std::vector<std::complex<double>> bins(N / 2 + 1);
+     * fft.fft(frame, Quasar::SignalSpan<std::complex<double>>(bins.data(), bins.size()));
+     *                                                              @endverbatim
+     *
+     * Real selects the precision, OouraFftReal<std::vector, float>
+     * transforms float signals with single precision tables.
      */
-	template<template<typename ...> class Container_t = std::vector>
-    class OouraFftReal : public Fft<double, Container_t>
+	template<template<typename ...> class Container_t = std::vector, typename Real = double>
+    class OouraFftReal : public Fft<Real, Container_t>
     {
     public:
 
@@ -141,24 +354,14 @@ namespace Quasar
 		*
 		* Prepares the work area for Ooura's algorithm.
 		*
-		* @param length input signal size (usually a power of 2)
+		* @param length input signal size, a power of 2
+		* @throw std::invalid_argument if length is not a power of 2
 		*/
 	   OouraFftReal(std::size_t length):
-		   Fft<double, Container_t>::Fft(length),
-		   // according to the description: "length of ip >= 2+sqrt(n/2)"
-		   ip(new int[static_cast<std::size_t>(2 + std::sqrt(static_cast<double>(this->N / 2)))]),
-		   w(new double[this->N / 2])
-	   {
-		   ip[0] = 0;
-	   }
-
-	   /**
-		* Destroys the transform object and cleans up working area.
-		*/
-	   ~OouraFftReal()
+		   Fft<Real, Container_t>::Fft(length),
+		   m_plan(OouraPlan<Real>::get(length, true)),
+		   ip(m_plan->bitReversal())
 	   {
-		   delete [] w;
-		   delete [] ip;
 	   }
 
         /**
@@ -167,9 +370,9 @@ namespace Quasar
          * @param spectrum input spectrum
          * @author Robert C. Taylor
          */
-        virtual void ifft(SignalSource<double, Container_t>& spectrum)
+        virtual void ifft(SignalSource<Real, Container_t>& spectrum)
         {
-        	fftInternal(spectrum, -1);
+        	fftInternal(spectrum.toArray(), -1);
         }
 
         /**
@@ -177,33 +380,126 @@ namespace Quasar
 		* @author Robert C. Taylor
 		* @param spectrum input signal to be transformed.
 		*/
-	   virtual void fft(SignalSource<double, Container_t>& spectrum)
+	   virtual void fft(SignalSource<Real, Container_t>& spectrum)
 	   {
-		   fftInternal(spectrum, 1);
+		   fftInternal(spectrum.toArray(), 1);
 	   }
 
-    private:
+        /**
+         * Applies the transform out of place, reading the input directly.
+         *
+         * The spectrum is written in Ooura's packed format, as by the
+         * in-place fft().
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of N samples for the packed spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSource<Real, Container_t>& input, SignalSpan<Real> output)
+        {
+            this->copyInput(input, output);
+            fftInternal(output.data(), 1);
+        }
+
+        /**
+         * Applies the inverse transform out of place, reading the input directly.
+         *
+         * @param spectrum input packed spectrum, left unchanged
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSource<Real, Container_t>& spectrum, SignalSpan<Real> output)
+        {
+            this->copyInput(spectrum, output);
+            fftInternal(output.data(), -1);
+        }
+
+        /**
+         * Applies the transform out of place, writing the half spectrum
+         * as complex bins.
+         *
+         * Bins 0 to N / 2 are written, the others being their complex
+         * conjugates. The input is copied into the spectrum buffer, which
+         * holds N + 2 reals, and transformed there, so the only pass over
+         * the data besides the transform is that copy.
+         *
+         * @param input input signal, left unchanged
+         * @param spectrum buffer of at least N / 2 + 1 bins
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        void fft(const SignalSource<Real, Container_t>& input, SignalSpan<std::complex<Real>> spectrum)
+        {
+            this->checkLength(spectrum.size(), this->N / 2 + 1);
+            Real* a = reinterpret_cast<Real*>(spectrum.data());
+            this->copyInput(input, SignalSpan<Real>(a, this->N));
+            fftInternal(a, 1);
+            // Ooura's packed format keeps the real Nyquist term in a[1]
+            const Real nyquist = a[1];
+            a[1] = Real(0);
+            a[this->N] = nyquist;
+            a[this->N + 1] = Real(0);
+        }
+
+        /**
+         * Applies the inverse transform to a half spectrum, as written by
+         * fft(), writing the real signal.
+         *
+         * The imaginary parts of bins 0 and N / 2 are ignored. The output
+         * may share the memory of the spectrum.
+         *
+         * @param spectrum bins 0 to N / 2, left unchanged unless shared
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if a buffer is too short
+         */
+        void ifft(SignalSpan<const std::complex<Real>> spectrum, SignalSpan<Real> output)
+        {
+            this->checkLength(spectrum.size(), this->N / 2 + 1);
+            this->checkLength(output.size(), this->N);
+            const Real* b = reinterpret_cast<const Real*>(spectrum.data());
+            Real* a = output.data();
+            const Real dc = b[0], nyquist = b[this->N];
+            if (a != b)
+            {
+                std::copy(b + 2, b + this->N, a + 2);
+            }
+            a[0] = dc;
+            a[1] = nyquist;
+            fftInternal(a, -1);
+        }
 
-	   void fftInternal(SignalSource<double, Container_t>& spectrum, int direction)
+        using Fft<Real, Container_t>::fft;
+        using Fft<Real, Container_t>::ifft;
+
+    private:
+	   void fftInternal(Real* data, int direction)
 	   {
 
-           Ooura::rdft(this->N, direction, reinterpret_cast<double*>(spectrum.toArray()), ip, w);
+           Ooura::rdft(this->N, direction, data, ip.data(), tables());
 
            if(direction==-1)
            {
-			   spectrum *= 2.0 / static_cast<double>(this->N);
+               const Real scale = Real(2) / static_cast<Real>(this->N);
+               Simd::multiplyPattern(data, this->N, scale, scale);
            }
 	   }
 
         /**
-         * Work area for bit reversal.
+         * Returns the shared tables, only read for power of 2 lengths.
          */
-        int* ip;
+        Real* tables() const
+        {
+            return const_cast<Real*>(m_plan->twiddles().data());
+        }
+
+        /**
+         * Shared tables for this length.
+         */
+        std::shared_ptr<const OouraPlan<Real>> m_plan;
 
         /**
-         * Cos/sin table.
+         * Work area for bit reversal, copied from the plan.
          */
-        double* w;
+        AlignedVector<int> ip;
     };
 }
 
@@ -490,13 +786,26 @@ Appendix :
 */
 
 
-void cdft(int n, int isgn, double *a, int *ip, double *w)
+
+/* -------- forward declarations of the child routines -------- */
+
+template<typename Real> void makewt(int nw, int *ip, Real *w);
+template<typename Real> void makect(int nc, int *ip, Real *c);
+template<typename Real> void bitrv2(int n, int *ip, Real *a);
+template<typename Real> void bitrv2conj(int n, int *ip, Real *a);
+template<typename Real> void cftfsub(int n, Real *a, Real *w);
+template<typename Real> void cftbsub(int n, Real *a, Real *w);
+template<typename Real> void cft1st(int n, Real *a, Real *w);
+template<typename Real> void cftmdl(int n, int l, Real *a, Real *w);
+template<typename Real> void rftfsub(int n, Real *a, int nc, Real *c);
+template<typename Real> void rftbsub(int n, Real *a, int nc, Real *c);
+template<typename Real> void dctsub(int n, Real *a, int nc, Real *c);
+template<typename Real> void dstsub(int n, Real *a, int nc, Real *c);
+
+
+template<typename Real>
+void cdft(int n, int isgn, Real *a, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void bitrv2(int n, int *ip, double *a);
-    void bitrv2conj(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void cftbsub(int n, double *a, double *w);
 
     if (n > (ip[0] << 2)) {
         makewt(n >> 2, ip, w);
@@ -515,17 +824,11 @@ void cdft(int n, int isgn, double *a, int *ip, double *w)
 }
 
 
-void rdft(int n, int isgn, double *a, int *ip, double *w)
+template<typename Real>
+void rdft(int n, int isgn, Real *a, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void makect(int nc, int *ip, double *c);
-    void bitrv2(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void cftbsub(int n, double *a, double *w);
-    void rftfsub(int n, double *a, int nc, double *c);
-    void rftbsub(int n, double *a, int nc, double *c);
     int nw, nc;
-    double xi;
+    Real xi;
 
     nw = ip[0];
     if (n > (nw << 2)) {
@@ -549,7 +852,7 @@ void rdft(int n, int isgn, double *a, int *ip, double *w)
         a[0] += a[1];
         a[1] = xi;
     } else {
-        a[1] = 0.5 * (a[0] - a[1]);
+        a[1] = Real(0.5) * (a[0] - a[1]);
         a[0] -= a[1];
         if (n > 4) {
             rftbsub(n, a, nc, w + nw);
@@ -562,18 +865,11 @@ void rdft(int n, int isgn, double *a, int *ip, double *w)
 }
 
 
-void ddct(int n, int isgn, double *a, int *ip, double *w)
+template<typename Real>
+void ddct(int n, int isgn, Real *a, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void makect(int nc, int *ip, double *c);
-    void bitrv2(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void cftbsub(int n, double *a, double *w);
-    void rftfsub(int n, double *a, int nc, double *c);
-    void rftbsub(int n, double *a, int nc, double *c);
-    void dctsub(int n, double *a, int nc, double *c);
     int j, nw, nc;
-    double xr;
+    Real xr;
 
     nw = ip[0];
     if (n > (nw << 2)) {
@@ -621,18 +917,11 @@ void ddct(int n, int isgn, double *a, int *ip, double *w)
 }
 
 
-void ddst(int n, int isgn, double *a, int *ip, double *w)
+template<typename Real>
+void ddst(int n, int isgn, Real *a, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void makect(int nc, int *ip, double *c);
-    void bitrv2(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void cftbsub(int n, double *a, double *w);
-    void rftfsub(int n, double *a, int nc, double *c);
-    void rftbsub(int n, double *a, int nc, double *c);
-    void dstsub(int n, double *a, int nc, double *c);
     int j, nw, nc;
-    double xr;
+    Real xr;
 
     nw = ip[0];
     if (n > (nw << 2)) {
@@ -680,16 +969,11 @@ void ddst(int n, int isgn, double *a, int *ip, double *w)
 }
 
 
-void dfct(int n, double *a, double *t, int *ip, double *w)
+template<typename Real>
+void dfct(int n, Real *a, Real *t, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void makect(int nc, int *ip, double *c);
-    void bitrv2(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void rftfsub(int n, double *a, int nc, double *c);
-    void dctsub(int n, double *a, int nc, double *c);
     int j, k, l, m, mh, nw, nc;
-    double xr, xi, yr, yi;
+    Real xr, xi, yr, yi;
 
     nw = ip[0];
     if (n > (nw << 3)) {
@@ -776,16 +1060,11 @@ void dfct(int n, double *a, double *t, int *ip, double *w)
 }
 
 
-void dfst(int n, double *a, double *t, int *ip, double *w)
+template<typename Real>
+void dfst(int n, Real *a, Real *t, int *ip, Real *w)
 {
-    void makewt(int nw, int *ip, double *w);
-    void makect(int nc, int *ip, double *c);
-    void bitrv2(int n, int *ip, double *a);
-    void cftfsub(int n, double *a, double *w);
-    void rftfsub(int n, double *a, int nc, double *c);
-    void dstsub(int n, double *a, int nc, double *c);
     int j, k, l, m, mh, nw, nc;
-    double xr, xi, yr, yi;
+    Real xr, xi, yr, yi;
 
     nw = ip[0];
     if (n > (nw << 3)) {
@@ -868,9 +1147,9 @@ void dfst(int n, double *a, double *t, int *ip, double *w)
 
 #include <math.h>
 
-void makewt(int nw, int *ip, double *w)
+template<typename Real>
+void makewt(int nw, int *ip, Real *w)
 {
-    void bitrv2(int n, int *ip, double *a);
     int j, nwh;
     double delta, x, y;
 
@@ -898,7 +1177,8 @@ void makewt(int nw, int *ip, double *w)
 }
 
 
-void makect(int nc, int *ip, double *c)
+template<typename Real>
+void makect(int nc, int *ip, Real *c)
 {
     int j, nch;
     double delta;
@@ -920,10 +1200,11 @@ void makect(int nc, int *ip, double *c)
 /* -------- child routines -------- */
 
 
-void bitrv2(int n, int *ip, double *a)
+template<typename Real>
+void bitrv2(int n, int *ip, Real *a)
 {
     int j, j1, k, k1, l, m, m2;
-    double xr, xi, yr, yi;
+    Real xr, xi, yr, yi;
 
     ip[0] = 0;
     l = n;
@@ -1020,10 +1301,11 @@ void bitrv2(int n, int *ip, double *a)
 }
 
 
-void bitrv2conj(int n, int *ip, double *a)
+template<typename Real>
+void bitrv2conj(int n, int *ip, Real *a)
 {
     int j, j1, k, k1, l, m, m2;
-    double xr, xi, yr, yi;
+    Real xr, xi, yr, yi;
 
     ip[0] = 0;
     l = n;
@@ -1129,12 +1411,11 @@ void bitrv2conj(int n, int *ip, double *a)
 }
 
 
-void cftfsub(int n, double *a, double *w)
+template<typename Real>
+void cftfsub(int n, Real *a, Real *w)
 {
-    void cft1st(int n, double *a, double *w);
-    void cftmdl(int n, int l, double *a, double *w);
     int j, j1, j2, j3, l;
-    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+    Real x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
 
     l = 2;
     if (n > 8) {
@@ -1181,12 +1462,11 @@ void cftfsub(int n, double *a, double *w)
 }
 
 
-void cftbsub(int n, double *a, double *w)
+template<typename Real>
+void cftbsub(int n, Real *a, Real *w)
 {
-    void cft1st(int n, double *a, double *w);
-    void cftmdl(int n, int l, double *a, double *w);
     int j, j1, j2, j3, l;
-    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+    Real x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
 
     l = 2;
     if (n > 8) {
@@ -1233,11 +1513,12 @@ void cftbsub(int n, double *a, double *w)
 }
 
 
-void cft1st(int n, double *a, double *w)
+template<typename Real>
+void cft1st(int n, Real *a, Real *w)
 {
     int j, k1, k2;
-    double wk1r, wk1i, wk2r, wk2i, wk3r, wk3i;
-    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+    Real wk1r, wk1i, wk2r, wk2i, wk3r, wk3i;
+    Real x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
 
     x0r = a[0] + a[2];
     x0i = a[1] + a[3];
@@ -1338,11 +1619,12 @@ void cft1st(int n, double *a, double *w)
 }
 
 
-void cftmdl(int n, int l, double *a, double *w)
+template<typename Real>
+void cftmdl(int n, int l, Real *a, Real *w)
 {
     int j, j1, j2, j3, k, k1, k2, m, m2;
-    double wk1r, wk1i, wk2r, wk2i, wk3r, wk3i;
-    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+    Real wk1r, wk1i, wk2r, wk2i, wk3r, wk3i;
+    Real x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
 
     m = l << 2;
     for (j = 0; j < l; j += 2) {
@@ -1465,10 +1747,11 @@ void cftmdl(int n, int l, double *a, double *w)
 }
 
 
-void rftfsub(int n, double *a, int nc, double *c)
+template<typename Real>
+void rftfsub(int n, Real *a, int nc, Real *c)
 {
     int j, k, kk, ks, m;
-    double wkr, wki, xr, xi, yr, yi;
+    Real wkr, wki, xr, xi, yr, yi;
 
     m = n >> 1;
     ks = 2 * nc / m;
@@ -1476,7 +1759,7 @@ void rftfsub(int n, double *a, int nc, double *c)
     for (j = 2; j < m; j += 2) {
         k = n - j;
         kk += ks;
-        wkr = 0.5 - c[nc - kk];
+        wkr = Real(0.5) - c[nc - kk];
         wki = c[kk];
         xr = a[j] - a[k];
         xi = a[j + 1] + a[k + 1];
@@ -1490,10 +1773,11 @@ void rftfsub(int n, double *a, int nc, double *c)
 }
 
 
-void rftbsub(int n, double *a, int nc, double *c)
+template<typename Real>
+void rftbsub(int n, Real *a, int nc, Real *c)
 {
     int j, k, kk, ks, m;
-    double wkr, wki, xr, xi, yr, yi;
+    Real wkr, wki, xr, xi, yr, yi;
 
     a[1] = -a[1];
     m = n >> 1;
@@ -1502,7 +1786,7 @@ void rftbsub(int n, double *a, int nc, double *c)
     for (j = 2; j < m; j += 2) {
         k = n - j;
         kk += ks;
-        wkr = 0.5 - c[nc - kk];
+        wkr = Real(0.5) - c[nc - kk];
         wki = c[kk];
         xr = a[j] - a[k];
         xi = a[j + 1] + a[k + 1];
@@ -1517,10 +1801,11 @@ void rftbsub(int n, double *a, int nc, double *c)
 }
 
 
-void dctsub(int n, double *a, int nc, double *c)
+template<typename Real>
+void dctsub(int n, Real *a, int nc, Real *c)
 {
     int j, k, kk, ks, m;
-    double wkr, wki, xr;
+    Real wkr, wki, xr;
 
     m = n >> 1;
     ks = nc / n;
@@ -1538,10 +1823,11 @@ void dctsub(int n, double *a, int nc, double *c)
 }
 
 
-void dstsub(int n, double *a, int nc, double *c)
+template<typename Real>
+void dstsub(int n, Real *a, int nc, Real *c)
 {
     int j, k, kk, ks, m;
-    double wkr, wki, xr;
+    Real wkr, wki, xr;
 
     m = n >> 1;
     ks = nc / n;
@@ -0,0 +1,340 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SimdFft.h
+ *
+ * Vectorized complex FFT, falling back to Ooura's code.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_SIMDFFT_H
+#define QUASAR_TRANSFORM_SIMDFFT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/CpuFeatures.h"
+#include "../simd/FftKernels.h"
+#include "../simd/SimdKernels.h"
+#include "Fft.h"
+#include "MixedRadixFft.h"
+#include "OouraFft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace Quasar
+{
+    /**
+     * Roots of unity used by SimdFft for one length, shared by all
+     * transforms of that length and precision.
+     */
+    template<typename Real = double>
+    class SimdFftPlan
+    {
+    public:
+        /**
+         * Builds the tables, in double precision.
+         *
+         * @param length transform length, a power of 2
+         */
+        explicit SimdFftPlan(std::size_t length):
+            m_length(length),
+            m_forward(2 * length),
+            m_inverse(2 * length),
+            m_firstForward(6 * (length / 4)),
+            m_firstInverse(6 * (length / 4))
+        {
+            const double step = 2.0 * M_PI / static_cast<double>(length);
+            for (std::size_t j = 0; j < length; ++j)
+            {
+                const double c = std::cos(step * j), s = std::sin(step * j);
+                m_forward[2 * j] = static_cast<Real>(c);
+                m_forward[2 * j + 1] = static_cast<Real>(s);
+                m_inverse[2 * j] = static_cast<Real>(c);
+                m_inverse[2 * j + 1] = static_cast<Real>(-s);
+            }
+            // w^p, w^2p and w^3p of the first pass, each contiguous in p
+            const std::size_t n4 = length / 4;
+            for (std::size_t k = 1; k <= 3; ++k)
+            {
+                for (std::size_t p = 0; p < n4; ++p)
+                {
+                    const std::size_t from = 2 * (k * p), to = 2 * ((k - 1) * n4 + p);
+                    m_firstForward[to] = m_forward[from];
+                    m_firstForward[to + 1] = m_forward[from + 1];
+                    m_firstInverse[to] = m_inverse[from];
+                    m_firstInverse[to + 1] = m_inverse[from + 1];
+                }
+            }
+        }
+
+        /**
+         * Returns the shared plan for a length, building it on first use.
+         *
+         * @param length transform length, a power of 2
+         * @return the plan
+         */
+        static std::shared_ptr<const SimdFftPlan> get(std::size_t length)
+        {
+            static std::mutex mutex;
+            static std::map<std::size_t, std::shared_ptr<const SimdFftPlan>> plans;
+            std::lock_guard<std::mutex> lock(mutex);
+            std::shared_ptr<const SimdFftPlan>& plan = plans[length];
+            if (!plan)
+            {
+                plan = std::make_shared<const SimdFftPlan>(length);
+            }
+            return plan;
+        }
+
+        /**
+         * Returns roots of unity for a direction.
+         *
+         * @param direction 1 for the forward transform, -1 for the inverse
+         * @return table of exp(direction * 2 pi i j / N), interleaved
+         */
+        const Real* roots(int direction) const
+        {
+            return (direction > 0) ? m_forward.data() : m_inverse.data();
+        }
+
+        /**
+         * Returns twiddles of the first pass for a direction.
+         *
+         * @param direction 1 for the forward transform, -1 for the inverse
+         * @return w^p, w^2p and w^3p for p < N / 4, interleaved
+         */
+        const Real* firstPass(int direction) const
+        {
+            return (direction > 0) ? m_firstForward.data() : m_firstInverse.data();
+        }
+
+    private:
+        /**
+         * Transform length.
+         */
+        std::size_t m_length;
+
+        /**
+         * Roots of unity of the forward and inverse transforms.
+         */
+        AlignedVector<Real> m_forward, m_inverse;
+
+        /**
+         * Twiddles of the first pass, see firstPass().
+         */
+        AlignedVector<Real> m_firstForward, m_firstInverse;
+    };
+
+    /**
+     * Complex FFT with explicitly vectorized radix-4 butterflies.
+     *
+     * The transform is a Stockham radix-4 FFT (with one radix-2 pass for
+     * odd powers of 2), whose passes run on AVX-512 or AVX2 registers, as
+     * selected by the runtime CPU dispatch of Simd::simdLevel(). On CPUs
+     * without AVX2 it forwards to OouraFftComplex, and for lengths which
+     * are not powers of 2 to MixedRadixFft. Either way the results follow the conventions
+     * of OouraFftComplex: the forward transform uses exp(+2 pi i jk / N)
+     * and the inverse one is scaled by 1 / N.
+     *
+     * Like the other transforms, an object must not be used by several
+     * threads at once; objects of the same length share their tables.
+     */
+    template<template<typename ...> class Container_t = std::vector, typename Real = double>
+    class SimdFft : public Fft<std::complex<Real>, Container_t>
+    {
+        static_assert(std::is_same<Real, double>::value || std::is_same<Real, float>::value,
+                      "SimdFft supports float and double precision");
+
+    public:
+        /**
+         * Initializes the transform for a given input length.
+         *
+         * @param length input signal size
+         */
+        explicit SimdFft(std::size_t length):
+            Fft<std::complex<Real>, Container_t>::Fft(length),
+            m_plan(),
+            m_work(),
+            m_fallback()
+        {
+            if (isAccelerated(length))
+            {
+                m_plan = SimdFftPlan<Real>::get(length);
+                m_work.resize(2 * length);
+            }
+            else if (length > 0 && (length & (length - 1)) == 0)
+            {
+                m_fallback.reset(new OouraFftComplex<Container_t, Real>(length));
+            }
+            else
+            {
+                m_fallback.reset(new MixedRadixFft<Container_t, Real>(length));
+            }
+        }
+
+        /**
+         * Checks whether transforms of a length use the vectorized code
+         * on this CPU.
+         *
+         * @param length transform length
+         * @return false if another transform would be used instead
+         */
+        static bool isAccelerated(std::size_t length)
+        {
+            return Simd::simdLevel() >= Simd::AVX2 && length >= 4 &&
+                   (length & (length - 1)) == 0;
+        }
+
+        /**
+         * Applies the forward transform in place.
+         *
+         * @param signal input signal, replaced by its spectrum
+         */
+        virtual void fft(SignalSource<std::complex<Real>, Container_t>& signal)
+        {
+            if (m_fallback)
+            {
+                m_fallback->fft(signal);
+                return;
+            }
+            transform(signal.toArray(), 1);
+        }
+
+        /**
+         * Applies the inverse transform in place.
+         *
+         * @param spectrum input spectrum, replaced by the signal
+         */
+        virtual void ifft(SignalSource<std::complex<Real>, Container_t>& spectrum)
+        {
+            if (m_fallback)
+            {
+                m_fallback->ifft(spectrum);
+                return;
+            }
+            transform(spectrum.toArray(), -1);
+        }
+
+        /**
+         * Applies the forward transform out of place.
+         *
+         * @param input input signal, left unchanged
+         * @param output buffer of N samples for the spectrum
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void fft(const SignalSource<std::complex<Real>, Container_t>& input,
+                         SignalSpan<std::complex<Real>> output)
+        {
+            if (m_fallback)
+            {
+                m_fallback->fft(input, output);
+                return;
+            }
+            this->copyInput(input, output);
+            transform(output.data(), 1);
+        }
+
+        /**
+         * Applies the inverse transform out of place.
+         *
+         * @param spectrum input spectrum, left unchanged
+         * @param output buffer of N samples for the signal
+         * @throw std::invalid_argument if the buffer is too short
+         */
+        virtual void ifft(const SignalSource<std::complex<Real>, Container_t>& spectrum,
+                          SignalSpan<std::complex<Real>> output)
+        {
+            if (m_fallback)
+            {
+                m_fallback->ifft(spectrum, output);
+                return;
+            }
+            this->copyInput(spectrum, output);
+            transform(output.data(), -1);
+        }
+
+        using Fft<std::complex<Real>, Container_t>::fft;
+        using Fft<std::complex<Real>, Container_t>::ifft;
+
+    private:
+        /**
+         * Runs the passes, alternating between the data and the work area.
+         *
+         * @param data N complex numbers, transformed in place
+         * @param direction 1 for the forward transform, -1 for the inverse
+         */
+        void transform(std::complex<Real>* data, int direction)
+        {
+            const std::size_t length = this->N;
+            const Real* w = m_plan->roots(direction);
+            const Real sign = static_cast<Real>(direction);
+            Real* x = reinterpret_cast<Real*>(data);
+            Real* y = m_work.data();
+            Simd::radix4FirstPass(length, x, y, w, m_plan->firstPass(direction), sign);
+            std::swap(x, y);
+            std::size_t n = length / 4, s = 4;
+            for (; n >= 4; n /= 4, s *= 4)
+            {
+                Simd::radix4Pass(n, s, x, y, w, sign);
+                std::swap(x, y);
+            }
+            if (n == 2)
+            {
+                Simd::radix2Pass(s, x, y);
+                std::swap(x, y);
+            }
+            Real* out = reinterpret_cast<Real*>(data);
+            if (x != out)
+            {
+                std::copy(x, x + 2 * length, out);
+            }
+            if (direction < 0)
+            {
+                const Real scale = Real(1) / static_cast<Real>(length);
+                Simd::multiplyPattern(out, 2 * length, scale, scale);
+            }
+        }
+
+        /**
+         * Shared tables, null when falling back to Ooura.
+         */
+        std::shared_ptr<const SimdFftPlan<Real>> m_plan;
+
+        /**
+         * Second buffer of the Stockham passes.
+         */
+        AlignedVector<Real> m_work;
+
+        /**
+         * Transform used on CPUs without AVX2 or for other lengths.
+         */
+        std::unique_ptr<Fft<std::complex<Real>, Container_t>> m_fallback;
+    };
+}
+
+#endif // QUASAR_TRANSFORM_SIMDFFT_H
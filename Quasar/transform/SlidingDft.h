@@ -0,0 +1,423 @@
+/*
+ *   Copyright 2016 Robert C. Taylor
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file SlidingDft.h
+ *
+ * A few DFT bins of a window sliding by one sample.
+ *
+ * @package Quasar
+ * @version 4.0.0-beta
+ * @author Robert C. Taylor
+ * @date 2016
+ * @since 4.0.0
+ */
+
+#ifndef QUASAR_TRANSFORM_SLIDINGDFT_H
+#define QUASAR_TRANSFORM_SLIDINGDFT_H
+
+#include "../global.h"
+#include "../memory/AlignedAllocator.h"
+#include "../simd/GoertzelKernels.h"
+#include "../source/SignalSource.h"
+#include "../source/SignalSpan.h"
+#include "GoertzelBank.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Quasar
+{
+    /**
+     * Tracks selected bins of the DFT of the last getLength() samples
+     * of a stream, updated with every sample.
+     *
+     * After each sample, bin k holds the sum of x[j] exp(2 pi i jk / N)
+     * over the window, x[0] being its oldest sample, as OouraFftComplex
+     * would give for the window. Before N samples have been pushed, the
+     * window is padded with zeros in front. Bins need not be integers.
+     *
+     * Each sample costs one complex multiply-add per bin, whatever the
+     * window length: the window is slid with X = a (X - oldest) + b newest,
+     * the bins spread across SIMD registers. Rounding errors of this
+     * recurrence do not decay, so at the end of the first window after
+     * resyncInterval samples the bins are recomputed from the window
+     * itself by a GoertzelBank. This bounds the relative error by about
+     * resyncInterval times the machine epsilon, at the cost of a few
+     * Goertzel steps per window; single precision recomputes more often.
+     *
+     * @verbatim
+     * Quasar::SlidingDft<> pilot({19000}, 48000, 480);
+     * pilot.push(block, blockSize, [&] (Quasar::SignalSpan<const Quasar::ComplexType> bins) {
+     *     phase.push_back(std::arg(bins[0]));
+     * });                                                            @endverbatim
+     */
+    template<typename Real = double>
+    class SlidingDft
+    {
+        static_assert(std::is_same<Real, double>::value || std::is_same<Real, float>::value,
+                      "SlidingDft supports float and double precision");
+
+    public:
+        /**
+         * Minimum number of samples between recomputations of the bins.
+         */
+        static const std::size_t resyncInterval =
+            std::is_same<Real, float>::value ? 4096 : 65536;
+
+        /**
+         * Creates a tracker of bins given as DFT indices.
+         *
+         * @param bins bin indices, in cycles per window, not necessarily integer
+         * @param length samples in the window
+         * @throw std::invalid_argument for zero length
+         */
+        SlidingDft(const std::vector<double>& bins, std::size_t length):
+            m_length(length),
+            m_count(bins.size()),
+            m_position(0),
+            m_sinceResync(0),
+            m_history(),
+            m_coefficients(),
+            m_re(),
+            m_im(),
+            m_bins(bins.size()),
+            m_resync(bins, length)
+        {
+            initialize(bins);
+        }
+
+        /**
+         * Creates a tracker of bins given as frequencies.
+         *
+         * @param frequencies frequencies of the bins in Hz
+         * @param sampleFrequency sample frequency of the stream in Hz
+         * @param length samples in the window
+         * @throw std::invalid_argument for zero length or sample frequency
+         */
+        SlidingDft(const std::vector<FrequencyType>& frequencies,
+                   FrequencyType sampleFrequency, std::size_t length):
+            m_length(length),
+            m_count(frequencies.size()),
+            m_position(0),
+            m_sinceResync(0),
+            m_history(),
+            m_coefficients(),
+            m_re(),
+            m_im(),
+            m_bins(frequencies.size()),
+            m_resync(frequencies, sampleFrequency, length)
+        {
+            std::vector<double> bins(frequencies.size());
+            for (std::size_t b = 0; b < bins.size(); ++b)
+            {
+                bins[b] = frequencies[b] * static_cast<double>(length) / sampleFrequency;
+            }
+            initialize(bins);
+        }
+
+        /**
+         * Pushes a block of samples; getBins() then holds the bins of the
+         * window ending with the last of them.
+         *
+         * @param samples pointer to the samples
+         * @param count number of samples
+         */
+        void push(const Real* samples, std::size_t count)
+        {
+            while (count > 0)
+            {
+                const std::size_t n = std::min(count, m_length - m_position);
+                slide(samples, n);
+                samples += n;
+                count -= n;
+            }
+            updateBins();
+        }
+
+        /**
+         * Pushes a block of samples, emitting the bins after every sample.
+         *
+         * @param samples pointer to the samples
+         * @param count number of samples
+         * @param onSample callable taking SignalSpan<const std::complex<Real>>,
+         *                 the bins of the window ending with the sample
+         */
+        template<typename Callback>
+        void push(const Real* samples, std::size_t count, Callback&& onSample)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                slide(samples + i, 1);
+                updateBins();
+                onSample(getBins());
+            }
+        }
+
+        /**
+         * Pushes a span of samples.
+         *
+         * @param samples block of samples
+         */
+        void push(SignalSpan<const Real> samples)
+        {
+            push(samples.data(), samples.size());
+        }
+
+        /**
+         * Pushes a span of samples, emitting the bins after every sample.
+         *
+         * @param samples block of samples
+         * @param onSample callable taking SignalSpan<const std::complex<Real>>
+         */
+        template<typename Callback>
+        void push(SignalSpan<const Real> samples, Callback&& onSample)
+        {
+            push(samples.data(), samples.size(), onSample);
+        }
+
+        /**
+         * Pushes all samples of a source.
+         *
+         * @param source block of samples
+         */
+        template<template<typename ...> class Container_t>
+        void push(const SignalSource<Real, Container_t>& source)
+        {
+            forEachBlock(source, [this] (const Real* samples, std::size_t count)
+            {
+                push(samples, count);
+            });
+        }
+
+        /**
+         * Pushes all samples of a source, emitting the bins after every
+         * sample.
+         *
+         * @param source block of samples
+         * @param onSample callable taking SignalSpan<const std::complex<Real>>
+         */
+        template<template<typename ...> class Container_t, typename Callback>
+        void push(const SignalSource<Real, Container_t>& source, Callback&& onSample)
+        {
+            forEachBlock(source, [this, &onSample] (const Real* samples, std::size_t count)
+            {
+                push(samples, count, onSample);
+            });
+        }
+
+        /**
+         * Empties the window.
+         */
+        void reset()
+        {
+            m_position = 0;
+            m_sinceResync = 0;
+            std::fill(m_history.begin(), m_history.end(), Real(0));
+            std::fill(m_re.begin(), m_re.end(), Real(0));
+            std::fill(m_im.begin(), m_im.end(), Real(0));
+            updateBins();
+        }
+
+        /**
+         * Returns the bins of the current window.
+         *
+         * @return one value per bin, in the order given to the constructor
+         */
+        SignalSpan<const std::complex<Real>> getBins() const
+        {
+            return SignalSpan<const std::complex<Real>>(m_bins.data(), m_bins.size());
+        }
+
+        /**
+         * Returns number of samples in the window.
+         *
+         * @return window length
+         */
+        std::size_t getLength() const
+        {
+            return m_length;
+        }
+
+        /**
+         * Returns number of tracked bins.
+         *
+         * @return bins count
+         */
+        std::size_t getBinsCount() const
+        {
+            return m_count;
+        }
+
+    private:
+        /**
+         * Prepares the coefficients, in double precision.
+         */
+        void initialize(const std::vector<double>& bins)
+        {
+            const std::size_t padded = (m_count + Simd::binsAlignment - 1) /
+                                       Simd::binsAlignment * Simd::binsAlignment;
+            m_history.assign(m_length, Real(0));
+            m_coefficients.assign(4 * padded, Real(0));
+            m_re.assign(padded, Real(0));
+            m_im.assign(padded, Real(0));
+            const double length = static_cast<double>(m_length);
+            for (std::size_t b = 0; b < m_count; ++b)
+            {
+                // a = exp(-i omega), b = exp(i omega (N - 1)) = a exp(i omega N),
+                // exp(i omega N) being 1 for integer bins
+                const double omega = 2.0 * M_PI * bins[b] / length;
+                const double turn = 2.0 * M_PI * (bins[b] - std::floor(bins[b]));
+                const std::complex<double> a(std::cos(omega), -std::sin(omega));
+                const std::complex<double> last = a * std::complex<double>(std::cos(turn), std::sin(turn));
+                m_coefficients[b] = static_cast<Real>(a.real());
+                m_coefficients[padded + b] = static_cast<Real>(a.imag());
+                m_coefficients[2 * padded + b] = static_cast<Real>(last.real());
+                m_coefficients[3 * padded + b] = static_cast<Real>(last.imag());
+            }
+        }
+
+        /**
+         * Slides the window by n samples, not past the end of the history.
+         */
+        void slide(const Real* samples, std::size_t n)
+        {
+            Real* oldest = m_history.data() + m_position;
+            Simd::slidingDft(oldest, samples, n, m_re.size(), m_coefficients.data(),
+                             m_re.data(), m_im.data());
+            std::copy(samples, samples + n, oldest);
+            m_position += n;
+            if (m_position == m_length)
+            {
+                m_position = 0;
+                m_sinceResync += m_length;
+                if (m_sinceResync >= resyncInterval)
+                {
+                    m_sinceResync = 0;
+                    resync();
+                }
+            }
+        }
+
+        /**
+         * Recomputes the bins from the history, which holds the window in
+         * order when the write position is back at its beginning.
+         */
+        void resync()
+        {
+            m_resync.push(m_history.data(), m_length, [this] (SignalSpan<const std::complex<Real>> bins)
+            {
+                for (std::size_t b = 0; b < m_count; ++b)
+                {
+                    m_re[b] = bins[b].real();
+                    m_im[b] = bins[b].imag();
+                }
+            });
+        }
+
+        /**
+         * Copies the bins to the array returned by getBins().
+         */
+        void updateBins()
+        {
+            for (std::size_t b = 0; b < m_count; ++b)
+            {
+                m_bins[b] = std::complex<Real>(m_re[b], m_im[b]);
+            }
+        }
+
+        /**
+         * Passes the samples of a source to a function in contiguous blocks.
+         */
+        template<template<typename ...> class Container_t, typename Function>
+        static void forEachBlock(const SignalSource<Real, Container_t>& source, Function f)
+        {
+            if (source.isContiguous())
+            {
+                f(source.toArray(), source.getSamplesCount());
+                return;
+            }
+            const std::size_t block = 256;
+            Real buffer[block];
+            const std::size_t length = source.getSamplesCount();
+            for (std::size_t offset = 0; offset < length; offset += block)
+            {
+                const std::size_t count = std::min(block, length - offset);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    buffer[i] = source.sample(offset + i);
+                }
+                f(buffer, count);
+            }
+        }
+
+        /**
+         * Samples in the window.
+         */
+        std::size_t m_length;
+
+        /**
+         * Number of bins.
+         */
+        std::size_t m_count;
+
+        /**
+         * Index of the oldest sample of the window in the history.
+         */
+        std::size_t m_position;
+
+        /**
+         * Samples slid since the last recomputation, counted in whole
+         * windows.
+         */
+        std::size_t m_sinceResync;
+
+        /**
+         * The window, as a ring buffer.
+         */
+        AlignedVector<Real> m_history;
+
+        /**
+         * Rows of real and imaginary parts of a and b, each padded to
+         * Simd::binsAlignment.
+         */
+        AlignedVector<Real> m_coefficients;
+
+        /**
+         * Real and imaginary parts of the bins.
+         */
+        AlignedVector<Real> m_re, m_im;
+
+        /**
+         * Bins of the current window.
+         */
+        AlignedVector<std::complex<Real>> m_bins;
+
+        /**
+         * Bank computing the bins of the window from scratch.
+         */
+        GoertzelBank<Real> m_resync;
+    };
+
+    template<typename Real>
+    const std::size_t SlidingDft<Real>::resyncInterval;
+}
+
+#endif // QUASAR_TRANSFORM_SLIDINGDFT_H
@@ -0,0 +1,72 @@
+// count AlignedVector allocations too, see alignedAlloc()
+#define QUASAR_COUNT_ALLOCATIONS
+
+#include "Quasar/quasar.h"
+#include "Quasar/memory/AllocationCounter.h"
+#include "Quasar/transform/SimdFft.h"
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+QUASAR_COUNT_GLOBAL_ALLOCATIONS
+
+/**
+ * A block of a real-time AM receiver front end, working only on
+ * caller-owned buffers: generates the carrier and the message, mixes
+ * them, windows the block and takes its spectrum.
+ */
+struct BlockPath
+{
+    static const std::size_t SIZE = 1024;
+
+    BlockPath():
+        carrier(48000), message(48000), window(SIZE), fft(SIZE),
+        c(SIZE), m(SIZE), mixed(SIZE), samples(SIZE), spectrum(SIZE)
+    {
+        carrier.setFrequency(6000).setAmplitude(1);
+        message.setFrequency(440).setAmplitude(0.5);
+    }
+
+    void process()
+    {
+        carrier.generate(Quasar::SignalSpan<double>(c.data(), SIZE));
+        message.generate(Quasar::SignalSpan<double>(m.data(), SIZE));
+        Quasar::SignalView<> carrierView(c.data(), SIZE), messageView(m.data(), SIZE);
+        Quasar::SignalView<> mixedView(mixed.data(), SIZE);
+        Quasar::multiply(carrierView, messageView, mixedView);
+        mixedView *= window;
+        mixedView += 0.25;
+        for (std::size_t i = 0; i < SIZE; ++i)
+        {
+            samples[i] = mixed[i];
+        }
+        Quasar::SignalView<Quasar::ComplexType> input(samples.data(), SIZE);
+        fft.fft(input, Quasar::SignalSpan<Quasar::ComplexType>(spectrum.data(), SIZE));
+        level = Quasar::rms(mixedView);
+    }
+
+    Quasar::SineGenerator<> carrier, message;
+    Quasar::HannWindow<> window;
+    Quasar::SimdFft<> fft;
+    Quasar::AlignedVector<double> c, m, mixed;
+    Quasar::AlignedVector<Quasar::ComplexType> samples, spectrum;
+    double level;
+};
+
+int main()
+{
+    BlockPath path;
+    // warm up, lazily created tables and buffers are allocated here
+    path.process();
+
+    Quasar::AllocationScope scope;
+    for (int block = 0; block < 100; ++block)
+    {
+        path.process();
+    }
+    std::cout << "Heap allocations in 100 steady state blocks: "
+              << scope.allocations() << std::endl;
+
+    return scope.allocations() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+#include "Quasar/quasar.h"
+#include "Quasar/transform/OouraDct.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const long double PI = 3.14159265358979323846264338327950288L;
+
+/**
+ * Orthonormal DCT-II (dst = false) or DST-II (dst = true) in long double
+ * precision, straight from the definitions in OouraDct.h.
+ */
+template<typename Real>
+std::vector<long double> reference(const std::vector<Real>& x, bool dst)
+{
+    const std::size_t N = x.size();
+    std::vector<long double> result(N);
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        long double sum = 0;
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            sum += dst ? x[j] * std::sin(PI * (2 * j + 1) * (k + 1) / (2.0L * N))
+                       : x[j] * std::cos(PI * (2 * j + 1) * k / (2.0L * N));
+        }
+        const bool single = dst ? (k + 1 == N) : (k == 0);
+        result[k] = sum * std::sqrt((single ? 1.0L : 2.0L) / N);
+    }
+    return result;
+}
+
+/**
+ * Largest difference between computed and reference coefficients.
+ */
+template<typename Real>
+long double difference(const std::vector<Real>& computed, const std::vector<long double>& expected)
+{
+    long double error = 0;
+    for (std::size_t k = 0; k < computed.size(); ++k)
+    {
+        error = std::max(error, std::abs(computed[k] - expected[k]));
+    }
+    return error;
+}
+
+/**
+ * Runs both transforms of a length: the full coefficients, the first
+ * few of them (the truncated outputLength of MFCC) and the inverse.
+ *
+ * @return largest error of the coefficients or of the round trips,
+ *         relative to the largest coefficient
+ */
+template<typename Real>
+double transformError(std::size_t N)
+{
+    std::vector<Real> x(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        x[i] = static_cast<Real>(std::sin(0.1 * i + 1.0) + 0.5 * std::cos(0.37 * i));
+    }
+    const std::vector<long double> expectedDct = reference(x, false), expectedDst = reference(x, true);
+    const Quasar::SignalSpan<const Real> input(x.data(), N);
+
+    Quasar::OouraDct<Real> dct(N);
+    Quasar::OouraDst<Real> dst(N);
+    std::vector<Real> cosines(N), sines(N), first((N + 1) / 2), y(N), z(N);
+    dct.dct(input, Quasar::SignalSpan<Real>(cosines.data(), N));
+    dst.dst(input, Quasar::SignalSpan<Real>(sines.data(), N));
+    long double error = std::max(difference(cosines, expectedDct), difference(sines, expectedDst));
+    error = std::max(error, difference(dct.dct(x, std::min<std::size_t>(N, 3)), expectedDct));
+    dst.dst(input, Quasar::SignalSpan<Real>(first.data(), first.size()));
+    error = std::max(error, difference(first, expectedDst));
+
+    dct.idct(Quasar::SignalSpan<const Real>(cosines.data(), N), Quasar::SignalSpan<Real>(y.data(), N));
+    dst.idst(Quasar::SignalSpan<const Real>(sines.data(), N), Quasar::SignalSpan<Real>(z.data(), N));
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        error = std::max(error, static_cast<long double>(std::abs(y[i] - x[i])));
+        error = std::max(error, static_cast<long double>(std::abs(z[i] - x[i])));
+    }
+    long double scale = 0;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        scale = std::max(scale, std::max(std::abs(expectedDct[k]), std::abs(expectedDst[k])));
+    }
+    return static_cast<double>(error / scale);
+}
+
+int main()
+{
+    // powers of 2 use Ooura's ddct() and ddst(), other lengths the
+    // cached basis matrix
+    const std::size_t lengths[] = {1, 2, 3, 4, 8, 13, 16, 23, 24, 40, 64, 100, 256, 1024};
+    double worstFast = 0, worstMatrix = 0, worstFloat = 0;
+    for (std::size_t N : lengths)
+    {
+        const double error = transformError<double>(N);
+        if (Quasar::OouraDct<>(N).isFast())
+        {
+            worstFast = std::max(worstFast, error);
+        }
+        else
+        {
+            worstMatrix = std::max(worstMatrix, error);
+        }
+        worstFloat = std::max(worstFloat, transformError<float>(N));
+    }
+    std::cout << "Worst DCT / DST error " << worstFast << " (Ooura), "
+              << worstMatrix << " (basis matrix), " << worstFloat << " (float)"
+              << std::endl;
+
+    return (worstFast < 1e-13 && worstMatrix < 1e-13 && worstFloat < 1e-5) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+#include "Quasar/quasar.h"
+#include "Quasar/parallel/ThreadPool.h"
+#include "Quasar/source/FrameMatrix.h"
+#include "Quasar/transform/Fft2d.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+typedef std::complex<long double> Reference;
+
+/**
+ * Roots exp(2 pi i m / N) for m = 0 to N - 1 in long double precision.
+ */
+std::vector<Reference> roots(std::size_t N)
+{
+    const long double step = 2.0L * 3.14159265358979323846264338327950288L / N;
+    std::vector<Reference> result(N);
+    for (std::size_t m = 0; m < N; ++m)
+    {
+        result[m] = std::polar(1.0L, step * m);
+    }
+    return result;
+}
+
+/**
+ * Naive two dimensional DFT of a row-major matrix in long double
+ * precision, with the sign convention of OouraFftComplex: each row is
+ * transformed, then each column.
+ */
+template<typename Real>
+std::vector<Reference> referenceDft2d(const std::vector<std::complex<Real>>& x,
+                                      std::size_t rows, std::size_t columns)
+{
+    const std::vector<Reference> rowRoots = roots(columns), columnRoots = roots(rows);
+    std::vector<Reference> transformedRows(rows * columns), result(rows * columns);
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        for (std::size_t k = 0; k < columns; ++k)
+        {
+            Reference sum;
+            for (std::size_t c = 0; c < columns; ++c)
+            {
+                sum += Reference(x[r * columns + c]) * rowRoots[(c * k) % columns];
+            }
+            transformedRows[r * columns + k] = sum;
+        }
+    }
+    for (std::size_t c = 0; c < columns; ++c)
+    {
+        for (std::size_t k = 0; k < rows; ++k)
+        {
+            Reference sum;
+            for (std::size_t r = 0; r < rows; ++r)
+            {
+                sum += transformedRows[r * columns + c] * columnRoots[(r * k) % rows];
+            }
+            result[k * columns + c] = sum;
+        }
+    }
+    return result;
+}
+
+/**
+ * Transforms a test matrix stored row-major with padding after each
+ * row, then back; stored column-major; and in a FrameMatrix.
+ *
+ * @return largest error of the spectra, relative to the largest
+ *         magnitude, or of the round trip, whichever is bigger; 1 if
+ *         the padding was written
+ */
+template<typename Real>
+double transformError(std::size_t rows, std::size_t columns, Quasar::ThreadPool* pool)
+{
+    typedef std::complex<Real> Complex;
+    const std::size_t N = rows * columns;
+    std::vector<Complex> x(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        x[i] = Complex(static_cast<Real>(std::sin(0.1 * i + 1.0)),
+                       static_cast<Real>(std::cos(0.37 * i)));
+    }
+    const std::vector<Reference> expected = referenceDft2d(x, rows, columns);
+    long double magnitude = 0;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        magnitude = std::max(magnitude, std::abs(expected[k]));
+    }
+
+    Quasar::Fft2d<Real> fft(rows, columns);
+    const std::size_t distance = columns + 3;
+    const Complex padding(99, -99);
+    std::vector<Complex> padded(rows * distance, padding), columnMajor(N);
+    Quasar::FrameMatrix<Complex> frames(rows, columns);
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        for (std::size_t c = 0; c < columns; ++c)
+        {
+            padded[r * distance + c] = x[r * columns + c];
+            columnMajor[c * rows + r] = x[r * columns + c];
+            frames(r, c) = x[r * columns + c];
+        }
+    }
+    fft.fft(padded.data(), distance, 1, pool);
+    fft.fft(columnMajor.data(), 1, rows, pool);
+    fft.fft(frames, pool);
+    long double error = 0;
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        for (std::size_t c = 0; c < columns; ++c)
+        {
+            const Reference& y = expected[r * columns + c];
+            error = std::max(error, std::abs(Reference(padded[r * distance + c]) - y));
+            error = std::max(error, std::abs(Reference(columnMajor[c * rows + r]) - y));
+            error = std::max(error, std::abs(Reference(frames(r, c)) - y));
+        }
+    }
+
+    fft.ifft(padded.data(), distance, 1, pool);
+    fft.ifft(frames, pool);
+    long double roundTrip = 0;
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        for (std::size_t c = 0; c < distance; ++c)
+        {
+            if (c >= columns)
+            {
+                if (padded[r * distance + c] != padding)
+                {
+                    return 1;
+                }
+                continue;
+            }
+            const Complex& original = x[r * columns + c];
+            roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(padded[r * distance + c] - original)));
+            roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(frames(r, c) - original)));
+        }
+    }
+    return static_cast<double>(std::max(error / magnitude, roundTrip));
+}
+
+int main()
+{
+    // single rows and columns, power of 2, composite and prime sides
+    const std::size_t shapes[][2] = {
+        {1, 1}, {1, 16}, {16, 1}, {8, 8}, {12, 20}, {31, 40}, {17, 101},
+        {64, 128}, {7, 1024}
+    };
+    Quasar::ThreadPool threads(3);
+    bool passed = true;
+    for (Quasar::ThreadPool* pool : {static_cast<Quasar::ThreadPool*>(nullptr), &threads})
+    {
+        double worstDouble = 0, worstFloat = 0;
+        for (const std::size_t* shape : shapes)
+        {
+            worstDouble = std::max(worstDouble, transformError<double>(shape[0], shape[1], pool));
+            worstFloat = std::max(worstFloat, transformError<float>(shape[0], shape[1], pool));
+        }
+        std::cout << (pool ? "thread pool" : "calling thread") << ": worst error "
+                  << worstDouble << " (double), " << worstFloat << " (float)"
+                  << std::endl;
+        passed = passed && worstDouble < 1e-13 && worstFloat < 1e-5;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+#include "Quasar/quasar.h"
+#include "Quasar/parallel/ThreadPool.h"
+#include "Quasar/transform/FourStepFft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+typedef std::complex<long double> Reference;
+
+/**
+ * Naive DFT in long double precision, with the sign convention of
+ * OouraFftComplex (exp(+2 pi i jk / N)).
+ */
+template<typename Real>
+std::vector<Reference> referenceDft(const std::vector<std::complex<Real>>& x)
+{
+    const std::size_t N = x.size();
+    const long double step = 2.0L * 3.14159265358979323846264338327950288L / N;
+    std::vector<Reference> roots(N), result(N);
+    for (std::size_t m = 0; m < N; ++m)
+    {
+        roots[m] = std::polar(1.0L, step * m);
+    }
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        Reference sum;
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            sum += Reference(x[j]) * roots[(j * k) % N];
+        }
+        result[k] = sum;
+    }
+    return result;
+}
+
+/**
+ * Transforms a test signal out of place, then back in place.
+ *
+ * @return largest error of the spectrum, relative to its largest
+ *         magnitude, or of the round trip, whichever is bigger
+ */
+template<typename Real>
+double transformError(std::size_t N, Quasar::ThreadPool& pool)
+{
+    typedef std::complex<Real> Complex;
+    std::vector<Complex> x(N), spectrum(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        x[i] = Complex(static_cast<Real>(std::sin(0.1 * i + 1.0)),
+                       static_cast<Real>(std::cos(0.37 * i)));
+    }
+    const std::vector<Reference> expected = referenceDft(x);
+
+    Quasar::FourStepFft<std::vector, Real> fft(N, pool);
+    fft.fft(Quasar::SignalView<Complex>(x.data(), N), Quasar::SignalSpan<Complex>(spectrum.data(), N));
+    long double error = 0, magnitude = 0;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        error = std::max(error, std::abs(Reference(spectrum[k]) - expected[k]));
+        magnitude = std::max(magnitude, std::abs(expected[k]));
+    }
+    Quasar::SignalView<Complex> signal(spectrum.data(), N);
+    fft.ifft(signal);
+    long double roundTrip = 0;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(spectrum[i] - x[i])));
+    }
+    return static_cast<double>(std::max(error / magnitude, roundTrip));
+}
+
+int main()
+{
+    // square (1024) and rectangular signal matrices, including ones
+    // narrower than a block of columns
+    const std::size_t lengths[] = {1, 2, 12, 60, 210, 1024, 2048, 2520, 6144};
+    Quasar::ThreadPool serial(0), threads(3);
+    bool passed = true;
+    for (Quasar::ThreadPool* pool : {&serial, &threads})
+    {
+        double worstDouble = 0, worstFloat = 0;
+        for (std::size_t N : lengths)
+        {
+            worstDouble = std::max(worstDouble, transformError<double>(N, *pool));
+            worstFloat = std::max(worstFloat, transformError<float>(N, *pool));
+        }
+        std::cout << pool->getWorkersCount() << " workers: worst error "
+                  << worstDouble << " (double), " << worstFloat << " (float)"
+                  << std::endl;
+        passed = passed && worstDouble < 1e-13 && worstFloat < 1e-5;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
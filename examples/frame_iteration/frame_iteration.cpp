@@ -26,13 +26,14 @@ int main(int argc, char *argv[])
               << ", number of frames: " << frames.count() << std::endl;
 
     unsigned int i = 0;
-    // here, begin() and end() return iterators that point to frame objects
-    for (auto it = frames.begin(); it != frames.end(); ++it, ++i)
+    // here, begin() and end() return iterators creating frame objects,
+    // so each frame is taken by value
+    for (auto frame : frames)
     {
         // and here the iterators returned point to individual samples
         // in each frame
-        double sum = std::accumulate(it->begin(), it->end(), 0.0);
-        std::cout << "\nFrame #" << i << ", sum = " << sum;
+        double sum = std::accumulate(frame.begin(), frame.end(), 0.0);
+        std::cout << "\nFrame #" << i++ << ", sum = " << sum;
     }
 
     delete [] testArray;
@@ -0,0 +1,181 @@
+#include "Quasar/quasar.h"
+#include "Quasar/transform/GoertzelBank.h"
+#include "Quasar/transform/SlidingDft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+typedef std::complex<long double> Reference;
+
+const long double PI = 3.14159265358979323846264338327950288L;
+
+/**
+ * Bins of a naive DFT of windows of N samples in long double precision,
+ * with the sign convention of OouraFftComplex (exp(+2 pi i jk / N)).
+ */
+class ReferenceDft
+{
+public:
+    ReferenceDft(const std::vector<double>& bins, std::size_t N):
+        m_length(N), m_roots(bins.size() * N)
+    {
+        for (std::size_t k = 0; k < bins.size(); ++k)
+        {
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                m_roots[k * N + j] = std::polar(1.0L, 2 * PI * bins[k] * j / N);
+            }
+        }
+    }
+
+    /**
+     * Largest difference between the bins of the window ending just
+     * before x[end] (zero padded in front) and the computed ones,
+     * relative to the window length.
+     */
+    template<typename Real>
+    double error(const std::vector<Real>& x, std::size_t end,
+                 Quasar::SignalSpan<const std::complex<Real>> bins) const
+    {
+        long double error = 0;
+        for (std::size_t k = 0; k < bins.size(); ++k)
+        {
+            Reference sum = 0;
+            for (std::size_t j = 0; j < m_length; ++j)
+            {
+                if (end + j >= m_length)
+                {
+                    sum += static_cast<long double>(x[end + j - m_length]) * m_roots[k * m_length + j];
+                }
+            }
+            const Reference computed(bins[k].real(), bins[k].imag());
+            error = std::max(error, std::abs(computed - sum));
+        }
+        return static_cast<double>(error / m_length);
+    }
+
+private:
+    std::size_t m_length;
+    std::vector<Reference> m_roots;
+};
+
+/**
+ * Bins count bins, integer and not, including 0 and N / 2.
+ */
+std::vector<double> someBins(std::size_t count, std::size_t N)
+{
+    const double picks[] = {0, 1, 3, 17.5, 0.5 * N, N - 1.0, 100.25, 2.75};
+    std::vector<double> bins(count);
+    for (std::size_t k = 0; k < count; ++k)
+    {
+        bins[k] = picks[k % 8] + 0.37 * (k / 8);
+    }
+    return bins;
+}
+
+/**
+ * Pushes a stream in uneven blocks through a GoertzelBank and a
+ * SlidingDft of count bins, past the resync interval of the latter,
+ * and checks every block and window against the reference. Then checks
+ * the bins emitted after every sample for a short window.
+ *
+ * @param count number of bins
+ * @param goertzel largest error of the blocks, relative to the window length
+ * @param sliding largest error of the windows, relative to the window length
+ */
+template<typename Real>
+void bankError(std::size_t count, double& goertzel, double& sliding)
+{
+    const std::size_t N = 1024;
+    const std::size_t chunks[] = {1, 7, 300, 1023, 2500, 64};
+    std::vector<Real> x(Quasar::SlidingDft<Real>::resyncInterval + 5 * N + 123);
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+        x[i] = static_cast<Real>(std::sin(0.1 * i + 1.0) + 0.5 * std::cos(0.0137 * i * (i % 7)));
+    }
+    const std::vector<double> bins = someBins(count, N);
+    const ReferenceDft reference(bins, N);
+
+    Quasar::GoertzelBank<Real> bank(bins, N);
+    Quasar::SlidingDft<Real> window(bins, N);
+    goertzel = 0;
+    sliding = 0;
+    std::size_t blocks = 0;
+    for (std::size_t offset = 0, c = 0; offset < x.size(); ++c)
+    {
+        const std::size_t n = std::min(chunks[c % 6], x.size() - offset);
+        bank.push(x.data() + offset, n, [&] (Quasar::SignalSpan<const std::complex<Real>> values) {
+            ++blocks;
+            goertzel = std::max(goertzel, reference.error(x, blocks * N, values));
+        });
+        window.push(x.data() + offset, n);
+        offset += n;
+        sliding = std::max(sliding, reference.error(x, offset, window.getBins()));
+    }
+    if (blocks != x.size() / N)
+    {
+        goertzel = 1;
+    }
+
+    const std::size_t M = 64;
+    const ReferenceDft shortReference(someBins(count, M), M);
+    Quasar::SlidingDft<Real> perSample(someBins(count, M), M);
+    std::size_t end = 0;
+    perSample.push(x.data(), 5000, [&] (Quasar::SignalSpan<const std::complex<Real>> values) {
+        ++end;
+        sliding = std::max(sliding, shortReference.error(x, end, values));
+    });
+}
+
+/**
+ * Error bound of SlidingDft, see its documentation.
+ */
+template<typename Real>
+double slidingTolerance()
+{
+    return Quasar::SlidingDft<Real>::resyncInterval * std::numeric_limits<Real>::epsilon();
+}
+
+int main()
+{
+    // bin counts that are a multiple of twice the vector width take the
+    // AVX2 and AVX-512 kernels, the others the scalar loop
+    const std::size_t counts[] = {1, 5, 8, 16, 32};
+    const Quasar::Simd::SimdLevel levels[] = {
+        Quasar::Simd::Scalar, Quasar::Simd::AVX2, Quasar::Simd::AVX512
+    };
+    const Quasar::Simd::SimdLevel detected = Quasar::Simd::detectSimdLevel();
+    bool passed = true;
+    for (Quasar::Simd::SimdLevel level : levels)
+    {
+        if (level > detected)
+        {
+            break;
+        }
+        Quasar::Simd::setSimdLevel(level);
+        double worst[4] = {0, 0, 0, 0};
+        for (std::size_t count : counts)
+        {
+            double error[4];
+            bankError<double>(count, error[0], error[1]);
+            bankError<float>(count, error[2], error[3]);
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                worst[i] = std::max(worst[i], error[i]);
+            }
+        }
+        std::cout << "SIMD level " << level << ": worst error " << worst[0]
+                  << " (Goertzel), " << worst[1] << " (sliding), " << worst[2]
+                  << " (Goertzel, float), " << worst[3] << " (sliding, float)" << std::endl;
+        passed = passed && worst[0] < 1e-13 && worst[1] < slidingTolerance<double>()
+                 && worst[2] < 1e-5 && worst[3] < slidingTolerance<float>();
+    }
+    Quasar::Simd::setSimdLevel(detected);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+#include "Quasar/quasar.h"
+#include "Quasar/simd/CpuFeatures.h"
+#include "Quasar/transform/MixedRadixFft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+typedef std::complex<long double> Reference;
+
+/**
+ * Naive DFT in long double precision, with the sign convention of
+ * OouraFftComplex (exp(+2 pi i jk / N)).
+ */
+template<typename Real>
+std::vector<Reference> referenceDft(const std::vector<std::complex<Real>>& x)
+{
+    const std::size_t N = x.size();
+    const long double step = 2.0L * 3.14159265358979323846264338327950288L / N;
+    std::vector<Reference> roots(N), result(N);
+    for (std::size_t m = 0; m < N; ++m)
+    {
+        roots[m] = std::polar(1.0L, step * m);
+    }
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        Reference sum;
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            sum += Reference(x[j]) * roots[(j * k) % N];
+        }
+        result[k] = sum;
+    }
+    return result;
+}
+
+/**
+ * Transforms a test signal forward and back, out of place.
+ *
+ * @return largest error of the spectrum, relative to its largest
+ *         magnitude, or of the round trip, whichever is bigger
+ */
+template<typename Real>
+double transformError(std::size_t N)
+{
+    typedef std::complex<Real> Complex;
+    std::vector<Complex> x(N), spectrum(N), y(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        x[i] = Complex(static_cast<Real>(std::sin(0.1 * i + 1.0)),
+                       static_cast<Real>(std::cos(0.37 * i)));
+    }
+    const std::vector<Reference> expected = referenceDft(x);
+
+    Quasar::MixedRadixFft<std::vector, Real> fft(N);
+    fft.fft(Quasar::SignalView<Complex>(x.data(), N), Quasar::SignalSpan<Complex>(spectrum.data(), N));
+    long double error = 0, magnitude = 0;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        error = std::max(error, std::abs(Reference(spectrum[k]) - expected[k]));
+        magnitude = std::max(magnitude, std::abs(expected[k]));
+    }
+    fft.ifft(Quasar::SignalView<Complex>(spectrum.data(), N), Quasar::SignalSpan<Complex>(y.data(), N));
+    long double roundTrip = 0;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(y[i] - x[i])));
+    }
+    return static_cast<double>(std::max(error / magnitude, roundTrip));
+}
+
+int main()
+{
+    // small and composite lengths use the mixed radix passes, lengths
+    // with a prime factor above 7 (97, 1021, 4099) Bluestein's algorithm
+    const std::size_t lengths[] = {
+        1, 2, 3, 5, 6, 7, 12, 15, 30, 49, 60, 97, 100, 210, 243, 343,
+        480, 625, 1000, 1021, 1536, 2310, 4099
+    };
+    const Quasar::Simd::SimdLevel levels[] = {
+        Quasar::Simd::Scalar, Quasar::Simd::AVX2, Quasar::Simd::AVX512
+    };
+    const Quasar::Simd::SimdLevel detected = Quasar::Simd::detectSimdLevel();
+    bool passed = true;
+    for (Quasar::Simd::SimdLevel level : levels)
+    {
+        if (level > detected)
+        {
+            break;
+        }
+        Quasar::Simd::setSimdLevel(level);
+        double worstMixed = 0, worstBluestein = 0, worstFloat = 0;
+        for (std::size_t N : lengths)
+        {
+            const double error = transformError<double>(N);
+            if (Quasar::MixedRadixFft<>(N).isBluestein())
+            {
+                worstBluestein = std::max(worstBluestein, error);
+            }
+            else
+            {
+                worstMixed = std::max(worstMixed, error);
+            }
+            worstFloat = std::max(worstFloat, transformError<float>(N));
+        }
+        std::cout << "SIMD level " << level << ": worst error " << worstMixed
+                  << " (mixed radix), " << worstBluestein << " (Bluestein), "
+                  << worstFloat << " (float)" << std::endl;
+        passed = passed && worstMixed < 1e-13 && worstBluestein < 1e-13 && worstFloat < 1e-5;
+    }
+    Quasar::Simd::setSimdLevel(detected);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+#include "Quasar/quasar.h"
+#include "Quasar/transform/OouraFft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+typedef std::complex<long double> Reference;
+
+/**
+ * Bins 0 to N / 2 of a naive DFT of a real signal in long double
+ * precision, with the sign convention of OouraFftComplex
+ * (exp(+2 pi i jk / N)).
+ */
+template<typename Real>
+std::vector<Reference> referenceHalfDft(const std::vector<Real>& x)
+{
+    const std::size_t N = x.size();
+    const long double step = 2.0L * 3.14159265358979323846264338327950288L / N;
+    std::vector<Reference> roots(N), result(N / 2 + 1);
+    for (std::size_t m = 0; m < N; ++m)
+    {
+        roots[m] = std::polar(1.0L, step * m);
+    }
+    for (std::size_t k = 0; k <= N / 2; ++k)
+    {
+        Reference sum;
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            sum += static_cast<long double>(x[j]) * roots[(j * k) % N];
+        }
+        result[k] = sum;
+    }
+    return result;
+}
+
+/**
+ * Transforms a test signal into its half spectrum and back, once into a
+ * separate buffer and once into the memory of the spectrum.
+ *
+ * @return largest error of the bins, relative to their largest
+ *         magnitude, or of the round trips, whichever is bigger
+ */
+template<typename Real>
+double transformError(std::size_t N)
+{
+    typedef std::complex<Real> Complex;
+    std::vector<Real> x(N), y(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        x[i] = static_cast<Real>(std::sin(0.1 * i + 1.0) + 0.5 * std::cos(0.37 * i));
+    }
+    const std::vector<Reference> expected = referenceHalfDft(x);
+
+    Quasar::OouraFftReal<std::vector, Real> fft(N);
+    std::vector<Complex> bins(N / 2 + 1);
+    fft.fft(Quasar::SignalSource<Real>(x), Quasar::SignalSpan<Complex>(bins.data(), bins.size()));
+    long double error = 0, magnitude = 0;
+    for (std::size_t k = 0; k <= N / 2; ++k)
+    {
+        error = std::max(error, std::abs(Reference(bins[k]) - expected[k]));
+        magnitude = std::max(magnitude, std::abs(expected[k]));
+    }
+
+    const Quasar::SignalSpan<const Complex> spectrum(bins.data(), bins.size());
+    fft.ifft(spectrum, Quasar::SignalSpan<Real>(y.data(), N));
+    Real* shared = reinterpret_cast<Real*>(bins.data());
+    fft.ifft(spectrum, Quasar::SignalSpan<Real>(shared, N));
+    long double roundTrip = 0;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(y[i] - x[i])));
+        roundTrip = std::max(roundTrip, static_cast<long double>(std::abs(shared[i] - x[i])));
+    }
+    return static_cast<double>(std::max(error / magnitude, roundTrip));
+}
+
+int main()
+{
+    double worstDouble = 0, worstFloat = 0;
+    for (std::size_t N = 2; N <= 4096; N *= 2)
+    {
+        worstDouble = std::max(worstDouble, transformError<double>(N));
+        worstFloat = std::max(worstFloat, transformError<float>(N));
+    }
+    std::cout << "Worst half spectrum error " << worstDouble << " (double), "
+              << worstFloat << " (float)" << std::endl;
+
+    return (worstDouble < 1e-13 && worstFloat < 1e-5) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,147 @@
+#include "Quasar/quasar.h"
+#include "Quasar/simd/CpuFeatures.h"
+#include "Quasar/simd/SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+/**
+ * Element-wise kernels of Quasar::Simd used by the signal arithmetic.
+ */
+enum Kernel
+{
+    Add, Multiply, AddScalar, MultiplyScalar, MultiplyRealScalar
+};
+
+const Kernel kernels[] = {Add, Multiply, AddScalar, MultiplyScalar, MultiplyRealScalar};
+
+template<typename Real>
+void assign(Real& x, double re, double)
+{
+    x = static_cast<Real>(re);
+}
+
+template<typename Real>
+void assign(std::complex<Real>& x, double re, double im)
+{
+    x = std::complex<Real>(static_cast<Real>(re), static_cast<Real>(im));
+}
+
+/**
+ * Runs a kernel on n elements of a, at the active SIMD level.
+ */
+template<typename DataType>
+void run(Kernel kernel, DataType* a, const DataType* b, std::size_t n)
+{
+    typedef decltype(std::abs(DataType())) Real;
+    DataType x;
+    assign(x, 0.75, -1.25);
+    switch (kernel)
+    {
+    case Add: Quasar::Simd::add(a, b, n); break;
+    case Multiply: Quasar::Simd::multiply(a, b, n); break;
+    case AddScalar: Quasar::Simd::add(a, n, x); break;
+    case MultiplyScalar: Quasar::Simd::multiply(a, n, x); break;
+    case MultiplyRealScalar: Quasar::Simd::multiply(a, n, static_cast<Real>(0.75)); break;
+    }
+}
+
+/**
+ * Runs a kernel on n elements starting offset elements into a buffer,
+ * at the active SIMD level and at the scalar one.
+ *
+ * @return largest difference between the two results, or infinity if
+ *         an element outside of the n ones was written
+ */
+template<typename DataType>
+double kernelError(Kernel kernel, std::size_t n, std::size_t offset)
+{
+    const std::size_t guard = 17;
+    DataType sentinel;
+    assign(sentinel, 1e6, -1e6);
+    std::vector<DataType> a(offset + n + guard, sentinel), b(offset + n + guard, sentinel);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        assign(a[offset + i], std::sin(0.3 * i + 1.0), std::cos(0.7 * i));
+        assign(b[offset + i], std::cos(0.11 * i) - 0.5, std::sin(0.5 * i + 2.0));
+    }
+    std::vector<DataType> expected(a);
+
+    run(kernel, a.data() + offset, b.data() + offset, n);
+    const Quasar::Simd::SimdLevel level = Quasar::Simd::simdLevel();
+    Quasar::Simd::setSimdLevel(Quasar::Simd::Scalar);
+    run(kernel, expected.data() + offset, b.data() + offset, n);
+    Quasar::Simd::setSimdLevel(level);
+
+    double error = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (i < offset || i >= offset + n)
+        {
+            if (a[i] != sentinel)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            continue;
+        }
+        error = std::max(error, static_cast<double>(std::abs(a[i] - expected[i])));
+    }
+    return error;
+}
+
+/**
+ * Runs every kernel for all lengths up to a few vector widths, so that
+ * every tail length of every instruction set comes up, on aligned and
+ * unaligned data.
+ *
+ * @return largest difference from the scalar kernels
+ */
+template<typename DataType>
+double worstError()
+{
+    double worst = 0;
+    for (Kernel kernel : kernels)
+    {
+        for (std::size_t n = 0; n <= 67; ++n)
+        {
+            for (std::size_t offset = 0; offset < 2; ++offset)
+            {
+                worst = std::max(worst, kernelError<DataType>(kernel, n, offset));
+            }
+        }
+    }
+    return worst;
+}
+
+int main()
+{
+    const Quasar::Simd::SimdLevel levels[] = {
+        Quasar::Simd::Scalar, Quasar::Simd::SSE2, Quasar::Simd::AVX2, Quasar::Simd::AVX512
+    };
+    const Quasar::Simd::SimdLevel detected = Quasar::Simd::detectSimdLevel();
+    bool passed = true;
+    for (Quasar::Simd::SimdLevel level : levels)
+    {
+        if (level > detected)
+        {
+            break;
+        }
+        Quasar::Simd::setSimdLevel(level);
+        const double worstDouble = std::max(worstError<double>(), worstError<std::complex<double>>());
+        const double worstFloat = std::max(worstError<float>(), worstError<std::complex<float>>());
+        std::cout << "SIMD level " << level << ": largest difference from scalar "
+                  << worstDouble << " (double), " << worstFloat << " (float)" << std::endl;
+        // complex products may be fused multiply-adds in one version and
+        // not in the other, anything else must match exactly
+        passed = passed && worstDouble <= 4 * std::numeric_limits<double>::epsilon()
+                 && worstFloat <= 4 * std::numeric_limits<float>::epsilon();
+    }
+    Quasar::Simd::setSimdLevel(detected);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
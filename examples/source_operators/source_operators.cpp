@@ -0,0 +1,69 @@
+#include "Quasar/quasar.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+
+bool passed = true;
+
+void check(bool condition, const char* description)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << description << std::endl;
+        passed = false;
+    }
+}
+
+int main()
+{
+    Quasar::SignalSource<> a(std::vector<double>{1, 2}), b(std::vector<double>{1, 2, 3, 4});
+    Quasar::SignalSource<> c(std::vector<double>{3, 4});
+
+    // a longer temporary on the right is cut to the length of the left operand
+    Quasar::SignalSource<> sum = a + (b * 1.0);
+    check(sum.getSamplesCount() == 2 && sum.sample(1) == 4, "a + (b * 1.0)");
+    Quasar::SignalSource<> product = a * (b + 0.0);
+    check(product.getSamplesCount() == 2 && product.sample(1) == 4, "a * (b + 0.0)");
+    Quasar::SignalSource<> fused = Quasar::lazy(a) * c + (b * 1.0);
+    check(fused.getSamplesCount() == 2 && fused.sample(1) == 10, "lazy(a) * c + (b * 1.0)");
+
+    // both operands temporary
+    Quasar::SignalSource<> squares = (a * c) * (a * c);
+    check(squares.getSamplesCount() == 2 && squares.sample(1) == 64, "(a * c) * (a * c)");
+    Quasar::SignalSource<> sums = (a + c) + (a + c);
+    check(sums.getSamplesCount() == 2 && sums.sample(0) == 8, "(a + c) + (a + c)");
+
+    // temporary frames and views only read the samples they refer to
+    Quasar::SignalSource<> signal(std::vector<double>{0, 1, 2, 3, 4, 5, 6, 7});
+    Quasar::SignalSource<> doubled = Quasar::Frame<>(signal, 2, 6) * 2.0;
+    check(doubled.getSamplesCount() == 4 && doubled.sample(0) == 4 && signal.sample(2) == 2,
+          "Frame<>(signal, 2, 6) * 2.0");
+    Quasar::FramesCollection<> frames(signal, 4);
+    Quasar::SignalSource<> window(std::vector<double>(4, 0.5));
+    Quasar::SignalSource<> windowed = frames.frame(1) * window;
+    check(windowed.getSamplesCount() == 4 && windowed.sample(3) == 3.5 && signal.sample(7) == 7,
+          "frames.frame(1) * window");
+    std::vector<double> buffer{1, 2, 3, 4};
+    Quasar::SignalSource<> shifted = Quasar::SignalView<>(buffer.data(), 4) + 1.0;
+    check(shifted.sample(0) == 2 && buffer[0] == 1, "SignalView<>(buffer, 4) + 1.0");
+
+    // a view writes into the samples, so it can not be made of a frame
+    bool rejected = false;
+    try
+    {
+        Quasar::Frame<> frame(signal, 2, 6);
+        Quasar::SignalView<> view(frame);
+    }
+    catch (const std::invalid_argument&)
+    {
+        rejected = true;
+    }
+    check(rejected, "SignalView<> of a Frame");
+
+    if (passed)
+    {
+        std::cout << "All operator checks passed." << std::endl;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}